@@ -0,0 +1,198 @@
+#include "attendance.h"
+#include "mark_columns.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define popcount64(x) ((uint64_t)__builtin_popcountll(x))
+#else
+static uint64_t popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (x * 0x0101010101010101ull) >> 56;
+}
+#endif
+
+#define SESSION_CACHE_SIZE 256 // Direct-mapped (subject, date) -> session cache; power of two
+#define WORD_OF(ordinal) ((ordinal) >> 6)
+#define BIT_OF(ordinal) ((uint64_t)1 << ((ordinal) & 63))
+
+static AttendanceSession** sessions = NULL; // Sorted by date, then subject
+static size_t sessionCount = 0;
+static size_t sessionCapacity = 0;
+static AttendanceSession* sessionCache[SESSION_CACHE_SIZE]; // Loaders revisit the same few sessions per student
+
+// --- Sessions ---
+
+// Orders by date text, then subject text. Interned texts are equal exactly
+// when their ids are, so matching ids skip the string compare.
+static int compareKey(SymbolId subject, SymbolId date, const AttendanceSession* session) {
+    int compare = (date == session->date) ? 0 : strcmp(symbolText(date), symbolText(session->date));
+    if (compare != 0) return compare;
+    return (subject == session->subject) ? 0 : strcmp(symbolText(subject), symbolText(session->subject));
+}
+
+// Returns the session for (subject, date), creating it when 'create' is set.
+// NULL if there is none (or memory ran out creating it).
+static AttendanceSession* findSession(SymbolId subject, SymbolId date, int create) {
+    AttendanceSession** cached = &sessionCache[(subject * 31u + date) & (SESSION_CACHE_SIZE - 1)];
+    if (*cached != NULL && (*cached)->subject == subject && (*cached)->date == date) return *cached;
+    size_t low = 0, high = sessionCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int compare = compareKey(subject, date, sessions[mid]);
+        if (compare == 0) return *cached = sessions[mid];
+        if (compare < 0) high = mid;
+        else low = mid + 1;
+    }
+    if (!create) return NULL;
+
+    if (sessionCount == sessionCapacity) {
+        size_t capacity = sessionCapacity ? sessionCapacity * 2 : 64;
+        AttendanceSession** grown = (AttendanceSession**)realloc(sessions, capacity * sizeof(AttendanceSession*));
+        if (grown == NULL) return NULL;
+        sessions = grown;
+        sessionCapacity = capacity;
+    }
+    AttendanceSession* session = (AttendanceSession*)calloc(1, sizeof(AttendanceSession));
+    if (session == NULL) return NULL;
+    session->subject = subject;
+    session->date = date;
+    memmove(sessions + low + 1, sessions + low, (sessionCount - low) * sizeof(AttendanceSession*));
+    sessions[low] = session;
+    sessionCount++;
+    return *cached = session;
+}
+
+static int growBitmaps(AttendanceSession* session, uint32_t needed) {
+    uint32_t words = session->words ? session->words : 16;
+    while (words < needed) words *= 2;
+    uint64_t* recorded = (uint64_t*)realloc(session->recorded, words * sizeof(uint64_t));
+    if (recorded == NULL) return 0;
+    session->recorded = recorded;
+    uint64_t* present = (uint64_t*)realloc(session->present, words * sizeof(uint64_t));
+    if (present == NULL) return 0; // 'recorded' is merely larger than needed
+    session->present = present;
+    memset(recorded + session->words, 0, (words - session->words) * sizeof(uint64_t));
+    memset(present + session->words, 0, (words - session->words) * sizeof(uint64_t));
+    session->words = words;
+    return 1;
+}
+
+static int hasEntry(const AttendanceSession* session, uint32_t ordinal) {
+    return WORD_OF(ordinal) < session->words && (session->recorded[WORD_OF(ordinal)] & BIT_OF(ordinal));
+}
+
+static int storeEntry(AttendanceSession* session, uint32_t ordinal, int present) {
+    uint32_t word = WORD_OF(ordinal);
+    if (word >= session->words && !growBitmaps(session, word + 1)) return 0;
+    session->recorded[word] |= BIT_OF(ordinal);
+    if (present) session->present[word] |= BIT_OF(ordinal);
+    else session->present[word] &= ~BIT_OF(ordinal);
+    return 1;
+}
+
+static void dropEntry(AttendanceSession* session, uint32_t ordinal) {
+    if (WORD_OF(ordinal) >= session->words) return;
+    session->recorded[WORD_OF(ordinal)] &= ~BIT_OF(ordinal);
+    session->present[WORD_OF(ordinal)] &= ~BIT_OF(ordinal);
+}
+
+// --- Recording ---
+
+int setAttendance(SymbolId subject, SymbolId date, uint32_t ordinal, int present) {
+    if (ordinal == NO_STUDENT_ORDINAL) return 1;
+    AttendanceSession* session = findSession(subject, date, 1);
+    return session != NULL && storeEntry(session, ordinal, present);
+}
+
+AttendanceSession* attendanceSessionFor(SymbolId subject, SymbolId date) {
+    return findSession(subject, date, 1);
+}
+
+int setSessionAttendance(AttendanceSession* session, uint32_t ordinal, int present) {
+    return ordinal == NO_STUDENT_ORDINAL || storeEntry(session, ordinal, present);
+}
+
+void mergeStudentAttendance(uint32_t from, uint32_t to) {
+    if (from == NO_STUDENT_ORDINAL || to == NO_STUDENT_ORDINAL || from == to) return;
+    for (size_t i = 0; i < sessionCount; i++) {
+        AttendanceSession* session = sessions[i];
+        if (!hasEntry(session, from)) continue;
+        if (!hasEntry(session, to)) {
+            storeEntry(session, to, (session->present[WORD_OF(from)] & BIT_OF(from)) != 0);
+        }
+        dropEntry(session, from);
+    }
+}
+
+void clearStudentAttendance(uint32_t ordinal) {
+    if (ordinal == NO_STUDENT_ORDINAL) return;
+    for (size_t i = 0; i < sessionCount; i++) dropEntry(sessions[i], ordinal);
+}
+
+// --- Queries ---
+
+// One student's bits are gathered from 64 sessions at a time into a word,
+// so a tally over many sessions is a handful of popcounts.
+AttendanceTally studentAttendance(uint32_t ordinal, SymbolId subject) {
+    AttendanceTally tally = { 0, 0 };
+    if (ordinal == NO_STUDENT_ORDINAL) return tally;
+    uint32_t word = WORD_OF(ordinal), shift = ordinal & 63;
+    uint64_t recordedBits = 0, presentBits = 0;
+    int filled = 0;
+    for (size_t i = 0; i < sessionCount; i++) {
+        const AttendanceSession* session = sessions[i];
+        if ((subject != ANY_SUBJECT && session->subject != subject) || word >= session->words) continue;
+        recordedBits |= ((session->recorded[word] >> shift) & 1) << filled;
+        presentBits |= ((session->present[word] >> shift) & 1) << filled;
+        if (++filled == 64) {
+            tally.sessions += popcount64(recordedBits);
+            tally.present += popcount64(presentBits);
+            recordedBits = presentBits = 0;
+            filled = 0;
+        }
+    }
+    tally.sessions += popcount64(recordedBits);
+    tally.present += popcount64(presentBits);
+    return tally;
+}
+
+AttendanceTally classAttendance(SymbolId subject) {
+    AttendanceTally tally = { 0, 0 };
+    for (size_t i = 0; i < sessionCount; i++) {
+        const AttendanceSession* session = sessions[i];
+        if (subject != ANY_SUBJECT && session->subject != subject) continue;
+        for (uint32_t w = 0; w < session->words; w++) {
+            tally.sessions += popcount64(session->recorded[w]);
+            tally.present += popcount64(session->present[w]);
+        }
+    }
+    return tally;
+}
+
+int nextAttendance(uint32_t ordinal, size_t* cursor, AttendanceEntry* entry) {
+    if (ordinal == NO_STUDENT_ORDINAL) return 0;
+    while (*cursor < sessionCount) {
+        const AttendanceSession* session = sessions[(*cursor)++];
+        if (!hasEntry(session, ordinal)) continue;
+        entry->subject = session->subject;
+        entry->date = session->date;
+        entry->present = (session->present[WORD_OF(ordinal)] & BIT_OF(ordinal)) != 0;
+        return 1;
+    }
+    return 0;
+}
+
+void releaseAttendance(void) {
+    for (size_t i = 0; i < sessionCount; i++) {
+        free(sessions[i]->recorded);
+        free(sessions[i]->present);
+        free(sessions[i]);
+    }
+    free(sessions);
+    sessions = NULL;
+    sessionCount = sessionCapacity = 0;
+    memset(sessionCache, 0, sizeof(sessionCache));
+}
@@ -0,0 +1,67 @@
+#ifndef ATTENDANCE_H
+#define ATTENDANCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "symbol_table.h"
+
+// --- Attendance Sessions ---
+//
+// A session is one roll call: a (subject, date) pair. Instead of a history
+// record per student per day, each session keeps two bitmaps over the dense
+// student ordinals (see mark_columns.h): whether the student was recorded
+// and whether they were present. Percentages are popcounts over the bitmaps.
+//
+// Sessions are kept sorted by date, then subject, so listings come out in
+// calendar order (for ISO dates) whatever order they were loaded in.
+
+typedef struct {
+    SymbolId subject;
+    SymbolId date;
+    uint64_t* recorded; // Bit per ordinal: attendance was taken for this student
+    uint64_t* present;  // Bit per ordinal: the student was present
+    uint32_t words;     // Length of both bitmaps in 64-bit words
+} AttendanceSession;
+
+typedef struct {
+    uint64_t sessions; // Student-sessions recorded
+    uint64_t present;  // ...of which present
+} AttendanceTally;
+
+typedef struct {
+    SymbolId subject;
+    SymbolId date;
+    int present;
+} AttendanceEntry;
+
+#define ANY_SUBJECT SYMBOL_INVALID // Tally across every subject
+
+/* --- Recording --- */
+// Records one student in one session, replacing any earlier entry for it.
+// Returns 0 if memory runs out.
+int setAttendance(SymbolId subject, SymbolId date, uint32_t ordinal, int present);
+
+// The same in two steps, for loaders that record many students in one
+// session: look the session up (creating it) once, then store each entry.
+// Both return 0 (NULL) if memory runs out.
+AttendanceSession* attendanceSessionFor(SymbolId subject, SymbolId date);
+int setSessionAttendance(AttendanceSession* session, uint32_t ordinal, int present);
+
+// Moves every entry of 'from' to 'to', except sessions 'to' already has.
+void mergeStudentAttendance(uint32_t from, uint32_t to);
+
+// Forgets every entry of a student whose ordinal is about to be reused.
+void clearStudentAttendance(uint32_t ordinal);
+
+/* --- Queries --- */
+AttendanceTally studentAttendance(uint32_t ordinal, SymbolId subject);
+AttendanceTally classAttendance(SymbolId subject);
+
+// Steps through the sessions recorded for 'ordinal' in date order. Start
+// with *cursor = 0. Returns 0 once there are no more.
+int nextAttendance(uint32_t ordinal, size_t* cursor, AttendanceEntry* entry);
+
+// Drops every session. Only safe once no student is left.
+void releaseAttendance(void);
+
+#endif // ATTENDANCE_H
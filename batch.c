@@ -0,0 +1,384 @@
+#include "batch.h"
+#include "journal.h"
+#include "cohort_report.h"
+#include "name_index.h"
+#include "op_stats.h"
+#include "rekey.h"
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#define BATCH_MAX_FIELDS 5
+
+struct BatchState {
+    TeacherNode** teacherRoot;
+    StudentNode** studentRoot;
+    TeacherNode* teacher;     // Logged-in teacher, NULL until a login command succeeds
+    StudentNode* lastStudent; // Most recent lookup; batch commands never delete, so it stays valid
+    unsigned long line;
+    unsigned long commands;
+    unsigned long added;
+    unsigned long marks;
+    unsigned long attendance;
+    unsigned long edits;
+    unsigned long rekeyed;
+    unsigned long reports;
+    unsigned long lookupsReused;
+    unsigned long failed;
+    FILE* out;                // Where errors and report commands write
+};
+
+static void batchError(BatchState* state, const char* format, ...) {
+    va_list args;
+    if (state->line > 0) fprintf(state->out, "Line %lu: ", state->line);
+    else fprintf(state->out, "Error: "); // A session command has no line number
+    va_start(args, format);
+    vfprintf(state->out, format, args);
+    va_end(args);
+    fprintf(state->out, "\n");
+    state->failed++;
+}
+
+// Splits 'line' in place on '|'. Returns the number of fields, or
+// BATCH_MAX_FIELDS + 1 if there are too many.
+static int splitFields(char* line, char** fields) {
+    int count = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    char* start = line;
+    while (1) {
+        if (count == BATCH_MAX_FIELDS) return BATCH_MAX_FIELDS + 1;
+        fields[count++] = start;
+        char* bar = strchr(start, '|');
+        if (bar == NULL) break;
+        *bar = '\0';
+        start = bar + 1;
+    }
+    return count;
+}
+
+static int parseInt(const char* text, int* value) {
+    char* end;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < -1000000 || parsed > 1000000) return 0;
+    *value = (int)parsed;
+    return 1;
+}
+
+static int parseComponent(const char* text, RecordType* type) {
+    static const char* codes[] = { "I1", "A1", "I2", "A2", "SEM" };
+    for (int i = 0; i < MARK_COMPONENTS; i++) {
+        if (strcmp(text, codes[i]) == 0) {
+            *type = (RecordType)(INTERNAL_1 + i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Consecutive commands usually name the same student (all of one student's
+// marks, or an edit after a mark), so the last lookup is tried first.
+static StudentNode* batchStudent(BatchState* state, char* srn) {
+    if (state->lastStudent != NULL && strcmp(state->lastStudent->studentSRN, srn) == 0) {
+        state->lookupsReused++;
+        return state->lastStudent;
+    }
+    StudentNode* student = lookupStudent(*state->studentRoot, srn);
+    if (student == NULL) {
+        batchError(state, "Student SRN %s not found.", srn);
+        return NULL;
+    }
+    state->lastStudent = student;
+    return student;
+}
+
+static int checkLength(BatchState* state, const char* what, const char* text, size_t size) {
+    if (strlen(text) < size) return 1;
+    batchError(state, "%s is too long (at most %lu characters).", what, (unsigned long)(size - 1));
+    return 0;
+}
+
+// Reads the "<type>|<value>" pair of a mark or edit command.
+static int readMark(BatchState* state, char* typeText, char* valueText, RecordType* type, int* value) {
+    if (!parseComponent(typeText, type)) {
+        batchError(state, "Unknown mark type '%s' (use I1, A1, I2, A2 or SEM).", typeText);
+        return 0;
+    }
+    int maxMark = recordTypeMaxMark(*type);
+    if (!parseInt(valueText, value) || *value < 0 || *value > maxMark) {
+        batchError(state, "Mark must be between 0 and %d.", maxMark);
+        return 0;
+    }
+    return 1;
+}
+
+static int readFormat(BatchState* state, const char* text, ReportFormat* format) {
+    if (parseReportFormat(text, format)) return 1;
+    batchError(state, "Unknown report format '%s' (use text, csv or json).", text);
+    return 0;
+}
+
+// Prints one report document (a CSV header or JSON array around it).
+// Timed like listAllStudents and the generate*Report functions.
+static void writeReport(BatchState* state, ReportFormat format, ReportKind kind, StudentNode* student, char* subject) {
+    uint64_t started = STAT_START();
+    ReportWriter writer;
+    reportOpen(&writer, format, kind, state->out);
+    reportBegin(&writer);
+    if (kind == REPORT_STUDENT_LIST) reportStudentList(&writer, *state->studentRoot);
+    else if (kind == REPORT_SUBJECT) reportSubject(&writer, student, subject, NULL);
+    else reportMaster(&writer, student);
+    reportEnd(&writer);
+    reportClose(&writer);
+    STAT_STOP(kind == REPORT_STUDENT_LIST ? STAT_LIST_STUDENTS : kind == REPORT_SUBJECT ? STAT_SUBJECT_REPORT : STAT_MASTER_REPORT,
+              started, writer.written);
+    state->reports++;
+}
+
+static void runCommand(BatchState* state, char** fields, int count) {
+    const char* command = fields[0];
+    StudentNode* student;
+    RecordType type;
+    int value;
+    ReportFormat format = REPORT_FORMAT_TEXT;
+
+    if (strcmp(command, "login") == 0) {
+        if (count != 3) { batchError(state, "Usage: login|<teacher id>|<password>"); return; }
+        state->teacher = login(*state->teacherRoot, fields[1], fields[2]);
+        if (state->teacher == NULL) batchError(state, "Login as %s failed.", fields[1]);
+        return;
+    }
+    if (state->teacher == NULL) {
+        batchError(state, "Not logged in; '%s' needs a login command first.", command);
+        return;
+    }
+
+    if (strcmp(command, "whoami") == 0) {
+        if (count != 1) { batchError(state, "Usage: whoami"); return; }
+        fprintf(state->out, "%s|%s|%s\n", state->teacher->teacherID, state->teacher->name, state->teacher->subject);
+    } else if (strcmp(command, "perf") == 0) {
+        if (count > 2) { batchError(state, "Usage: perf[|on|off|reset]"); return; }
+        if (count == 1) printStats(state->out);
+        else if (strcmp(fields[1], "on") == 0) setStatsEnabled(1);
+        else if (strcmp(fields[1], "off") == 0) setStatsEnabled(0);
+        else if (strcmp(fields[1], "reset") == 0) resetStats();
+        else batchError(state, "Unknown perf option '%s' (use on, off or reset).", fields[1]);
+    } else if (strcmp(command, "add") == 0) {
+        if (count != 3) { batchError(state, "Usage: add|<srn>|<name>"); return; }
+        if (!checkLength(state, "SRN", fields[1], sizeof(student->studentSRN))) return;
+        if (!checkLength(state, "Name", fields[2], sizeof(student->name))) return;
+        if (lookupStudent(*state->studentRoot, fields[1]) != NULL) {
+            batchError(state, "Student SRN %s already exists.", fields[1]);
+            return;
+        }
+        *state->studentRoot = addStudent(*state->studentRoot, fields[1], fields[2]);
+        state->added++;
+    } else if (strcmp(command, "mark") == 0) {
+        if (count != 4) { batchError(state, "Usage: mark|<srn>|<I1|A1|I2|A2|SEM>|<value>"); return; }
+        if (!readMark(state, fields[2], fields[3], &type, &value)) return;
+        if ((student = batchStudent(state, fields[1])) == NULL) return;
+        addPerformanceRecord(student, type, value, state->teacher->subject, (char*)recordTypeName(type));
+        state->marks++;
+    } else if (strcmp(command, "attendance") == 0) {
+        if (count != 4) { batchError(state, "Usage: attendance|<date>|<srn>|<1|0>"); return; }
+        if (!checkLength(state, "Date", fields[1], RECORD_TEXT_SIZE)) return;
+        if (!parseInt(fields[3], &value) || (value != 0 && value != 1)) {
+            batchError(state, "Attendance must be 1 (Present) or 0 (Absent).");
+            return;
+        }
+        if ((student = batchStudent(state, fields[2])) == NULL) return;
+        addPerformanceRecord(student, ATTENDANCE, value, state->teacher->subject, fields[1]);
+        state->attendance++;
+    } else if (strcmp(command, "rollcall") == 0) {
+        if (count != 2 && count != 3) { batchError(state, "Usage: rollcall|<date>[|<absent srn> ...]"); return; }
+        if (!checkLength(state, "Date", fields[1], RECORD_TEXT_SIZE)) return;
+        char* absentees[BATCH_LINE_SIZE / 2];
+        int absentCount = (count == 3) ? splitSRNList(fields[2], absentees, BATCH_LINE_SIZE / 2) : 0;
+        state->attendance += (unsigned long)recordRollCall(*state->studentRoot, state->teacher->subject,
+                                                           fields[1], absentees, absentCount);
+    } else if (strcmp(command, "edit") == 0) {
+        if (count != 4) { batchError(state, "Usage: edit|<srn>|<I1|A1|I2|A2|SEM>|<value>"); return; }
+        if (!readMark(state, fields[2], fields[3], &type, &value)) return;
+        if ((student = batchStudent(state, fields[1])) == NULL) return;
+        if (!updateMark(student, type, state->teacher->subject, value)) {
+            batchError(state, "No %s mark in %s for %s.", recordTypeName(type), state->teacher->subject, fields[1]);
+            return;
+        }
+        state->edits++;
+    } else if (strcmp(command, "rekey") == 0) {
+        size_t rekeyed = 0;
+        if (count == 4 && strcmp(fields[1], "prefix") == 0) {
+            rekeyed = rekeyByPrefix(state->studentRoot, fields[2], fields[3]);
+        } else if (count == 3 && strcmp(fields[1], "file") == 0) {
+            rekeyed = rekeyFromFile(state->studentRoot, fields[2]);
+        } else if (count == 3) {
+            if (!checkLength(state, "SRN", fields[2], sizeof(student->studentSRN))) return;
+            if (batchStudent(state, fields[1]) == NULL) return;
+            if (lookupStudent(*state->studentRoot, fields[2]) != NULL) {
+                batchError(state, "Student SRN %s already exists.", fields[2]);
+                return;
+            }
+            int changed = 0;
+            *state->studentRoot = changeStudentSRN(*state->studentRoot, fields[1], fields[2], &changed);
+            rekeyed = (size_t)changed;
+        } else {
+            batchError(state, "Usage: rekey|<old srn>|<new srn>, rekey|prefix|<old>|<new> or rekey|file|<path>");
+            return;
+        }
+        if (rekeyed == 0) {
+            batchError(state, "No SRNs were changed.");
+            return;
+        }
+        state->rekeyed += (unsigned long)rekeyed;
+    } else if (strcmp(command, "list") == 0) {
+        if (count > 2) { batchError(state, "Usage: list[|<text|csv|json>]"); return; }
+        if (count == 2 && !readFormat(state, fields[1], &format)) return;
+        writeReport(state, format, REPORT_STUDENT_LIST, NULL, NULL);
+    } else if (strcmp(command, "find") == 0) {
+        if (count < 2 || count > 4) { batchError(state, "Usage: find|<name>[|prefix][|<text|csv|json>]"); return; }
+        NameMatch match = NAME_CONTAINS;
+        for (int i = 2; i < count; i++) {
+            if (strcmp(fields[i], "prefix") == 0) match = NAME_PREFIX;
+            else if (!readFormat(state, fields[i], &format)) return;
+        }
+        StudentNode** matches;
+        size_t found;
+        if (!searchStudentNames(*state->studentRoot, fields[1], match, &matches, &found)) {
+            batchError(state, "Out of memory searching names.");
+            return;
+        }
+        ReportWriter writer;
+        reportOpen(&writer, format, REPORT_STUDENT_LIST, state->out);
+        reportBegin(&writer);
+        for (size_t i = 0; i < found; i++) reportStudent(&writer, matches[i]);
+        reportEnd(&writer);
+        reportClose(&writer);
+        free(matches);
+        state->reports++;
+    } else if (strcmp(command, "report") == 0) {
+        if (count < 2 || count > 4) { batchError(state, "Usage: report|<srn>[|<subject>[|<text|csv|json>]]"); return; }
+        if (count == 4 && !readFormat(state, fields[3], &format)) return;
+        if ((student = batchStudent(state, fields[1])) == NULL) return;
+        writeReport(state, format, REPORT_SUBJECT, student, (count >= 3 && fields[2][0] != '\0') ? fields[2] : state->teacher->subject);
+    } else if (strcmp(command, "master") == 0) {
+        if (count != 2 && count != 3) { batchError(state, "Usage: master|<srn>[|<text|csv|json>]"); return; }
+        if (count == 3 && !readFormat(state, fields[2], &format)) return;
+        if ((student = batchStudent(state, fields[1])) == NULL) return;
+        writeReport(state, format, REPORT_MASTER, student, NULL);
+    } else if (strcmp(command, "stats") == 0) {
+        if (count != 2 && count != 3) { batchError(state, "Usage: stats|<I1|A1|I2|A2|SEM>[|<subject>]"); return; }
+        if (!parseComponent(fields[1], &type)) {
+            batchError(state, "Unknown mark type '%s' (use I1, A1, I2, A2 or SEM).", fields[1]);
+            return;
+        }
+        generateClassStatsReport(count == 3 ? fields[2] : state->teacher->subject, type);
+        state->reports++;
+    } else if (strcmp(command, "cohort") == 0) {
+        if (count < 2 || fields[1][0] == '\0') {
+            batchError(state, "Usage: cohort|<file or directory>[|dir][|master][|<text|csv|json>]");
+            return;
+        }
+        CohortOptions cohort = { fields[1], 0, 0, 0, REPORT_FORMAT_TEXT };
+        for (int i = 2; i < count; i++) {
+            if (strcmp(fields[i], "dir") == 0) cohort.perStudentFiles = 1;
+            else if (strcmp(fields[i], "master") == 0) cohort.includeMaster = 1;
+            else if (!parseReportFormat(fields[i], &cohort.format)) {
+                batchError(state, "Unknown cohort option '%s' (use dir, master, text, csv or json).", fields[i]);
+                return;
+            }
+        }
+        if (!generateCohortReports(*state->teacherRoot, *state->studentRoot, &cohort)) {
+            batchError(state, "Cohort reports were not all written.");
+            return;
+        }
+        state->reports++;
+    } else {
+        batchError(state, "Unknown command '%s'.", command);
+    }
+}
+
+// Runs one script line; blank lines and comments are skipped.
+static void runLine(BatchState* state, char* line) {
+    if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') return;
+    char* fields[BATCH_MAX_FIELDS];
+    state->commands++;
+    int count = splitFields(line, fields);
+    if (count > BATCH_MAX_FIELDS) {
+        batchError(state, "Too many fields.");
+        return;
+    }
+    runCommand(state, fields, count);
+}
+
+int runBatch(FILE* in, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    BatchState state;
+    memset(&state, 0, sizeof(state));
+    state.teacherRoot = teacherRoot;
+    state.studentRoot = studentRoot;
+    state.out = stdout;
+
+    char line[BATCH_LINE_SIZE];
+    clock_t started = clock();
+    journalBeginGroup(); // One journal write per block of changes, not per change
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        state.line++;
+        if (strchr(line, '\n') == NULL && !feof(in)) {
+            batchError(&state, "Line is longer than %d characters.", BATCH_LINE_SIZE - 2);
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF); // Skip the rest of it
+            continue;
+        }
+        runLine(&state, line);
+        journalMaybeCompact(*teacherRoot, *studentRoot);
+    }
+    journalEndGroup();
+    double seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+    printf("\n============================================\n");
+    printf("              BATCH SUMMARY\n");
+    printf("============================================\n");
+    printf("Commands run:     %lu (%.2fs)\n", state.commands, seconds);
+    printf("Students added:   %lu\n", state.added);
+    printf("Marks logged:     %lu\n", state.marks);
+    printf("Attendance:       %lu\n", state.attendance);
+    printf("Marks edited:     %lu\n", state.edits);
+    printf("SRNs changed:     %lu\n", state.rekeyed);
+    printf("Reports printed:  %lu\n", state.reports);
+    printf("Lookups reused:   %lu\n", state.lookupsReused);
+    printf("Failed commands:  %lu\n", state.failed);
+    printf("============================================\n");
+    return (int)state.failed;
+}
+
+// --- Sessions ---
+
+BatchState* batchSessionOpen(TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    BatchState* state = (BatchState*)calloc(1, sizeof(BatchState));
+    if (state == NULL) return NULL;
+    state->teacherRoot = teacherRoot;
+    state->studentRoot = studentRoot;
+    state->out = stdout;
+    return state;
+}
+
+int batchSessionRun(BatchState* state, char* line, FILE* out) {
+    unsigned long failed = state->failed;
+    state->out = out;
+    runLine(state, line);
+    state->out = stdout;
+    return state->failed == failed;
+}
+
+int batchCommandReadOnly(const char* line) {
+    static const char* readers[] = { "list", "find", "report", "master", "whoami" };
+    size_t length = strcspn(line, "|\r\n");
+    for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); i++) {
+        if (strlen(readers[i]) == length && strncmp(line, readers[i], length) == 0) return 1;
+    }
+    // "perf" prints the counters; "perf|on", "perf|off" and "perf|reset" change them.
+    return length == 4 && strncmp(line, "perf", 4) == 0 && line[length] != '|';
+}
+
+void batchSessionClose(BatchState* state) {
+    free(state);
+}
@@ -0,0 +1,58 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "student_tracker.h"
+
+// --- Batch Mode ---
+//
+// Runs a script of typed commands without any prompts, for scripted bulk
+// entry ("student_tracker --batch term.txt", or "-" for stdin). One command
+// per line, fields separated by '|'; blank lines and lines starting with '#'
+// are ignored:
+//
+//   login|<teacher id>|<password>        Required first; marks use the teacher's subject
+//   whoami                               Prints <teacher id>|<name>|<subject>
+//   perf[|on|off|reset]                  Prints operation statistics (see op_stats.h)
+//   add|<srn>|<name>
+//   mark|<srn>|<I1|A1|I2|A2|SEM>|<value>
+//   attendance|<date>|<srn>|<1|0>        For the teacher's subject
+//   rollcall|<date>[|<absent srn> ...]   Whole class present except the listed SRNs
+//   edit|<srn>|<I1|A1|I2|A2|SEM>|<value> Changes the newest mark of that type
+//   rekey|<old srn>|<new srn>            Moves one student to a new SRN
+//   rekey|prefix|<old>|<new>             Every SRN starting with <old> (see rekey.h)
+//   rekey|file|<path>                    Every OLD NEW pair in a mapping file
+//   list[|<format>]                      All students in SRN order
+//   find|<name>[|prefix][|<format>]      Students whose name contains (or starts with) it
+//   report|<srn>[|<subject>[|<format>]]  Subject may be left empty for the teacher's
+//   master|<srn>[|<format>]
+//   stats|<I1|A1|I2|A2|SEM>[|<subject>]
+//   cohort|<path>[|dir][|master][|<format>]  Every student's reports (see cohort_report.h)
+//
+// <format> is text (the default), csv or json (see report_writer.h).
+//
+// A failing command is reported with its line number and skipped; the rest
+// of the script still runs. Changes are journaled like menu changes.
+
+#define BATCH_LINE_SIZE 512
+
+// Runs every command in 'in' and prints one summary. Returns the number of
+// commands that failed.
+int runBatch(FILE* in, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+/* --- Sessions --- */
+// A session runs commands one at a time as they arrive (see server.h). It
+// keeps its own login and last-student lookup; errors say "Error:" rather
+// than giving a line number.
+typedef struct BatchState BatchState;
+
+BatchState* batchSessionOpen(TeacherNode** teacherRoot, StudentNode** studentRoot);
+// Runs one command line. Errors and report output go to 'out'; whatever the
+// command's functions print still goes to stdout. Returns 0 if it failed.
+int batchSessionRun(BatchState* state, char* line, FILE* out);
+// 1 for commands that only read the data and print nothing to stdout
+// (list, find, report, master, whoami, and perf without options), so they can run
+// alongside each other.
+int batchCommandReadOnly(const char* line);
+void batchSessionClose(BatchState* state);
+
+#endif // BATCH_H
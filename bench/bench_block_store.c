@@ -0,0 +1,114 @@
+// Benchmark: the compressed block format against the segmented one.
+//
+// Build with CMake (target bench_block_store), then run it from
+// the build directory:
+//   ./bench_block_store [students] [subjects] [days] [maxThreads] [workDir]
+//
+// Generates a class (see dataset.h; default 20000 students, 6 subjects and
+// 60 days), saves it in both formats and compares file sizes. Then it times
+// a full load of the segmented file and of the block file with 1, 2, 4, ...
+// threads up to maxThreads (default: one per online CPU), and how long
+// reading single students from the block file takes next to a full load.
+
+#include "dataset.h"
+#include "block_store.h"
+#include "cohort_report.h"
+#include <time.h>
+
+#define SINGLE_READS 1000
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long fileSize(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Loads 'path' into an empty database and releases it again.
+static double timeLoad(const char* path, int* ok) {
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    double start = nowSeconds();
+    *ok = loadDataFromFile(path, &teachers, &students);
+    double elapsed = nowSeconds() - start;
+    releaseAllData();
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    DatasetOptions options = { 20000, 6, 60, 1 };
+    if (argc > 1) options.students = atoi(argv[1]);
+    if (argc > 2) options.subjects = atoi(argv[2]);
+    if (argc > 3) options.days = atoi(argv[3]);
+    int maxThreads = (argc > 4) ? atoi(argv[4]) : cohortDefaultThreads();
+    const char* dir = (argc > 5) ? argv[5] : ".";
+    if (options.students <= 0) options.students = 20000;
+    if (options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS) options.subjects = 6;
+    if (options.days < 0) options.days = 60;
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > BLOCK_MAX_THREADS) maxThreads = BLOCK_MAX_THREADS;
+
+    char segmentPath[512], blockPath[512];
+    snprintf(segmentPath, sizeof(segmentPath), "%s/bench_block_store.seg", dir);
+    snprintf(blockPath, sizeof(blockPath), "%s/bench_block_store.blk", dir);
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    if (!generateDataset(&options, &teachers, &students) ||
+        !saveDataToFile(segmentPath, DATA_FORMAT_SEGMENTED, teachers, students) ||
+        !saveDataToFile(blockPath, DATA_FORMAT_BLOCKS, teachers, students)) {
+        printf("Error: Could not write the benchmark files.\n");
+        return 1;
+    }
+    releaseAllData();
+
+    long segmentBytes = fileSize(segmentPath), blockBytes = fileSize(blockPath);
+    printf("Block store benchmark, %d students x %d subjects x %d days\n", options.students, options.subjects, options.days);
+    printf("segmented file | %11ld bytes\n", segmentBytes);
+    printf("block file     | %11ld bytes | %5.1fx smaller\n", blockBytes,
+           blockBytes > 0 ? (double)segmentBytes / blockBytes : 0.0);
+
+    int ok;
+    double full = timeLoad(segmentPath, &ok);
+    printf("segmented load |  1 thread    | %8.3fs%s\n", full, ok ? "" : " | FAILED");
+    double single = 0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+        setBlockStoreThreads(threads);
+        double elapsed = timeLoad(blockPath, &ok);
+        if (threads == 1) single = elapsed;
+        printf("block load     | %2d thread(s) | %8.3fs | speedup %5.2fx%s\n", threads, elapsed,
+               elapsed > 0 ? single / elapsed : 0.0, ok ? "" : " | FAILED");
+        if (threads == maxThreads) break;
+    }
+    setBlockStoreThreads(0);
+
+    // Single students, spread over the class, each read from a freshly opened file.
+    BlockStore store;
+    int found = 0;
+    char srn[20];
+    double start = nowSeconds();
+    for (int i = 0; i < SINGLE_READS; i++) {
+        StudentNode* student = NULL;
+        datasetSRN((int)((long long)i * options.students / SINGLE_READS), srn);
+        if (!openBlockStore(blockPath, &store)) break;
+        if (readBlockStudent(&store, srn, &student) && student != NULL) found++;
+        freeStudent(student);
+        closeBlockStore(&store);
+    }
+    double reads = nowSeconds() - start;
+    printf("single student | %8.1f us per read (%d of %d found) | full block load is %.0fx that\n",
+           reads * 1e6 / SINGLE_READS, found, SINGLE_READS, reads > 0 ? single * SINGLE_READS / reads : 0.0);
+
+    releaseAllData();
+    remove(segmentPath);
+    remove(blockPath);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Benchmark: whole-cohort report generation at different thread counts.
+//
+// Build with CMake (target bench_cohort_report), then run it from
+// the build directory:
+//   ./bench_cohort_report [studentCount] [recordsPerStudent] [maxThreads] [workDir]
+//
+// Generates a class taught in four subjects, then writes every student's four
+// subject reports plus their master report into one file with 1, 2, 4, ...
+// threads up to maxThreads (default: one per online CPU). Each run's output
+// is compared with the single-thread file, which must match byte for byte.
+
+#include "student_tracker.h"
+#include "cohort_report.h"
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* subjects[] = { "C Programming", "Data Structures", "Mathematics", "Physics" };
+
+// Builds the class directly as a balanced tree so generation stays cheap.
+static StudentNode* generateClass(int studentCount, int recordsPerStudent) {
+    StudentNode** students = malloc(sizeof(StudentNode*) * (size_t)studentCount);
+    if (students == NULL) return NULL;
+    char srn[20], name[100], desc[50];
+    for (int i = 0; i < studentCount; i++) {
+        sprintf(srn, "PES1UG22%07d", i);
+        sprintf(name, "Student %d", i);
+        students[i] = createStudent(srn, name);
+        for (int r = 0; r < recordsPerStudent; r++) {
+            RecordType type = (RecordType)(r % 6);
+            if (type == ATTENDANCE) sprintf(desc, "2025-11-%02d", r % 28 + 1);
+            else strcpy(desc, recordTypeName(type));
+            int value = (type == ATTENDANCE) ? (r + i) % 5 != 0 : (r * 7 + i) % (recordTypeMaxMark(type) + 1);
+            appendPerformanceRecord(students[i], type, value, internSymbol(subjects[r % 4]), internSymbol(desc));
+        }
+    }
+    StudentNode* root = buildBalancedStudentTree(students, (size_t)studentCount);
+    free(students);
+    return root;
+}
+
+static int sameFile(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    int same = (fa != NULL && fb != NULL);
+    char bufA[65536], bufB[65536];
+    while (same) {
+        size_t na = fread(bufA, 1, sizeof(bufA), fa);
+        size_t nb = fread(bufB, 1, sizeof(bufB), fb);
+        if (na != nb || memcmp(bufA, bufB, na) != 0) same = 0;
+        if (na == 0) break;
+    }
+    if (fa != NULL) fclose(fa);
+    if (fb != NULL) fclose(fb);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    int studentCount = (argc > 1) ? atoi(argv[1]) : 100000;
+    int recordsPerStudent = (argc > 2) ? atoi(argv[2]) : 30;
+    int maxThreads = (argc > 3) ? atoi(argv[3]) : cohortDefaultThreads();
+    const char* dir = (argc > 4) ? argv[4] : ".";
+    if (studentCount <= 0) studentCount = 100000;
+    if (recordsPerStudent < 0) recordsPerStudent = 30;
+    if (maxThreads <= 0) maxThreads = cohortDefaultThreads();
+
+    char basePath[512], runPath[512];
+    snprintf(basePath, sizeof(basePath), "%s/bench_cohort_1.txt", dir);
+    snprintf(runPath, sizeof(runPath), "%s/bench_cohort_n.txt", dir);
+
+    printf("Cohort report benchmark, %d students x %d records, up to %d threads\n",
+           studentCount, recordsPerStudent, maxThreads);
+    TeacherNode* teachers = NULL;
+    char id[20];
+    for (int s = 0; s < 4; s++) {
+        sprintf(id, "TS%03d", s + 1);
+        teachers = addTeacher(teachers, id, "Teacher", "password123", (char*)subjects[s]);
+    }
+    StudentNode* students = generateClass(studentCount, recordsPerStudent);
+    if (students == NULL) {
+        printf("Error: Could not generate the class.\n");
+        return 1;
+    }
+
+    double single = 0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+        CohortOptions options = { threads == 1 ? basePath : runPath, 0, 1, threads, REPORT_FORMAT_TEXT };
+        double start = nowSeconds();
+        int ok = generateCohortReports(teachers, students, &options);
+        double elapsed = nowSeconds() - start;
+        if (threads == 1) single = elapsed;
+        int same = (threads == 1) || sameFile(basePath, runPath);
+        printf("%2d thread(s) | %8.3fs | speedup %5.2fx%s%s\n", threads, elapsed,
+               elapsed > 0 ? single / elapsed : 0.0, ok ? "" : " | FAILED", same ? "" : " | OUTPUT DIFFERS");
+        if (threads == maxThreads) break;
+    }
+
+    releaseAllData();
+    remove(basePath);
+    remove(runPath);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Benchmark: resident size and read speed of the packed student histories.
+//
+// Build with CMake (target bench_history), then run from the build directory:
+//   ./bench_history [students] [subjects] [days]
+//
+// Generates a class (see dataset.h; default 20000 students, 6 subjects and
+// 60 days, about one term) and reports the bytes each student's records
+// take, next to what they took as one 24-byte list node per record plus a
+// 64-byte slot table per subject, with attendance as records too. The
+// measured growth in peak RSS per student is printed as well, since the
+// student node, the SRN and name indexes and the mark columns are not part
+// of the history. Then it times a cursor walk over every history and a
+// subject summary of every student in every subject.
+
+#include "dataset.h"
+#include "attendance.h"
+#include "history.h"
+#include "tree_cursor.h"
+#include <sys/resource.h>
+#include <time.h>
+
+#define LIST_NODE_BYTES 24   // type, value, subject, description, next
+#define SLOT_TABLE_BYTES 64  // subject, five mark pointers, columns, next
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peakRSSKB(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static void printSize(const char* label, double listBytes, double packedBytes) {
+    printf("%-22s | %9.1f B as list nodes | %8.1f B packed | %6.1fx smaller\n",
+           label, listBytes, packedBytes, packedBytes > 0 ? listBytes / packedBytes : 0.0);
+}
+
+int main(int argc, char* argv[]) {
+    DatasetOptions options = { 20000, 6, 60, 1 };
+    if (argc > 1) options.students = atoi(argv[1]);
+    if (argc > 2) options.subjects = atoi(argv[2]);
+    if (argc > 3) options.days = atoi(argv[3]);
+    if (options.students <= 0) options.students = 20000;
+    if (options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS) options.subjects = 6;
+    if (options.days < 0) options.days = 60;
+
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    long baseRSS = peakRSSKB();
+    if (!generateDataset(&options, &teachers, &students)) {
+        printf("Error: Could not generate the class.\n");
+        return 1;
+    }
+    long classRSS = peakRSSKB() - baseRSS;
+    printf("History benchmark, %d students x %d subjects x %d days\n", options.students, options.subjects, options.days);
+
+    TreeCursor cursor;
+    StudentNode* student;
+    size_t records = 0, packed = 0;
+    openStudentCursor(&cursor, students, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) packed += historyFootprint(student);
+    closeCursor(&cursor);
+
+    double started = nowSeconds();
+    long long checksum = 0;
+    openStudentCursor(&cursor, students, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) {
+        HistoryCursor history;
+        PerformanceRecord record;
+        openHistoryCursor(&history, student);
+        while (nextHistoryRecord(&history, &record)) {
+            checksum += record.value;
+            records++;
+        }
+    }
+    closeCursor(&cursor);
+    double walked = nowSeconds() - started;
+
+    AttendanceTally tallies[DATASET_MAX_SUBJECTS];
+    for (int s = 0; s < options.subjects; s++) {
+        SymbolId subject;
+        tallies[s] = lookupSymbol(datasetSubject(s), &subject) ? classAttendance(subject) : (AttendanceTally){ 0, 0 };
+    }
+    started = nowSeconds();
+    SubjectSummary summary;
+    openStudentCursor(&cursor, students, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) {
+        for (int s = 0; s < options.subjects; s++) {
+            summarizeSubject(student, datasetSubject(s), &tallies[s], &summary);
+            checksum += summary.marks[0];
+        }
+    }
+    closeCursor(&cursor);
+    double summarized = nowSeconds() - started;
+
+    double count = (double)options.students;
+    double sessions = (double)options.subjects * options.days;
+    double marksList = (double)records / count * LIST_NODE_BYTES + options.subjects * SLOT_TABLE_BYTES;
+    double marksPacked = (double)packed / count;
+    double attendanceList = sessions * LIST_NODE_BYTES;
+    double attendancePacked = sessions * 2 / 8; // Two bits per session (see attendance.h)
+    printf("%.1f marks and %.0f attendance sessions per student\n", (double)records / count, sessions);
+    printSize("marks", marksList, marksPacked);
+    printSize("attendance", attendanceList, attendancePacked);
+    printSize("student-term history", marksList + attendanceList, marksPacked + attendancePacked);
+    printf("whole student          | %9.1f B of peak RSS, everything included\n", classRSS * 1024.0 / count);
+    printf("history walk           | %8.3fs | %6.1f ns per record\n", walked, records ? walked * 1e9 / records : 0.0);
+    printf("subject summaries      | %8.3fs | %6.1f ns per summary (checksum %lld)\n", summarized,
+           summarized * 1e9 / (count * options.subjects), checksum);
+
+    releaseAllData();
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Benchmark: hash index lookups vs. walking the student and teacher trees.
+//
+// Build with CMake (target bench_key_index), then run from the build directory:
+//   ./bench_key_index [maxCount]
+//
+// For 10k, 100k and 1M entries (up to maxCount, default 1000000) the
+// students and teachers are added in random order, then every key is looked
+// up once in a different random order, plus as many keys that are missing,
+// through findStudent/findTeacher and through lookupStudent/lookupTeacher.
+
+#include "student_tracker.h"
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void shuffle(char (*keys)[20], int count, unsigned int seed) {
+    for (int i = count - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)(seed % (unsigned int)(i + 1));
+        char temp[20];
+        strcpy(temp, keys[i]);
+        strcpy(keys[i], keys[j]);
+        strcpy(keys[j], temp);
+    }
+}
+
+// Returns how many of the keys were found, so the loops are not optimized away.
+static int findStudents(StudentNode* root, char (*keys)[20], int count, int hashed) {
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        found += (hashed ? lookupStudent(root, keys[i]) : findStudent(root, keys[i])) != NULL;
+    }
+    return found;
+}
+
+static int findTeachers(TeacherNode* root, char (*keys)[20], int count, int hashed) {
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        found += (hashed ? lookupTeacher(root, keys[i]) : findTeacher(root, keys[i])) != NULL;
+    }
+    return found;
+}
+
+static void runCase(int count) {
+    char (*srns)[20] = malloc(sizeof(*srns) * (size_t)count);
+    char (*ids)[20] = malloc(sizeof(*ids) * (size_t)count);
+    char (*missing)[20] = malloc(sizeof(*missing) * (size_t)count);
+    if (srns == NULL || ids == NULL || missing == NULL) {
+        printf("Out of memory for %d entries.\n", count);
+        free(srns);
+        free(ids);
+        free(missing);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        sprintf(srns[i], "PES1UG22%07d", i);
+        sprintf(ids[i], "TS%07d", i);
+        sprintf(missing[i], "PES1UG23%07d", i);
+    }
+    char name[] = "Benchmark";
+    char password[] = "password123";
+    char subject[] = "Mathematics";
+
+    shuffle(srns, count, 12345);
+    shuffle(ids, count, 54321);
+    StudentNode* students = NULL;
+    TeacherNode* teachers = NULL;
+    for (int i = 0; i < count; i++) students = addStudent(students, srns[i], name);
+    for (int i = 0; i < count; i++) teachers = addTeacher(teachers, ids[i], name, password, subject);
+    shuffle(srns, count, 777);
+    shuffle(ids, count, 999);
+
+    double start = nowSeconds();
+    int treeHits = findStudents(students, srns, count, 0) + findStudents(students, missing, count, 0);
+    double treeTime = nowSeconds() - start;
+    start = nowSeconds();
+    int hashHits = findStudents(students, srns, count, 1) + findStudents(students, missing, count, 1);
+    double hashTime = nowSeconds() - start;
+    printf("%8d | students | tree %8.4fs | hash %8.4fs | %5.1fx | hits %d/%d\n",
+           count, treeTime, hashTime, treeTime / hashTime, treeHits, hashHits);
+
+    start = nowSeconds();
+    treeHits = findTeachers(teachers, ids, count, 0);
+    treeTime = nowSeconds() - start;
+    start = nowSeconds();
+    hashHits = findTeachers(teachers, ids, count, 1);
+    hashTime = nowSeconds() - start;
+    printf("%8d | teachers | tree %8.4fs | hash %8.4fs | %5.1fx | hits %d/%d\n",
+           count, treeTime, hashTime, treeTime / hashTime, treeHits, hashHits);
+
+    releaseAllData();
+    free(srns);
+    free(ids);
+    free(missing);
+}
+
+int main(int argc, char* argv[]) {
+    int maxCount = (argc > 1) ? atoi(argv[1]) : 1000000;
+    if (maxCount <= 0) maxCount = 1000000;
+
+    printf("Key index benchmark (every key once, plus as many misses for students)\n");
+    for (int count = 10000; count <= maxCount; count *= 10) runCase(count);
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Benchmark: lazy startup against a full load of a block file.
+//
+// Build with CMake (target bench_lazy_load), then run from the build directory:
+//   ./bench_lazy_load [students] [subjects] [maxDays] [touched] [workDir]
+//
+// Keeps the class at 'students' (default 20000) and 'subjects' (default 6)
+// and grows the records per student: 0 attendance days, then 15, 30, 60, ...
+// up to maxDays (default 240). For each size it saves a block file and
+// starts a fresh process per mode, so the peak RSS is that of the startup
+// alone. Each reports the time to load and the peak RSS after it, then the
+// time to read 'touched' students' marks (default 50, spread over the class)
+// and the peak RSS after that. A full load grows with the records; a lazy
+// startup should stay flat.
+
+#include "dataset.h"
+#include "block_store.h"
+#include <sys/resource.h>
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long fileSize(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static long peakRSSKB(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// --- Startup (run in a child process) ---
+
+// Prints "<load seconds> <touch seconds> <baseline KB> <peak KB after load> <peak KB after touching>".
+static int runStartup(const char* path, int lazyMode, int students, int touched) {
+    long baseline = peakRSSKB();
+    TeacherNode* teachers = NULL;
+    StudentNode* root = NULL;
+    setLazyLoading(lazyMode);
+    double start = nowSeconds();
+    if (!loadDataFromFile(path, &teachers, &root)) return 1;
+    double loaded = nowSeconds() - start;
+    long afterLoad = peakRSSKB();
+
+    char srn[20], subject[50];
+    strcpy(subject, datasetSubject(0));
+    volatile int found = 0; // Keeps the reads from being optimized away
+    start = nowSeconds();
+    for (int i = 0; i < touched && students > 0; i++) {
+        int value;
+        datasetSRN((int)((long long)i * students / touched), srn);
+        found += findMark(lookupStudent(root, srn), INTERNAL_1, subject, &value);
+    }
+    double touching = nowSeconds() - start;
+    printf("%.6f %.6f %ld %ld %ld\n", loaded, touching, baseline, afterLoad, peakRSSKB());
+    releaseAllData();
+    return 0;
+}
+
+typedef struct {
+    double load;        // Seconds
+    double touch;
+    double loadMB;      // Peak RSS above the process's own
+    double touchMB;
+} StartupResult;
+
+static int measure(const char* self, const char* path, int lazyMode, int students, int touched, StartupResult* result) {
+    char command[1024];
+    snprintf(command, sizeof(command), "'%s' --startup '%s' %d %d %d", self, path, lazyMode, students, touched);
+    FILE* child = popen(command, "r");
+    if (child == NULL) return 0;
+    long baseline = 0, afterLoad = 0, afterTouch = 0;
+    int ok = fscanf(child, "%lf %lf %ld %ld %ld", &result->load, &result->touch, &baseline, &afterLoad, &afterTouch) == 5;
+    if (pclose(child) != 0) ok = 0;
+    result->loadMB = (afterLoad - baseline) / 1024.0;
+    result->touchMB = (afterTouch - baseline) / 1024.0;
+    return ok;
+}
+
+// 0, 15, 30, 60, ... with the last step landing on maxDays.
+static int nextDays(int days, int maxDays) {
+    int next = days ? days * 2 : 15;
+    return next < maxDays ? next : maxDays;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 6 && strcmp(argv[1], "--startup") == 0) {
+        return runStartup(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5]));
+    }
+    DatasetOptions options = { 20000, 6, 0, 1 };
+    if (argc > 1) options.students = atoi(argv[1]);
+    if (argc > 2) options.subjects = atoi(argv[2]);
+    int maxDays = (argc > 3) ? atoi(argv[3]) : 240;
+    int touched = (argc > 4) ? atoi(argv[4]) : 50;
+    const char* dir = (argc > 5) ? argv[5] : ".";
+    if (options.students <= 0) options.students = 20000;
+    if (options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS) options.subjects = 6;
+    if (maxDays < 0) maxDays = 240;
+    if (touched < 0) touched = 50;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bench_lazy_load.blk", dir);
+    printf("Lazy startup benchmark, %d students x %d subjects, %d students touched after startup\n",
+           options.students, options.subjects, touched);
+    printf("%5s | %10s | %11s | %-34s | %-34s\n", "days", "records", "file bytes",
+           "full load: start, RSS, touch, RSS", "lazy: start, RSS, touch, RSS");
+    for (int days = 0;; days = nextDays(days, maxDays)) {
+        options.days = days;
+        TeacherNode* teachers = NULL;
+        StudentNode* students = NULL;
+        if (!generateDataset(&options, &teachers, &students) ||
+            !saveDataToFile(path, DATA_FORMAT_BLOCKS, teachers, students)) {
+            printf("Error: Could not write %s.\n", path);
+            return 1;
+        }
+        releaseAllData();
+
+        long long records = (long long)options.students * options.subjects * (MARK_COMPONENTS + days);
+        StartupResult eager, lazy;
+        if (!measure(argv[0], path, 0, options.students, touched, &eager) ||
+            !measure(argv[0], path, 1, options.students, touched, &lazy)) {
+            printf("Error: A startup run failed.\n");
+            remove(path);
+            return 1;
+        }
+        printf("%5d | %10lld | %11ld | %6.3fs %6.1f MB %6.3fs %6.1f MB | %6.3fs %6.1f MB %6.3fs %6.1f MB\n",
+               days, records, fileSize(path), eager.load, eager.loadMB, eager.touch, eager.touchMB,
+               lazy.load, lazy.loadMB, lazy.touch, lazy.touchMB);
+        fflush(stdout);
+        if (days >= maxDays) break;
+    }
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Benchmark: loading a large save file.
+//
+// Build with CMake (target bench_load), then run from the build directory:
+//   ./bench_load [studentCount] [recordsPerStudent] [workDir]
+//
+// Writes a generated class in the text, binary snapshot, segmented and block formats,
+// then times loadDataFromFile and releaseAllData on each. The text file is
+// also loaded with the original fscanf/fgets loader and freed node by node for
+// comparison. The defaults are 100,000 students with 50 records each; the
+// bench_load_full target runs the full size, 1,000,000 students and 50M
+// records (about 4 GB of files). On one CPU that took 4.8s for the binary
+// snapshot, 5.3s for blocks, 6.4s for segments and 13.2s for text, against
+// 34.6s for the original loader.
+
+#include "student_tracker.h"
+#include <time.h>
+
+// --- Original text loader (kept here only for comparison) ---
+
+// One addStudent plus one findStudent per STUDENT line, fscanf/fgets for
+// every field, and records prepended one at a time.
+static void legacyReadLine(char* buffer, int size, FILE* fp) {
+    fgets(buffer, size, fp);
+    buffer[strcspn(buffer, "\n")] = 0;
+}
+
+static void legacyLoad(FILE* fp, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    char lineBuffer[100];
+    char nameBuffer[100], idBuffer[20], pwBuffer[50], subjectBuffer[50], descBuffer[50];
+    int tempType, tempValue;
+    StudentNode* lastStudent = NULL;
+
+    while (fscanf(fp, "%s", lineBuffer) != EOF && strcmp(lineBuffer, "END_OF_FILE") != 0) {
+        fgetc(fp);
+        if (strcmp(lineBuffer, "TEACHER") == 0) {
+            legacyReadLine(idBuffer, 20, fp);
+            legacyReadLine(nameBuffer, 100, fp);
+            legacyReadLine(pwBuffer, 50, fp);
+            legacyReadLine(subjectBuffer, 50, fp);
+            *teacherRoot = addTeacher(*teacherRoot, idBuffer, nameBuffer, pwBuffer, subjectBuffer);
+        } else if (strcmp(lineBuffer, "STUDENT") == 0) {
+            legacyReadLine(idBuffer, 20, fp);
+            legacyReadLine(nameBuffer, 100, fp);
+            *studentRoot = addStudent(*studentRoot, idBuffer, nameBuffer);
+            lastStudent = findStudent(*studentRoot, idBuffer);
+        } else if (strcmp(lineBuffer, "RECORD") == 0) {
+            if (lastStudent == NULL) continue;
+            fscanf(fp, "%d", &tempType); fgetc(fp);
+            fscanf(fp, "%d", &tempValue); fgetc(fp);
+            legacyReadLine(subjectBuffer, 50, fp);
+            legacyReadLine(descBuffer, 50, fp);
+            addPerformanceRecord(lastStudent, (RecordType)tempType, tempValue, subjectBuffer, descBuffer);
+        }
+    }
+}
+
+// --- Helpers ---
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* subjects[] = { "C Programming", "Data Structures", "Mathematics", "Physics" };
+
+// Builds the class directly as a balanced tree so generation stays cheap.
+static StudentNode* generateClass(int studentCount, int recordsPerStudent) {
+    StudentNode** students = malloc(sizeof(StudentNode*) * (size_t)studentCount);
+    if (students == NULL) return NULL;
+    char srn[20], name[100], desc[50];
+    for (int i = 0; i < studentCount; i++) {
+        sprintf(srn, "PES1UG22%07d", i);
+        sprintf(name, "Student %d", i);
+        students[i] = createStudent(srn, name);
+        for (int r = 0; r < recordsPerStudent; r++) {
+            RecordType type = (RecordType)(r % 6);
+            sprintf(desc, type == ATTENDANCE ? "2025-11-%02d" : "Internal %d", r % 28 + 1);
+            appendPerformanceRecord(students[i], type, (r * 7 + i) % 20, internSymbol(subjects[r % 4]), internSymbol(desc));
+        }
+    }
+    StudentNode* root = buildBalancedStudentTree(students, (size_t)studentCount);
+    free(students);
+    return root;
+}
+
+static long fileSize(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static void timeLoad(const char* label, const char* path) {
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    double start = nowSeconds();
+    int ok = loadDataFromFile(path, &teachers, &students);
+    double elapsed = nowSeconds() - start;
+    int height = studentHeight(students);
+    start = nowSeconds();
+    releaseAllData();
+    double released = nowSeconds() - start;
+    printf("%-10s | %10ld bytes | load %8.3fs | release %7.3fs | height %d%s\n",
+           label, fileSize(path), elapsed, released, height, ok ? "" : " | FAILED");
+}
+
+int main(int argc, char* argv[]) {
+    int studentCount = (argc > 1) ? atoi(argv[1]) : 100000;
+    int recordsPerStudent = (argc > 2) ? atoi(argv[2]) : 50;
+    const char* dir = (argc > 3) ? argv[3] : ".";
+    if (studentCount <= 0) studentCount = 100000;
+    if (recordsPerStudent < 0) recordsPerStudent = 50;
+
+    char textPath[512], binaryPath[512], segmentPath[512], blockPath[512];
+    snprintf(textPath, sizeof(textPath), "%s/bench_load.txt", dir);
+    snprintf(binaryPath, sizeof(binaryPath), "%s/bench_load.bin", dir);
+    snprintf(segmentPath, sizeof(segmentPath), "%s/bench_load.seg", dir);
+    snprintf(blockPath, sizeof(blockPath), "%s/bench_load.blk", dir);
+
+    printf("Load benchmark, %d students x %d records\n", studentCount, recordsPerStudent);
+    TeacherNode* teachers = addTeacher(NULL, "TS001", "Prof. Smith", "password123", "C Programming");
+    StudentNode* students = generateClass(studentCount, recordsPerStudent);
+    if (students == NULL ||
+        !saveDataToFile(textPath, DATA_FORMAT_TEXT, teachers, students) ||
+        !saveDataToFile(binaryPath, DATA_FORMAT_BINARY, teachers, students) ||
+        !saveDataToFile(segmentPath, DATA_FORMAT_SEGMENTED, teachers, students) ||
+        !saveDataToFile(blockPath, DATA_FORMAT_BLOCKS, teachers, students)) {
+        printf("Error: Could not write the benchmark files.\n");
+        return 1;
+    }
+    releaseAllData();
+
+    timeLoad("text", textPath);
+    timeLoad("binary", binaryPath);
+    timeLoad("segmented", segmentPath);
+    timeLoad("blocks", blockPath);
+
+    FILE* fp = fopen(textPath, "r");
+    if (fp != NULL) {
+        teachers = NULL;
+        students = NULL;
+        double start = nowSeconds();
+        legacyLoad(fp, &teachers, &students);
+        double elapsed = nowSeconds() - start;
+        fclose(fp);
+        int height = studentHeight(students);
+        // Node by node, the way the original shutdown freed everything.
+        start = nowSeconds();
+        freeTree(students);
+        freeTeacherTree(teachers);
+        double released = nowSeconds() - start;
+        printf("%-10s | %10ld bytes | load %8.3fs | free    %7.3fs | height %d\n",
+               "legacy", fileSize(textPath), elapsed, released, height);
+        releaseAllData();
+    }
+
+    remove(textPath);
+    remove(binaryPath);
+    remove(segmentPath);
+    remove(blockPath);
+    return 0;
+}
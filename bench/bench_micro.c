@@ -0,0 +1,273 @@
+// Microbenchmarks for the core operations, with JSON output for tracking.
+//
+// Build with CMake (target bench_micro; the "bench" target builds and runs
+// it), then run from the build directory:
+//   ./bench_micro [students] [subjects] [days] [repeat] [jsonFile|-] [workDir]
+//
+// Generates a class (see dataset.h; default 20000 students, 6 subjects,
+// 60 days) and times addStudent, findStudent, lookupStudent,
+// generateSubjectReport, generateMasterReport, and saveDataToFile and
+// loadDataFromFile in each save format. Every benchmark runs 'repeat'
+// times (default 5); the table and the JSON give the median and best time
+// per operation. The JSON goes to jsonFile ("-" for stdout) and is meant
+// to be kept per commit and compared.
+
+#include "dataset.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MICRO_MAX_RESULTS 32
+#define MICRO_MAX_REPEAT 100
+
+typedef struct {
+    char name[48];
+    long ops;        // Operations per run
+    double median;   // Seconds per run
+    double best;
+} MicroResult;
+
+static MicroResult results[MICRO_MAX_RESULTS];
+static int resultCount = 0;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double left = *(const double*)a, right = *(const double*)b;
+    return (left > right) - (left < right);
+}
+
+static void record(const char* name, long ops, double* runs, int repeat) {
+    if (resultCount == MICRO_MAX_RESULTS) return;
+    qsort(runs, (size_t)repeat, sizeof(double), compareDoubles);
+    MicroResult* result = &results[resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->ops = ops;
+    result->median = runs[repeat / 2];
+    result->best = runs[0];
+    printf("%-28s %9ld %14.1f %14.1f %10.4f\n", name, ops,
+           result->median * 1e9 / (double)ops, result->best * 1e9 / (double)ops, result->median);
+    fflush(stdout);
+}
+
+static void shuffle(char (*keys)[20], int count) {
+    unsigned int seed = 777;
+    for (int i = count - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)(seed % (unsigned int)(i + 1));
+        char temp[20];
+        strcpy(temp, keys[i]);
+        strcpy(keys[i], keys[j]);
+        strcpy(keys[j], temp);
+    }
+}
+
+// Reports print to stdout; while they are timed it goes to /dev/null.
+static int silenceStdout(void) {
+    fflush(stdout);
+    int saved = dup(1);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull >= 0) {
+        dup2(devNull, 1);
+        close(devNull);
+    }
+    return saved;
+}
+
+static void restoreStdout(int saved) {
+    fflush(stdout);
+    if (saved < 0) return;
+    dup2(saved, 1);
+    close(saved);
+}
+
+// --- Benchmarks ---
+
+static void benchAddStudent(int count, int repeat) {
+    // Own SRNs, so the dataset's entries in the SRN index are left alone.
+    char (*srns)[20] = malloc(sizeof(*srns) * (size_t)count);
+    if (srns == NULL) return;
+    for (int i = 0; i < count; i++) sprintf(srns[i], "BENCH%07d", i);
+    shuffle(srns, count);
+    char name[] = "Benchmark Student";
+    double runs[MICRO_MAX_REPEAT];
+    for (int r = 0; r < repeat; r++) {
+        StudentNode* root = NULL;
+        double start = nowSeconds();
+        for (int i = 0; i < count; i++) root = addStudent(root, srns[i], name);
+        runs[r] = nowSeconds() - start;
+        freeTree(root);
+    }
+    record("addStudent", count, runs, repeat);
+    free(srns);
+}
+
+static void benchLookups(StudentNode* root, int count, int repeat) {
+    char (*srns)[20] = malloc(sizeof(*srns) * (size_t)count);
+    if (srns == NULL) return;
+    for (int i = 0; i < count; i++) datasetSRN(i, srns[i]);
+    shuffle(srns, count);
+    double treeRuns[MICRO_MAX_REPEAT], hashRuns[MICRO_MAX_REPEAT];
+    volatile size_t found = 0; // Keeps the loops from being optimized away
+    for (int r = 0; r < repeat; r++) {
+        double start = nowSeconds();
+        for (int i = 0; i < count; i++) found += findStudent(root, srns[i]) != NULL;
+        treeRuns[r] = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < count; i++) found += lookupStudent(root, srns[i]) != NULL;
+        hashRuns[r] = nowSeconds() - start;
+    }
+    record("findStudent", count, treeRuns, repeat);
+    record("lookupStudent", count, hashRuns, repeat);
+    free(srns);
+}
+
+static void benchReports(StudentNode* root, int studentCount, int repeat) {
+    int subjectReports = studentCount < 1000 ? studentCount : 1000;
+    int masterReports = studentCount < 200 ? studentCount : 200;
+    if (subjectReports == 0) return;
+    char srn[20], subject[50];
+    strcpy(subject, datasetSubject(0));
+    double subjectRuns[MICRO_MAX_REPEAT], masterRuns[MICRO_MAX_REPEAT];
+    for (int r = 0; r < repeat; r++) {
+        int saved = silenceStdout();
+        double start = nowSeconds();
+        for (int i = 0; i < subjectReports; i++) {
+            datasetSRN((int)((long long)i * studentCount / subjectReports), srn);
+            generateSubjectReport(lookupStudent(root, srn), subject);
+        }
+        subjectRuns[r] = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < masterReports; i++) {
+            datasetSRN((int)((long long)i * studentCount / masterReports), srn);
+            generateMasterReport(lookupStudent(root, srn));
+        }
+        masterRuns[r] = nowSeconds() - start;
+        restoreStdout(saved);
+    }
+    record("generateSubjectReport", subjectReports, subjectRuns, repeat);
+    record("generateMasterReport", masterReports, masterRuns, repeat);
+}
+
+static const struct {
+    DataFormat format;
+    const char* name;
+} formats[] = {
+    { DATA_FORMAT_TEXT, "text" },
+    { DATA_FORMAT_BINARY, "binary" },
+    { DATA_FORMAT_SEGMENTED, "segments" },
+    { DATA_FORMAT_BLOCKS, "blocks" },
+};
+#define FORMAT_COUNT (int)(sizeof(formats) / sizeof(formats[0]))
+
+static void formatPath(char* path, size_t size, const char* dir, int f) {
+    snprintf(path, size, "%s/bench_micro.%s", dir, formats[f].name);
+}
+
+// Times per student, so the numbers compare across class sizes.
+static void benchSave(TeacherNode* teachers, StudentNode* students, int studentCount, int repeat, const char* dir) {
+    char path[512], name[48];
+    double runs[MICRO_MAX_REPEAT];
+    for (int f = 0; f < FORMAT_COUNT; f++) {
+        formatPath(path, sizeof(path), dir, f);
+        for (int r = 0; r < repeat; r++) {
+            remove(path); // Segment stores would otherwise save only what changed
+            double start = nowSeconds();
+            int ok = saveDataToFile(path, formats[f].format, teachers, students);
+            runs[r] = nowSeconds() - start;
+            if (!ok) {
+                printf("Error: Could not write %s.\n", path);
+                return;
+            }
+        }
+        snprintf(name, sizeof(name), "saveData/%s", formats[f].name);
+        record(name, studentCount > 0 ? studentCount : 1, runs, repeat);
+    }
+}
+
+// Needs an empty database: every run loads, is timed, and is released.
+static void benchLoad(int studentCount, int repeat, const char* dir) {
+    char path[512], name[48];
+    double runs[MICRO_MAX_REPEAT];
+    for (int f = 0; f < FORMAT_COUNT; f++) {
+        formatPath(path, sizeof(path), dir, f);
+        for (int r = 0; r < repeat; r++) {
+            TeacherNode* teachers = NULL;
+            StudentNode* students = NULL;
+            double start = nowSeconds();
+            int ok = loadDataFromFile(path, &teachers, &students);
+            runs[r] = nowSeconds() - start;
+            releaseAllData();
+            if (!ok) {
+                printf("Error: Could not load %s.\n", path);
+                return;
+            }
+        }
+        snprintf(name, sizeof(name), "loadData/%s", formats[f].name);
+        record(name, studentCount > 0 ? studentCount : 1, runs, repeat);
+        remove(path);
+    }
+}
+
+// --- Output ---
+
+static int writeJSON(const char* path, const DatasetOptions* options, int repeat) {
+    FILE* fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (fp == NULL) return 0;
+    fprintf(fp, "{\n  \"suite\": \"student_tracker_micro\",\n  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(fp, "  \"students\": %d,\n  \"subjects\": %d,\n  \"days\": %d,\n  \"repeat\": %d,\n",
+            options->students, options->subjects, options->days, repeat);
+    fprintf(fp, "  \"results\": [\n");
+    for (int i = 0; i < resultCount; i++) {
+        const MicroResult* result = &results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"ops\": %ld, \"median_ns_per_op\": %.1f, \"best_ns_per_op\": %.1f, \"median_seconds\": %.6f}%s\n",
+                result->name, result->ops, result->median * 1e9 / (double)result->ops,
+                result->best * 1e9 / (double)result->ops, result->median, i + 1 < resultCount ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    int ok = !ferror(fp);
+    if (fp != stdout) ok = (fclose(fp) == 0) && ok;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    DatasetOptions options = { 20000, 6, 60, 12345 };
+    if (argc > 1) options.students = atoi(argv[1]);
+    if (argc > 2) options.subjects = atoi(argv[2]);
+    if (argc > 3) options.days = atoi(argv[3]);
+    int repeat = (argc > 4) ? atoi(argv[4]) : 5;
+    const char* jsonPath = (argc > 5) ? argv[5] : NULL;
+    const char* dir = (argc > 6) ? argv[6] : ".";
+    if (options.students <= 0) options.students = 20000;
+    if (options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS) options.subjects = 6;
+    if (options.days < 0) options.days = 60;
+    if (repeat < 1) repeat = 1;
+    if (repeat > MICRO_MAX_REPEAT) repeat = MICRO_MAX_REPEAT;
+
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    printf("Microbenchmarks: %d students, %d subjects, %d days, %d runs each\n",
+           options.students, options.subjects, options.days, repeat);
+    if (!generateDataset(&options, &teachers, &students)) {
+        printf("Error: Out of memory generating the dataset.\n");
+        return 1;
+    }
+    printf("%-28s %9s %14s %14s %10s\n", "benchmark", "ops", "median ns/op", "best ns/op", "median s");
+
+    benchAddStudent(options.students, repeat);
+    benchLookups(students, options.students, repeat);
+    benchReports(students, options.students, repeat);
+    benchSave(teachers, students, options.students, repeat, dir);
+    releaseAllData();
+    benchLoad(options.students, repeat, dir);
+
+    if (jsonPath != NULL && !writeJSON(jsonPath, &options, repeat)) {
+        printf("Error: Could not write %s.\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Benchmark: startup time of a text save file by parser thread count.
+//
+// Build with CMake (target bench_parallel_load), then run it from
+// the build directory:
+//   ./bench_parallel_load [students] [subjects] [days] [maxThreads] [workDir]
+//
+// Generates a class (see dataset.h; default 20000 students, 6 subjects and
+// 60 days) and saves it as text. Then it times loadDataFromFile with 1, 2,
+// 4, ... parser threads up to maxThreads (default: one per online CPU). After
+// each load the data is saved as text again and compared byte for byte with
+// the single-threaded result, so a faster load that reads the file
+// differently shows up as a mismatch.
+
+#include "dataset.h"
+#include "bulk_load.h"
+#include "cohort_report.h"
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long fileSize(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static int sameFiles(const char* first, const char* second) {
+    FILE* a = fopen(first, "rb");
+    FILE* b = fopen(second, "rb");
+    int same = (a != NULL && b != NULL);
+    char bufferA[65536], bufferB[65536];
+    while (same) {
+        size_t gotA = fread(bufferA, 1, sizeof(bufferA), a);
+        size_t gotB = fread(bufferB, 1, sizeof(bufferB), b);
+        if (gotA != gotB || memcmp(bufferA, bufferB, gotA) != 0) same = 0;
+        if (gotA == 0) break;
+    }
+    if (a != NULL) fclose(a);
+    if (b != NULL) fclose(b);
+    return same;
+}
+
+// Loads 'path' into an empty database, saves it as text to 'savedPath' and
+// releases it again. Returns the load time alone.
+static double timeLoad(const char* path, const char* savedPath, int* ok) {
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    double start = nowSeconds();
+    *ok = loadDataFromFile(path, &teachers, &students);
+    double elapsed = nowSeconds() - start;
+    if (*ok) *ok = saveDataToFile(savedPath, DATA_FORMAT_TEXT, teachers, students);
+    releaseAllData();
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    DatasetOptions options = { 20000, 6, 60, 1 };
+    if (argc > 1) options.students = atoi(argv[1]);
+    if (argc > 2) options.subjects = atoi(argv[2]);
+    if (argc > 3) options.days = atoi(argv[3]);
+    int maxThreads = (argc > 4) ? atoi(argv[4]) : cohortDefaultThreads();
+    const char* dir = (argc > 5) ? argv[5] : ".";
+    if (options.students <= 0) options.students = 20000;
+    if (options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS) options.subjects = 6;
+    if (options.days < 0) options.days = 60;
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > BULK_MAX_THREADS) maxThreads = BULK_MAX_THREADS;
+
+    char textPath[512], referencePath[512], savedPath[512];
+    snprintf(textPath, sizeof(textPath), "%s/bench_parallel_load.txt", dir);
+    snprintf(referencePath, sizeof(referencePath), "%s/bench_parallel_load.ref", dir);
+    snprintf(savedPath, sizeof(savedPath), "%s/bench_parallel_load.out", dir);
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    if (!generateDataset(&options, &teachers, &students) ||
+        !saveDataToFile(textPath, DATA_FORMAT_TEXT, teachers, students)) {
+        printf("Error: Could not write %s.\n", textPath);
+        return 1;
+    }
+    releaseAllData();
+
+    printf("Parallel text load benchmark, %d students x %d subjects x %d days\n",
+           options.students, options.subjects, options.days);
+    printf("text file | %11ld bytes\n", fileSize(textPath));
+    int ok, failed = 0;
+    double single = 0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+        setBulkLoadThreads(threads);
+        double elapsed = timeLoad(textPath, threads == 1 ? referencePath : savedPath, &ok);
+        if (threads == 1) single = elapsed;
+        const char* result = !ok ? " | FAILED" : (threads > 1 && !sameFiles(referencePath, savedPath)) ? " | MISMATCH" : "";
+        if (*result) failed = 1;
+        printf("text load | %2d thread(s) | %8.3fs | speedup %5.2fx%s\n", threads, elapsed,
+               elapsed > 0 ? single / elapsed : 0.0, result);
+        if (threads == maxThreads) break;
+    }
+    setBulkLoadThreads(0);
+
+    remove(textPath);
+    remove(referencePath);
+    remove(savedPath);
+    return failed;
+}
@@ -0,0 +1,106 @@
+// Benchmark: AVL student index vs. the original unbalanced BST.
+//
+// Build with CMake (target bench_student_index), then run it from
+// the build directory:
+//   ./bench_student_index [studentCount]
+//
+// Both trees are filled with the same SRNs in sorted order (how the registrar
+// hands them out) and in random order, then every SRN is looked up once.
+
+#include "student_tracker.h"
+#include <time.h>
+
+// --- Original unbalanced BST (kept here only for comparison) ---
+
+// Same insertion rule as the original addStudent, written as a loop so the
+// degenerate sorted case does not exhaust the stack. Tracks the tree height.
+static int legacyMaxDepth = 0;
+
+static StudentNode* legacyAdd(StudentNode* root, char* srn, char* name) {
+    StudentNode** link = &root;
+    int depth = 1;
+    while (*link != NULL) {
+        int compare = strcmp(srn, (*link)->studentSRN);
+        if (compare == 0) return root;
+        link = (compare < 0) ? &(*link)->left : &(*link)->right;
+        depth++;
+    }
+    *link = createStudent(srn, name);
+    if (depth > legacyMaxDepth) legacyMaxDepth = depth;
+    return root;
+}
+
+static StudentNode* legacyFind(StudentNode* root, char* srn) {
+    while (root != NULL) {
+        int compare = strcmp(srn, root->studentSRN);
+        if (compare == 0) return root;
+        root = (compare < 0) ? root->left : root->right;
+    }
+    return NULL;
+}
+
+// --- Helpers ---
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void shuffle(char (*srns)[20], int count) {
+    unsigned int seed = 12345;
+    for (int i = count - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)(seed % (unsigned int)(i + 1));
+        if (j == i) continue; // strcpy onto itself is undefined
+        char temp[20];
+        strcpy(temp, srns[i]);
+        strcpy(srns[i], srns[j]);
+        strcpy(srns[j], temp);
+    }
+}
+
+static void runCase(const char* order, char (*srns)[20], int count) {
+    char name[] = "Benchmark Student";
+    double start, insertTime, findTime;
+
+    StudentNode* avl = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < count; i++) avl = addStudent(avl, srns[i], name);
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < count; i++) findStudent(avl, srns[i]);
+    findTime = nowSeconds() - start;
+    printf("%-7s | avl    | insert %9.4fs | find %9.4fs | height %d\n",
+           order, insertTime, findTime, studentHeight(avl));
+    freeTree(avl);
+
+    StudentNode* bst = NULL;
+    legacyMaxDepth = 0;
+    start = nowSeconds();
+    for (int i = 0; i < count; i++) bst = legacyAdd(bst, srns[i], name);
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < count; i++) legacyFind(bst, srns[i]);
+    findTime = nowSeconds() - start;
+    printf("%-7s | legacy | insert %9.4fs | find %9.4fs | height %d\n",
+           order, insertTime, findTime, legacyMaxDepth);
+    freeTree(bst); // Iterative, so the sorted case's 'count'-deep chain is fine
+}
+
+int main(int argc, char* argv[]) {
+    int count = (argc > 1) ? atoi(argv[1]) : 20000;
+    if (count <= 0) count = 20000;
+
+    char (*srns)[20] = malloc(sizeof(*srns) * (size_t)count);
+    if (srns == NULL) return 1;
+    for (int i = 0; i < count; i++) sprintf(srns[i], "PES1UG22%07d", i);
+
+    printf("Student index benchmark, %d students\n", count);
+    runCase("sorted", srns, count);
+    shuffle(srns, count);
+    runCase("random", srns, count);
+
+    free(srns);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "dataset.h"
+
+static const char* subjectNames[] = {
+    "Mathematics", "Physics", "Chemistry", "C Programming", "Data Structures",
+    "Digital Logic", "Computer Networks", "Operating Systems", "Database Systems",
+    "Discrete Mathematics", "Electronics", "Engineering Drawing"
+};
+#define NAMED_SUBJECTS (int)(sizeof(subjectNames) / sizeof(subjectNames[0]))
+
+static const char* firstNames[] = {
+    "Aarav", "Aditi", "Ananya", "Arjun", "Asha", "Bhavya", "Deepak", "Divya",
+    "Farhan", "Gaurav", "Ishaan", "Jane", "John", "Kavya", "Karan", "Lakshmi",
+    "Meera", "Mohammed", "Neha", "Nikhil", "Omar", "Pooja", "Priya", "Rahul",
+    "Ravi", "Riya", "Rohan", "Sara", "Shreya", "Siddharth", "Sneha", "Tanvi",
+    "Tom", "Varun", "Vikram", "Yash"
+};
+static const char* lastNames[] = {
+    "Agarwal", "Bhat", "Brown", "Das", "Fernandes", "Gupta", "Hegde", "Iyer",
+    "Jain", "Joshi", "Kamath", "Khan", "Kulkarni", "Menon", "Mishra", "Nair",
+    "Patel", "Pillai", "Rao", "Reddy", "Shah", "Sharma", "Shetty", "Singh",
+    "Smith", "Verma"
+};
+#define COUNT_OF(array) (int)(sizeof(array) / sizeof((array)[0]))
+
+// xorshift32: small, fast and the same on every platform.
+static unsigned int nextRandom(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int randomBelow(unsigned int* state, int limit) {
+    return (int)(nextRandom(state) % (unsigned int)limit);
+}
+
+const char* datasetSubject(int index) {
+    static char elective[50];
+    if (index < NAMED_SUBJECTS) return subjectNames[index];
+    sprintf(elective, "Elective %d", index - NAMED_SUBJECTS + 1);
+    return elective;
+}
+
+void datasetSRN(int index, char* srn) {
+    sprintf(srn, "PES1UG22%07d", index);
+}
+
+// Fills 'dates' with the first 'days' weekdays from 2025-08-01 (a Friday).
+static void teachingDays(char (*dates)[11], int days) {
+    static const int monthDays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int year = 2025, month = 8, day = 1, weekday = 5; // 0 = Sunday
+    for (int filled = 0; filled < days;) {
+        if (weekday != 0 && weekday != 6) sprintf(dates[filled++], "%04d-%02d-%02d", year, month, day);
+        weekday = (weekday + 1) % 7;
+        int length = monthDays[month - 1] + (month == 2 && year % 4 == 0);
+        if (++day > length) {
+            day = 1;
+            if (++month > 12) {
+                month = 1;
+                year++;
+            }
+        }
+    }
+}
+
+// A mark out of 'max' around the student's ability (0..100).
+static int markFor(unsigned int* state, int ability, int max) {
+    int percent = ability + randomBelow(state, 31) - 15;
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+    return (percent * max + 50) / 100;
+}
+
+int generateDataset(const DatasetOptions* options, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    int subjects = options->subjects < 1 ? 1 : options->subjects;
+    if (subjects > DATASET_MAX_SUBJECTS) subjects = DATASET_MAX_SUBJECTS;
+    int days = options->days < 0 ? 0 : options->days;
+    unsigned int state = options->seed ? options->seed : 1;
+
+    char id[20], name[100], password[] = "password123", subject[50];
+    for (int s = 0; s < subjects; s++) {
+        sprintf(id, "TS%03d", s + 1);
+        sprintf(name, "Prof. %s", lastNames[s % COUNT_OF(lastNames)]);
+        strcpy(subject, datasetSubject(s));
+        *teacherRoot = addTeacher(*teacherRoot, id, name, password, subject);
+    }
+
+    char (*dates)[11] = malloc(sizeof(*dates) * (size_t)(days > 0 ? days : 1));
+    StudentNode** students = malloc(sizeof(StudentNode*) * (size_t)(options->students > 0 ? options->students : 1));
+    if (dates == NULL || students == NULL) {
+        free(dates);
+        free(students);
+        return 0;
+    }
+    teachingDays(dates, days);
+
+    unsigned char* attendanceRates = malloc((size_t)(options->students > 0 ? options->students : 1));
+    if (attendanceRates == NULL) {
+        free(dates);
+        free(students);
+        return 0;
+    }
+
+    char srn[20], desc[50];
+    for (int i = 0; i < options->students; i++) {
+        datasetSRN(i, srn);
+        sprintf(name, "%s %s", firstNames[randomBelow(&state, COUNT_OF(firstNames))],
+                lastNames[randomBelow(&state, COUNT_OF(lastNames))]);
+        students[i] = createStudent(srn, name);
+        if (students[i] == NULL) {
+            for (int j = 0; j < i; j++) freeStudent(students[j]);
+            free(attendanceRates);
+            free(dates);
+            free(students);
+            return 0;
+        }
+        int ability = 35 + randomBelow(&state, 61);
+        attendanceRates[i] = (unsigned char)(70 + randomBelow(&state, 31));
+        for (int s = 0; s < subjects; s++) {
+            strcpy(subject, datasetSubject(s));
+            for (int type = INTERNAL_1; type <= SEMESTER_EXAM; type++) {
+                strcpy(desc, recordTypeName((RecordType)type));
+                addPerformanceRecord(students[i], (RecordType)type, markFor(&state, ability, recordTypeMaxMark((RecordType)type)), subject, desc);
+            }
+        }
+    }
+
+    // Roll calls go straight into the session bitmaps, as the loaders do, one
+    // session at a time so every student's entry lands in the same session.
+    for (int s = 0; s < subjects; s++) {
+        SymbolId subjectId = internSymbol(datasetSubject(s));
+        for (int d = 0; d < days; d++) {
+            SymbolId dateId = internSymbol(dates[d]);
+            for (int i = 0; i < options->students; i++) {
+                setAttendance(subjectId, dateId, students[i]->ordinal, randomBelow(&state, 100) < attendanceRates[i]);
+            }
+        }
+    }
+
+    // SRNs were handed out in order, so the nodes are already sorted.
+    *studentRoot = buildBalancedStudentTree(students, (size_t)options->students);
+    free(attendanceRates);
+    free(dates);
+    free(students);
+    return 1;
+}
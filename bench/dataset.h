@@ -0,0 +1,35 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include "student_tracker.h"
+
+// --- Synthetic Datasets ---
+//
+// Builds a realistic class in memory for the benchmarks and for gen_data:
+// one teacher per subject (TS001, TS002, ... with password "password123"),
+// and students PES1UG22<7 digits> with names drawn from common first and
+// last names. Every student gets the five marks in every subject (spread
+// around a per-student ability) and one roll call per subject for each of
+// 'days' teaching days (weekdays from 2025-08-01), present about 85% of
+// the time. The same seed always gives the same data.
+
+#define DATASET_MAX_SUBJECTS 64
+
+typedef struct {
+    int students;
+    int subjects;
+    int days;
+    unsigned int seed;
+} DatasetOptions;
+
+// Name of subject 'index' (real subject names first, then "Elective N").
+// The text stays valid until the next call.
+const char* datasetSubject(int index);
+
+// SRN of student 'index', as the generator assigns it.
+void datasetSRN(int index, char* srn);
+
+// Builds the dataset into two empty roots. Returns 0 if memory ran out.
+int generateDataset(const DatasetOptions* options, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+#endif // DATASET_H
@@ -0,0 +1,59 @@
+// Synthetic data.dat generator.
+//
+// Build with CMake (target gen_data), then run from the build directory:
+//   ./gen_data <output file> [students] [subjects] [days] [text|binary|segments|blocks] [seed]
+//
+// Writes a class of 'students' (default 1000) taught 'subjects' subjects
+// (default 6) with 'days' roll calls per subject (default 60) in the chosen
+// save format (default text). See dataset.h for what the data looks like.
+// Log in as TS001 / password123 to browse it.
+
+#include "dataset.h"
+#include <time.h>
+
+static int parseFormat(const char* text, DataFormat* format) {
+    if (strcmp(text, "text") == 0) *format = DATA_FORMAT_TEXT;
+    else if (strcmp(text, "binary") == 0) *format = DATA_FORMAT_BINARY;
+    else if (strcmp(text, "segments") == 0) *format = DATA_FORMAT_SEGMENTED;
+    else if (strcmp(text, "blocks") == 0) *format = DATA_FORMAT_BLOCKS;
+    else return 0;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <output file> [students] [subjects] [days] [text|binary|segments|blocks] [seed]\n", argv[0]);
+        return 1;
+    }
+    DatasetOptions options = { 1000, 6, 60, 12345 };
+    if (argc > 2) options.students = atoi(argv[2]);
+    if (argc > 3) options.subjects = atoi(argv[3]);
+    if (argc > 4) options.days = atoi(argv[4]);
+    DataFormat format = DATA_FORMAT_TEXT;
+    if (argc > 5 && !parseFormat(argv[5], &format)) {
+        printf("Error: Unknown format '%s' (use text, binary, segments or blocks).\n", argv[5]);
+        return 1;
+    }
+    if (argc > 6) options.seed = (unsigned int)strtoul(argv[6], NULL, 10);
+    if (options.students < 0 || options.subjects < 1 || options.subjects > DATASET_MAX_SUBJECTS || options.days < 0) {
+        printf("Error: Need students >= 0, 1 <= subjects <= %d and days >= 0.\n", DATASET_MAX_SUBJECTS);
+        return 1;
+    }
+
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    clock_t start = clock();
+    if (!generateDataset(&options, &teachers, &students)) {
+        printf("Error: Out of memory generating %d students.\n", options.students);
+        return 1;
+    }
+    if (!saveDataToFile(argv[1], format, teachers, students)) {
+        printf("Error: Could not write %s.\n", argv[1]);
+        releaseAllData();
+        return 1;
+    }
+    printf("Wrote %d student(s), %d subject(s), %d day(s) of attendance to %s in %.2fs.\n",
+           options.students, options.subjects, options.days, argv[1], (double)(clock() - start) / CLOCKS_PER_SEC);
+    releaseAllData();
+    return 0;
+}
@@ -0,0 +1,658 @@
+#include "block_store.h"
+#include "bulk_load.h"
+#include "checksum.h"
+#include "cohort_report.h"
+#include "lz_codec.h"
+#include "op_stats.h"
+#include "tree_cursor.h"
+#include <pthread.h>
+#include <stddef.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#if !defined(_WIN32) && !defined(SNAPSHOT_NO_MMAP)
+#include <sys/mman.h>
+#endif
+
+#define BLOCK_LOAD_WINDOW 64   // Blocks decompressed ahead of the one being decoded
+#define BLOCK_FOOTER_V1_SIZE (sizeof(BlockFooter) - offsetof(BlockFooter, indexOffset))
+
+static int blockThreads = 0;
+
+void setBlockStoreThreads(int threads) {
+    blockThreads = threads;
+}
+
+// --- Writing ---
+
+typedef struct {
+    FILE* fp;
+    uint64_t end;              // Bytes written so far
+    BlockEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+    int failed;
+} BlockWriter;
+
+static void writeBytes(BlockWriter* writer, const void* data, size_t size) {
+    if (writer->failed) return;
+    if (fwrite(data, 1, size, writer->fp) != size) writer->failed = 1;
+    writer->end += size;
+}
+
+static void padTo8(BlockWriter* writer) {
+    static const char zeros[8] = {0};
+    writeBytes(writer, zeros, (size_t)((8 - writer->end % 8) % 8));
+}
+
+static BlockEntry* addBlockEntry(BlockWriter* writer) {
+    if (writer->count == writer->capacity) {
+        uint32_t newCapacity = writer->capacity ? writer->capacity * 2 : 64;
+        BlockEntry* grown = (BlockEntry*)realloc(writer->entries, newCapacity * sizeof(BlockEntry));
+        if (grown == NULL) return NULL;
+        writer->entries = grown;
+        writer->capacity = newCapacity;
+    }
+    BlockEntry* entry = &writer->entries[writer->count++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+// Compresses 'raw' and writes whichever is smaller, the compressed or the
+// raw bytes. Fills in where they went. Returns 0 if memory runs out.
+static int writeCompressed(BlockWriter* writer, const char* raw, size_t rawSize, uint64_t* offset,
+                           uint32_t* size, uint32_t* codec, uint32_t* checksum) {
+    char* packed = rawSize <= UINT32_MAX ? (char*)malloc(lzCompressBound(rawSize)) : NULL;
+    if (packed == NULL) {
+        writer->failed = 1;
+        return 0;
+    }
+    size_t packedSize = lzCompress(raw, rawSize, packed);
+    const char* bytes = packed;
+    *codec = BLOCK_LZ;
+    if (packedSize >= rawSize) {
+        bytes = raw;
+        packedSize = rawSize;
+        *codec = BLOCK_STORED;
+    }
+    *offset = writer->end;
+    *size = (uint32_t)packedSize;
+    *checksum = crc32Checksum(bytes, packedSize);
+    writeBytes(writer, bytes, packedSize);
+    free(packed);
+    return 1;
+}
+
+// Encodes, compresses and writes one block, then records it in the index.
+static void writeBlock(BlockWriter* writer, TeacherNode* teacherRoot, StudentNode** students, size_t count) {
+    if (writer->failed) return;
+    size_t rawSize = 0;
+    char* image = encodeSnapshotImage(teacherRoot, students, count, &rawSize);
+    BlockEntry* entry = image && rawSize <= UINT32_MAX ? addBlockEntry(writer) : NULL;
+    if (entry == NULL) {
+        free(image);
+        writer->failed = 1;
+        return;
+    }
+    writeCompressed(writer, image, rawSize, &entry->offset, &entry->size, &entry->codec, &entry->checksum);
+    entry->rawSize = (uint32_t)rawSize;
+    entry->studentCount = (uint32_t)count;
+    if (count > 0) strcpy(entry->firstSRN, students[0]->studentSRN);
+    free(image);
+}
+
+// Writes every student's "SRN\0name\0", in SRN order, for lazy loading.
+static void writeRoster(BlockWriter* writer, StudentNode** students, size_t count, BlockFooter* footer) {
+    if (writer->failed) return;
+    size_t rawSize = 0;
+    for (size_t i = 0; i < count; i++) rawSize += strlen(students[i]->studentSRN) + strlen(students[i]->name) + 2;
+    char* roster = (char*)malloc(rawSize ? rawSize : 1);
+    if (roster == NULL) {
+        writer->failed = 1;
+        return;
+    }
+    char* out = roster;
+    for (size_t i = 0; i < count; i++) {
+        size_t srnLength = strlen(students[i]->studentSRN) + 1, nameLength = strlen(students[i]->name) + 1;
+        memcpy(out, students[i]->studentSRN, srnLength);
+        memcpy(out + srnLength, students[i]->name, nameLength);
+        out += srnLength + nameLength;
+    }
+    if (writeCompressed(writer, roster, rawSize, &footer->rosterOffset, &footer->rosterSize,
+                        &footer->rosterCodec, &footer->rosterChecksum)) {
+        footer->rosterRawSize = (uint32_t)rawSize;
+        footer->studentCount = (uint32_t)count;
+    }
+    free(roster);
+}
+
+int saveBlockStore(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    StudentNode** students = NULL;
+    size_t count = 0, capacity = 0;
+    TreeCursor cursor;
+    StudentNode* student;
+    int ok = 1;
+    openStudentCursor(&cursor, studentRoot, CURSOR_IN_ORDER);
+    while (ok && (student = nextStudent(&cursor)) != NULL) {
+        if (count == capacity) {
+            size_t newCapacity = capacity ? capacity * 2 : 256;
+            StudentNode** grown = (StudentNode**)realloc(students, newCapacity * sizeof(StudentNode*));
+            if (grown == NULL) ok = 0;
+            else {
+                students = grown;
+                capacity = newCapacity;
+            }
+        }
+        if (ok) students[count++] = student;
+    }
+    if (cursor.failed) ok = 0;
+    closeCursor(&cursor);
+
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    BlockWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.fp = ok ? fopen(tempPath, "wb") : NULL;
+    if (writer.fp == NULL) {
+        free(students);
+        return 0;
+    }
+    writeBytes(&writer, BLOCK_STORE_MAGIC, BLOCK_DATA_START);
+    writeBlock(&writer, teacherRoot, NULL, 0);
+    if (count == 0) writeBlock(&writer, NULL, NULL, 0);
+    for (size_t start = 0; start < count; start += BLOCK_TARGET_STUDENTS) {
+        size_t chunk = count - start;
+        if (chunk > BLOCK_TARGET_STUDENTS) chunk = BLOCK_TARGET_STUDENTS;
+        writeBlock(&writer, NULL, students + start, chunk);
+    }
+    BlockFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    writeRoster(&writer, students, count, &footer);
+    free(students);
+
+    padTo8(&writer);
+    footer.indexOffset = writer.end;
+    footer.blockCount = writer.count;
+    footer.indexChecksum = crc32Checksum(writer.entries, writer.count * sizeof(BlockEntry));
+    footer.journalSequence = getDataSequence();
+    footer.fileSize = writer.end + writer.count * sizeof(BlockEntry) + sizeof(BlockFooter);
+    footer.version = BLOCK_STORE_VERSION;
+    footer.byteOrderMark = SNAPSHOT_BYTE_ORDER_MARK;
+    memcpy(footer.magic, BLOCK_STORE_MAGIC, sizeof(footer.magic));
+    writeBytes(&writer, writer.entries, writer.count * sizeof(BlockEntry));
+    writeBytes(&writer, &footer, sizeof(footer));
+    free(writer.entries);
+
+    ok = !writer.failed && fflush(writer.fp) == 0;
+#ifndef _WIN32
+    if (ok && fsync(fileno(writer.fp)) != 0) ok = 0; // On disk before it replaces the old file
+#endif
+    if (fclose(writer.fp) != 0) ok = 0;
+    if (!ok || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return 0;
+    }
+    return 1;
+}
+
+// --- Opening ---
+
+int isBlockStoreFile(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    char magic[8];
+    int match = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+                memcmp(magic, BLOCK_STORE_MAGIC, sizeof(magic)) == 0;
+    fclose(fp);
+    return match;
+}
+
+// Block 0 holds the teachers; every other block holds students, in
+// ascending SRN order. Only an empty class has an empty student block.
+static int indexValid(const BlockFooter* footer, const BlockEntry* entries) {
+    if (footer->blockCount < 2) return 0;
+    for (uint32_t i = 0; i < footer->blockCount; i++) {
+        const BlockEntry* entry = &entries[i];
+        if (entry->offset < BLOCK_DATA_START || entry->offset > footer->indexOffset ||
+            entry->size > footer->indexOffset - entry->offset) {
+            return 0;
+        }
+        if (entry->codec != BLOCK_LZ && (entry->codec != BLOCK_STORED || entry->size != entry->rawSize)) return 0;
+        if (memchr(entry->firstSRN, '\0', sizeof(entry->firstSRN)) == NULL) return 0;
+        int empty = entry->studentCount == 0 && entry->firstSRN[0] == '\0';
+        if (i == 0 && !empty) return 0;
+        if (i > 0 && (entry->studentCount == 0 || entry->firstSRN[0] == '\0') && !(empty && footer->blockCount == 2)) return 0;
+        if (i > 1 && strcmp(entries[i - 1].firstSRN, entry->firstSRN) >= 0) return 0;
+    }
+    return 1;
+}
+
+// Reads the footer of either version; a v1 footer leaves the roster fields zero.
+static int readFooter(BlockStore* store) {
+    const MappedFile* file = &store->file;
+    if (file->size < BLOCK_DATA_START + BLOCK_FOOTER_V1_SIZE ||
+        memcmp(file->data, BLOCK_STORE_MAGIC, BLOCK_DATA_START) != 0) {
+        return 0;
+    }
+    uint32_t version;
+    memcpy(&version, file->data + file->size - 16, sizeof(version)); // version, byteOrderMark and magic end both
+    memset(&store->footer, 0, sizeof(store->footer));
+    if (version == 1) store->footerSize = BLOCK_FOOTER_V1_SIZE;
+    else if (version == BLOCK_STORE_VERSION && file->size >= BLOCK_DATA_START + sizeof(BlockFooter)) {
+        store->footerSize = sizeof(BlockFooter);
+    } else {
+        return 0;
+    }
+    memcpy((char*)(&store->footer + 1) - store->footerSize, file->data + file->size - store->footerSize, store->footerSize);
+    return 1;
+}
+
+int openBlockStore(const char* path, BlockStore* store) {
+    if (!mapDataFile(path, &store->file)) return 0;
+    const MappedFile* file = &store->file;
+    int ok = readFooter(store);
+    if (ok) {
+        const BlockFooter* footer = &store->footer;
+        size_t indexEnd = file->size - store->footerSize;
+        ok = memcmp(footer->magic, BLOCK_STORE_MAGIC, sizeof(footer->magic)) == 0 &&
+             footer->byteOrderMark == SNAPSHOT_BYTE_ORDER_MARK &&
+             footer->fileSize == file->size &&
+             footer->indexOffset % 8 == 0 && footer->indexOffset >= BLOCK_DATA_START &&
+             footer->indexOffset <= indexEnd &&
+             footer->blockCount == (indexEnd - footer->indexOffset) / sizeof(BlockEntry) &&
+             (indexEnd - footer->indexOffset) % sizeof(BlockEntry) == 0;
+        if (ok && footer->version >= 2) {
+            ok = footer->rosterOffset >= BLOCK_DATA_START && footer->rosterOffset <= footer->indexOffset &&
+                 footer->rosterSize <= footer->indexOffset - footer->rosterOffset &&
+                 (footer->rosterCodec == BLOCK_LZ ||
+                  (footer->rosterCodec == BLOCK_STORED && footer->rosterSize == footer->rosterRawSize));
+        }
+    }
+    if (ok) {
+        store->entries = (const BlockEntry*)(file->data + store->footer.indexOffset);
+        ok = crc32Checksum(store->entries, store->footer.blockCount * sizeof(BlockEntry)) == store->footer.indexChecksum &&
+             indexValid(&store->footer, store->entries);
+    }
+    if (!ok) {
+        unmapDataFile(&store->file);
+        return 0;
+    }
+    return 1;
+}
+
+void closeBlockStore(BlockStore* store) {
+    unmapDataFile(&store->file);
+    store->entries = NULL;
+}
+
+// Checks and expands bytes written by writeCompressed into a malloc'd
+// buffer. Returns NULL if they are corrupt.
+static char* expandBytes(const BlockStore* store, uint64_t offset, uint32_t size, uint32_t rawSize,
+                         uint32_t codec, uint32_t checksum) {
+    const char* bytes = store->file.data + offset;
+    if (crc32Checksum(bytes, size) != checksum) return NULL;
+    char* raw = (char*)malloc(rawSize ? rawSize : 1);
+    if (raw == NULL) return NULL;
+    if (codec == BLOCK_STORED) memcpy(raw, bytes, size);
+    else if (!lzDecompress(bytes, size, raw, rawSize)) {
+        free(raw);
+        return NULL;
+    }
+    return raw;
+}
+
+// Checks and expands block 'index' into a malloc'd snapshot image. Returns NULL if it is corrupt.
+static char* expandBlock(const BlockStore* store, uint32_t index) {
+    const BlockEntry* entry = &store->entries[index];
+    return expandBytes(store, entry->offset, entry->size, entry->rawSize, entry->codec, entry->checksum);
+}
+
+// --- Single Students ---
+
+// The student block whose first SRN is the last one at or below 'srn'.
+// Returns 0 if 'srn' sorts before every block.
+static uint32_t findOwningBlock(const BlockStore* store, const char* srn) {
+    uint32_t low = 1, high = store->footer.blockCount - 1;
+    if (strcmp(store->entries[low].firstSRN, srn) > 0) return 0;
+    while (low < high) {
+        uint32_t mid = low + (high - low + 1) / 2;
+        if (strcmp(store->entries[mid].firstSRN, srn) <= 0) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+int readBlockStudent(const BlockStore* store, const char* srn, StudentNode** student) {
+    *student = NULL;
+    uint32_t index = findOwningBlock(store, srn);
+    if (index == 0) return 1;
+    char* image = expandBlock(store, index);
+    if (image == NULL) return 0;
+    int ok = decodeSnapshotStudent(image, store->entries[index].rawSize, srn, student);
+    free(image);
+    return ok;
+}
+
+// --- Loading ---
+//
+// Workers claim blocks in order and decompress them; the loading thread
+// decodes each block into the batch as soon as it is ready, since building
+// nodes and histories is not thread-safe. Workers stay at most
+// BLOCK_LOAD_WINDOW blocks ahead so expanded images do not pile up.
+
+typedef enum { BLOCK_PENDING, BLOCK_READY, BLOCK_FAILED } BlockState;
+
+typedef struct {
+    const BlockStore* store;
+    char** images;
+    unsigned char* states;    // BlockState per block
+    uint32_t next;            // Next block to claim
+    uint32_t decoded;         // Blocks the loading thread is done with
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} BlockLoadJob;
+
+// Claims the next block if the window allows. Returns the block count if not. Call with the lock held.
+static uint32_t claimBlock(BlockLoadJob* job) {
+    if (job->stop || job->next >= job->store->footer.blockCount || job->next >= job->decoded + BLOCK_LOAD_WINDOW) {
+        return job->store->footer.blockCount;
+    }
+    return job->next++;
+}
+
+static void finishBlock(BlockLoadJob* job, uint32_t index, char* image) {
+    pthread_mutex_lock(&job->lock);
+    job->images[index] = image;
+    job->states[index] = image ? BLOCK_READY : BLOCK_FAILED;
+    pthread_cond_broadcast(&job->changed);
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void* blockWorker(void* arg) {
+    BlockLoadJob* job = (BlockLoadJob*)arg;
+    uint32_t count = job->store->footer.blockCount;
+    pthread_mutex_lock(&job->lock);
+    while (!job->stop && job->next < count) {
+        uint32_t index = claimBlock(job);
+        if (index == count) {
+            pthread_cond_wait(&job->changed, &job->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&job->lock);
+        finishBlock(job, index, expandBlock(job->store, index));
+        pthread_mutex_lock(&job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+// Waits for block 'index', expanding it here if no worker has claimed it.
+static char* awaitBlock(BlockLoadJob* job, uint32_t index) {
+    pthread_mutex_lock(&job->lock);
+    if (job->next == index) {
+        job->next++;
+        pthread_mutex_unlock(&job->lock);
+        finishBlock(job, index, expandBlock(job->store, index));
+        pthread_mutex_lock(&job->lock);
+    }
+    while (job->states[index] == BLOCK_PENDING) pthread_cond_wait(&job->changed, &job->lock);
+    char* image = job->images[index];
+    job->images[index] = NULL;
+    pthread_mutex_unlock(&job->lock);
+    return image;
+}
+
+int loadBlockStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    BlockStore store;
+    if (!openBlockStore(path, &store)) return 0;
+    uint32_t count = store.footer.blockCount;
+
+    BlockLoadJob job;
+    memset(&job, 0, sizeof(job));
+    job.store = &store;
+    job.images = (char**)calloc(count, sizeof(char*));
+    job.states = (unsigned char*)calloc(count, 1);
+    if (job.images == NULL || job.states == NULL) {
+        free(job.images);
+        free(job.states);
+        closeBlockStore(&store);
+        return 0;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.changed, NULL);
+
+    // openBlockStore checked the index CRC here, so the workers find the CRC table filled.
+    int threads = blockThreads > 0 ? blockThreads : cohortDefaultThreads();
+    if (threads > BLOCK_MAX_THREADS) threads = BLOCK_MAX_THREADS;
+    if ((uint32_t)threads > count) threads = (int)count;
+    pthread_t ids[BLOCK_MAX_THREADS];
+    int running = 0;
+    for (int t = 1; t < threads; t++) { // The loading thread expands blocks too when it would wait
+        if (pthread_create(&ids[running], NULL, blockWorker, &job) == 0) running++;
+    }
+
+    // Teachers are added last, once every student block decoded cleanly.
+    StudentBatch batch = { NULL, 0, 0 };
+    char* teacherImage = NULL;
+    int ok = 1;
+    for (uint32_t i = 0; i < count && ok; i++) {
+        char* image = awaitBlock(&job, i);
+        if (image == NULL) ok = 0;
+        else if (i == 0) teacherImage = image;
+        else {
+            ok = decodeSnapshotImage(image, store.entries[i].rawSize, teacherRoot, &batch);
+            free(image);
+        }
+        pthread_mutex_lock(&job.lock);
+        job.decoded = i + 1;
+        if (!ok) job.stop = 1;
+        pthread_cond_broadcast(&job.changed);
+        pthread_mutex_unlock(&job.lock);
+    }
+    pthread_mutex_lock(&job.lock);
+    job.stop = 1;
+    pthread_cond_broadcast(&job.changed);
+    pthread_mutex_unlock(&job.lock);
+    for (int t = 0; t < running; t++) pthread_join(ids[t], NULL);
+
+    if (ok) ok = decodeSnapshotImage(teacherImage, store.entries[0].rawSize, teacherRoot, &batch) &&
+                 finishStudentBatch(&batch, studentRoot);
+    if (!ok) discardStudentBatch(&batch);
+    if (ok) setDataSequence(store.footer.journalSequence);
+
+    for (uint32_t i = 0; i < count; i++) free(job.images[i]);
+    free(teacherImage);
+    free(job.images);
+    free(job.states);
+    pthread_cond_destroy(&job.changed);
+    pthread_mutex_destroy(&job.lock);
+    closeBlockStore(&store);
+    return ok;
+}
+
+// --- Lazy Loading ---
+//
+// Slot i is the student at roster position i (node->lazySlot is i + 1)
+// until its history is read or the node is freed. Block b holds the slots
+// from blockStarts[b] up to blockStarts[b + 1].
+
+typedef struct {
+    BlockStore store;
+    int open;
+    StudentNode** slots;
+    uint32_t* blockStarts;    // blockCount + 1 entries
+    size_t pending;           // Slots still holding a node
+} LazyStore;
+
+static LazyStore lazy;
+
+// Splits the roster into SRNs and names, checking it against the index: SRNs
+// strictly increasing, each block's count and first SRN matching. Returns the
+// number of students, or -1 if the roster does not fit the index.
+static long parseRoster(const BlockStore* store, const char* roster, const char** srns, const char** names) {
+    const char* at = roster;
+    const char* end = roster + store->footer.rosterRawSize;
+    const char* previous = NULL;
+    long count = 0;
+    for (uint32_t b = 1; b < store->footer.blockCount; b++) {
+        const BlockEntry* entry = &store->entries[b];
+        for (uint32_t j = 0; j < entry->studentCount; j++) {
+            if ((uint64_t)count == store->footer.studentCount) return -1;
+            const char* srn = at;
+            const char* srnEnd = memchr(srn, '\0', (size_t)(end - srn));
+            if (srnEnd == NULL || srnEnd == srn || srnEnd - srn >= 20) return -1;
+            const char* name = srnEnd + 1;
+            const char* nameEnd = memchr(name, '\0', (size_t)(end - name));
+            if (nameEnd == NULL || nameEnd - name >= 100) return -1;
+            if (previous != NULL && strcmp(previous, srn) >= 0) return -1;
+            if (j == 0 && strcmp(entry->firstSRN, srn) != 0) return -1;
+            srns[count] = srn;
+            names[count] = name;
+            count++;
+            previous = srn;
+            at = nameEnd + 1;
+        }
+    }
+    return (at == end && (uint64_t)count == store->footer.studentCount) ? count : -1;
+}
+
+// Creates a node per roster entry into 'batch' and fills the slot table.
+static int buildLazyStudents(const char* roster, StudentBatch* batch) {
+    const BlockStore* store = &lazy.store;
+    size_t count = store->footer.studentCount;
+    const char** srns = (const char**)malloc((count ? count : 1) * sizeof(char*));
+    const char** names = (const char**)malloc((count ? count : 1) * sizeof(char*));
+    lazy.slots = (StudentNode**)calloc(count ? count : 1, sizeof(StudentNode*));
+    lazy.blockStarts = (uint32_t*)malloc((store->footer.blockCount + 1) * sizeof(uint32_t));
+    int ok = srns && names && lazy.slots && lazy.blockStarts && parseRoster(store, roster, srns, names) >= 0;
+    if (ok) {
+        lazy.blockStarts[0] = 0;
+        for (uint32_t b = 0; b < store->footer.blockCount; b++) {
+            lazy.blockStarts[b + 1] = lazy.blockStarts[b] + store->entries[b].studentCount;
+        }
+    }
+    for (size_t i = 0; ok && i < count; i++) {
+        StudentNode* student = createStudent((char*)srns[i], (char*)names[i]);
+        if (student == NULL || !studentBatchAdd(batch, student)) {
+            freeStudent(student);
+            ok = 0;
+            break;
+        }
+        student->lazySlot = (uint32_t)i + 1;
+        lazy.slots[i] = student;
+    }
+    free(srns);
+    free(names);
+    return ok;
+}
+
+void closeLazyBlockStore(void) {
+    if (!lazy.open) return;
+    closeBlockStore(&lazy.store);
+    free(lazy.slots);
+    free(lazy.blockStarts);
+    memset(&lazy, 0, sizeof(lazy));
+}
+
+int openLazyBlockStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    // Only into an empty database: merging duplicates would need the histories.
+    if (lazy.open || *studentRoot != NULL) return loadBlockStore(path, teacherRoot, studentRoot);
+    BlockStore* store = &lazy.store;
+    if (!openBlockStore(path, store)) return 0;
+    if (store->footer.version < 2) {
+        closeBlockStore(store);
+        return loadBlockStore(path, teacherRoot, studentRoot);
+    }
+
+    const BlockFooter* footer = &store->footer;
+    char* roster = expandBytes(store, footer->rosterOffset, footer->rosterSize, footer->rosterRawSize,
+                               footer->rosterCodec, footer->rosterChecksum);
+    char* teacherImage = roster ? expandBlock(store, 0) : NULL;
+    StudentBatch batch = { NULL, 0, 0 };
+    int ok = teacherImage != NULL && buildLazyStudents(roster, &batch) &&
+             decodeSnapshotImage(teacherImage, store->entries[0].rawSize, teacherRoot, &batch) &&
+             finishStudentBatch(&batch, studentRoot);
+    free(roster);
+    free(teacherImage);
+    if (!ok) {
+        discardStudentBatch(&batch); // The slots are not live yet, so nothing is forgotten twice
+        free(lazy.slots);
+        free(lazy.blockStarts);
+        closeBlockStore(store);
+        memset(&lazy, 0, sizeof(lazy));
+        return 0;
+    }
+    setDataSequence(footer->journalSequence);
+    lazy.pending = footer->studentCount;
+    lazy.open = 1;
+#if !defined(_WIN32) && !defined(SNAPSHOT_NO_MMAP)
+    madvise((void*)store->file.data, store->file.size, MADV_RANDOM); // Blocks are read as students are touched
+#endif
+    if (lazy.pending == 0) closeLazyBlockStore();
+    return 1;
+}
+
+// The student block holding roster position 'slot'.
+static uint32_t slotBlock(uint32_t slot) {
+    uint32_t low = 1, high = lazy.store.footer.blockCount - 1;
+    while (low < high) {
+        uint32_t mid = low + (high - low + 1) / 2;
+        if (lazy.blockStarts[mid] <= slot) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+int faultInHistory(StudentNode* student) {
+    if (student == NULL || student->lazySlot == 0 || !lazy.open) return 1;
+    uint64_t started = STAT_START();
+    uint32_t block = slotBlock(student->lazySlot - 1);
+    const BlockEntry* entry = &lazy.store.entries[block];
+    StudentNode** nodes = lazy.slots + lazy.blockStarts[block];
+    char* image = expandBlock(&lazy.store, block);
+    int ok = image != NULL && decodeSnapshotHistories(image, entry->rawSize, nodes, entry->studentCount);
+    free(image);
+    if (!ok) {
+        // Drops whatever went in, so the block can be tried again.
+        for (uint32_t i = 0; i < entry->studentCount; i++) {
+            if (nodes[i] != NULL) releaseHistory(nodes[i]);
+        }
+        printf("Error: Could not read the records of %s from the save file (block %u is corrupt or memory ran out).\n",
+               student->studentSRN, block);
+        return 0;
+    }
+    for (uint32_t i = 0; i < entry->studentCount; i++) {
+        if (nodes[i] == NULL) continue;
+        nodes[i]->lazySlot = 0;
+        nodes[i] = NULL;
+        lazy.pending--;
+    }
+    STAT_STOP(STAT_FAULT_IN, started, entry->size);
+    if (lazy.pending == 0) closeLazyBlockStore();
+    return 1;
+}
+
+int faultInAllHistories(void) {
+    int ok = 1;
+    for (uint32_t block = 1; lazy.open && block < lazy.store.footer.blockCount; block++) {
+        for (uint32_t i = lazy.blockStarts[block]; i < lazy.blockStarts[block + 1]; i++) {
+            if (lazy.slots[i] == NULL) continue;
+            if (!faultInHistory(lazy.slots[i])) ok = 0; // Reads the whole block
+            break;
+        }
+    }
+    return ok;
+}
+
+size_t lazyStudentsPending(void) {
+    return lazy.open ? lazy.pending : 0;
+}
+
+void forgetLazyStudent(StudentNode* student) {
+    if (!lazy.open || student->lazySlot == 0) return;
+    lazy.slots[student->lazySlot - 1] = NULL;
+    student->lazySlot = 0;
+    if (--lazy.pending == 0) closeLazyBlockStore();
+}
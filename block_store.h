@@ -0,0 +1,118 @@
+#ifndef BLOCK_STORE_H
+#define BLOCK_STORE_H
+
+#include "student_tracker.h"
+#include "snapshot.h"
+
+// --- Compressed Block File ---
+//
+// A save file for reading part of the data without parsing all of it:
+//
+//   magic          BLOCK_STORE_MAGIC
+//   blocks         (each a snapshot image compressed with lz_codec.h)
+//   roster         (every student's "SRN\0name\0" in SRN order, compressed)
+//   index          (blockCount x BlockEntry, 8-byte aligned)
+//   footer         (BlockFooter, the last bytes of the file)
+//
+// Block 0 holds every teacher. The remaining blocks hold up to
+// BLOCK_TARGET_STUDENTS students each, in SRN order, and the index keeps the
+// first SRN of each one. One student is read by a binary search of the
+// index and decompressing the single block that owns its SRN; a full load
+// decompresses the blocks on several threads.
+
+#define BLOCK_STORE_MAGIC "STRKBLKS"
+#define BLOCK_STORE_VERSION 2        // v2 adds the roster; v1 files still load
+#define BLOCK_DATA_START 8
+#define BLOCK_TARGET_STUDENTS 32
+#define BLOCK_MAX_THREADS 64
+
+typedef enum {
+    BLOCK_STORED = 0,       // Kept as is (compression did not pay off)
+    BLOCK_LZ = 1
+} BlockCodec;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t size;              // Bytes in the file
+    uint32_t rawSize;           // Bytes of the snapshot image
+    uint32_t codec;             // BlockCodec
+    uint32_t studentCount;
+    uint32_t checksum;          // CRC of the bytes in the file
+    char firstSRN[20];          // Lowest SRN in the block ("" for the teacher block)
+} BlockEntry;
+
+// A v1 footer is this without the fields before indexOffset.
+typedef struct {
+    uint64_t rosterOffset;
+    uint32_t rosterSize;        // Bytes in the file
+    uint32_t rosterRawSize;
+    uint32_t rosterCodec;       // BlockCodec
+    uint32_t rosterChecksum;    // CRC of the bytes in the file
+    uint32_t studentCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint32_t blockCount;
+    uint32_t indexChecksum;
+    uint64_t journalSequence;   // Last journal entry included (see journal.h)
+    uint64_t fileSize;
+    uint32_t version;
+    uint32_t byteOrderMark;     // SNAPSHOT_BYTE_ORDER_MARK
+    char magic[8];              // BLOCK_STORE_MAGIC again, so a truncated file is caught
+} BlockFooter;
+
+// An open file for reading single students.
+typedef struct {
+    MappedFile file;
+    const BlockEntry* entries;  // Inside the mapping
+    BlockFooter footer;         // v1 footers are read with the roster fields zeroed
+    size_t footerSize;
+} BlockStore;
+
+/* --- File I/O --- */
+int isBlockStoreFile(const char* path);
+int saveBlockStore(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot);
+// Verifies every block before adding anything, so a bad file leaves the
+// trees untouched.
+int loadBlockStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+// Threads loadBlockStore decompresses with (0, the default, means one per CPU).
+void setBlockStoreThreads(int threads);
+
+/* --- Single Students --- */
+// Maps the file and checks its footer and index. Returns 0 if the file is
+// missing or malformed.
+int openBlockStore(const char* path, BlockStore* store);
+void closeBlockStore(BlockStore* store);
+
+// Builds the student with 'srn' from its block, detached from the tree (free
+// it with freeStudent). Sets *student to NULL if the SRN is not in the file.
+// Returns 0 if the block is corrupt or memory runs out.
+int readBlockStudent(const BlockStore* store, const char* srn, StudentNode** student);
+
+/* --- Lazy Loading --- */
+// Startup reads only the roster: every student gets a node (so lookups,
+// listings and name searches work) but no history. The file stays mapped,
+// and the first operation that needs a student's history faults in the
+// whole block it lives in. The mapping outlives the file being replaced by a
+// later save. v1 files, which have no roster, are loaded in full.
+int openLazyBlockStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+// Reads the student's history if it is still in the file. Returns 1 once it
+// is in memory, 0 (with a message) if its block is corrupt or memory runs out.
+int faultInHistory(StudentNode* student);
+
+// Reads every history still in the file, then lets go of it. Needed before
+// anything class-wide: class attendance, class statistics, cohort reports
+// and saves.
+int faultInAllHistories(void);
+
+// Students whose history is still in the file.
+size_t lazyStudentsPending(void);
+
+// Called by freeStudent for a node that may still be waiting.
+void forgetLazyStudent(StudentNode* student);
+
+// Drops the mapping and every pending slot (releaseAllData).
+void closeLazyBlockStore(void);
+
+#endif // BLOCK_STORE_H
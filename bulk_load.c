@@ -0,0 +1,793 @@
+#include "bulk_load.h"
+#include "cohort_report.h"
+#include "snapshot.h"
+#include "tree_cursor.h"
+#include <limits.h>
+#include <pthread.h>
+
+#define BULK_LOAD_WINDOW 32   // Chunks parsed ahead of the one being built
+
+static int bulkThreads = 0;
+
+void setBulkLoadThreads(int threads) {
+    bulkThreads = threads;
+}
+
+// --- Student Batches ---
+
+static int studentBatchReserve(StudentBatch* batch, size_t needed) {
+    if (needed <= batch->capacity) return 1;
+    size_t capacity = batch->capacity ? batch->capacity : 1024;
+    while (capacity < needed) capacity *= 2;
+    StudentNode** grown = (StudentNode**)realloc(batch->students, capacity * sizeof(StudentNode*));
+    if (grown == NULL) return 0;
+    batch->students = grown;
+    batch->capacity = capacity;
+    return 1;
+}
+
+int studentBatchAdd(StudentBatch* batch, StudentNode* student) {
+    if (!studentBatchReserve(batch, batch->count + 1)) return 0;
+    batch->students[batch->count++] = student;
+    return 1;
+}
+
+// Arrival order breaks ties, so the first of two duplicate SRNs survives.
+typedef struct {
+    StudentNode* student;
+    size_t order;
+} SortEntry;
+
+static int compareSortEntries(const void* a, const void* b) {
+    const SortEntry* left = (const SortEntry*)a;
+    const SortEntry* right = (const SortEntry*)b;
+    int compare = strcmp(left->student->studentSRN, right->student->studentSRN);
+    if (compare != 0) return compare;
+    return (left->order > right->order) - (left->order < right->order);
+}
+
+static int sortStudents(StudentNode** students, size_t count) {
+    SortEntry* entries = (SortEntry*)malloc(count * sizeof(SortEntry));
+    if (entries == NULL) return 0;
+    for (size_t i = 0; i < count; i++) {
+        entries[i].student = students[i];
+        entries[i].order = i;
+    }
+    qsort(entries, count, sizeof(SortEntry), compareSortEntries);
+    for (size_t i = 0; i < count; i++) students[i] = entries[i].student;
+    free(entries);
+    return 1;
+}
+
+int finishStudentBatch(StudentBatch* batch, StudentNode** studentRoot) {
+    size_t existing = countStudentTree(*studentRoot);
+    if (existing > 0) {
+        // Existing nodes go first so they win ties; the batch moves up behind them.
+        if (!studentBatchReserve(batch, batch->count + existing)) return 0;
+        memmove(batch->students + existing, batch->students, batch->count * sizeof(StudentNode*));
+        flattenStudentTree(*studentRoot, batch->students);
+        batch->count += existing;
+    }
+
+    StudentNode** students = batch->students;
+    size_t count = batch->count;
+    int sorted = 1;
+    for (size_t i = 1; i < count && sorted; i++) {
+        sorted = strcmp(students[i - 1]->studentSRN, students[i]->studentSRN) < 0;
+    }
+    if (!sorted && !sortStudents(students, count)) {
+        if (existing > 0) {
+            memmove(students, students + existing, (count - existing) * sizeof(StudentNode*));
+            batch->count -= existing;
+        }
+        return 0;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (kept > 0 && strcmp(students[kept - 1]->studentSRN, students[i]->studentSRN) == 0) {
+            StudentNode* survivor = students[kept - 1];
+            StudentNode* duplicate = students[i];
+            printf("Error: Student SRN %s already exists.\n", duplicate->studentSRN);
+            moveHistory(duplicate, survivor);
+            freeStudent(duplicate);
+            continue;
+        }
+        students[kept++] = students[i];
+    }
+
+    *studentRoot = buildBalancedStudentTree(students, kept);
+    batch->count = 0;
+    free(batch->students);
+    batch->students = NULL;
+    batch->capacity = 0;
+    return 1;
+}
+
+void discardStudentBatch(StudentBatch* batch) {
+    for (size_t i = 0; i < batch->count; i++) freeStudent(batch->students[i]);
+    free(batch->students);
+    batch->students = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+// --- Buffered Line Reader ---
+
+typedef struct {
+    FILE* fp;
+    char* buffer;     // BULK_READ_BLOCK bytes plus a terminator
+    size_t start;     // First unconsumed byte
+    size_t end;       // One past the last byte read
+    int eof;
+    int skipToNewline; // Dropping the tail of an over-long line
+} LineReader;
+
+// Returns the next line with its terminator removed, or NULL at end of file.
+// The line stays valid until the next call.
+static char* nextLine(LineReader* reader) {
+    for (;;) {
+        char* begin = reader->buffer + reader->start;
+        size_t pending = reader->end - reader->start;
+        char* newline = (char*)memchr(begin, '\n', pending);
+
+        if (reader->skipToNewline) {
+            if (newline != NULL) {
+                reader->start += (size_t)(newline - begin) + 1;
+                reader->skipToNewline = 0;
+                continue;
+            } else {
+                reader->start = reader->end;
+                if (reader->eof) return NULL;
+            }
+        } else if (newline != NULL) {
+            *newline = '\0';
+            if (newline > begin && newline[-1] == '\r') newline[-1] = '\0';
+            reader->start += (size_t)(newline - begin) + 1;
+            return begin;
+        } else if (reader->eof) {
+            if (pending == 0) return NULL;
+            begin[pending] = '\0'; // Last line has no newline
+            reader->start = reader->end;
+            return begin;
+        } else if (pending == BULK_READ_BLOCK) {
+            // No newline in a whole block: return it truncated, drop the rest.
+            begin[pending] = '\0';
+            reader->start = reader->end;
+            reader->skipToNewline = 1;
+            return begin;
+        }
+
+        // Slide the partial line to the front and refill behind it.
+        pending = reader->end - reader->start;
+        memmove(reader->buffer, reader->buffer + reader->start, pending);
+        reader->start = 0;
+        reader->end = pending;
+        size_t got = fread(reader->buffer + pending, 1, BULK_READ_BLOCK - pending, reader->fp);
+        reader->end += got;
+        if (got == 0) reader->eof = 1;
+    }
+}
+
+// Copies the next line into a fixed-size field, truncating if needed.
+// Returns 0 at end of file.
+static int readField(LineReader* reader, char* dest, size_t size) {
+    char* line = nextLine(reader);
+    if (line == NULL) {
+        dest[0] = '\0';
+        return 0;
+    }
+    size_t length = strlen(line);
+    if (length >= size) length = size - 1;
+    memcpy(dest, line, length);
+    dest[length] = '\0';
+    return 1;
+}
+
+static int readInt(LineReader* reader, int* value) {
+    char* line = nextLine(reader);
+    if (line == NULL) return 0;
+    int negative = (*line == '-');
+    if (negative) line++;
+    long long result = 0;
+    while (*line >= '0' && *line <= '9') {
+        result = result * 10 + (*line++ - '0');
+        if (result > INT_MAX) result = INT_MAX;
+    }
+    *value = (int)(negative ? -result : result);
+    return 1;
+}
+
+// --- Text Loader ---
+
+static int serialLoadTextFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) return 0;
+
+    LineReader reader = { fp, (char*)malloc(BULK_READ_BLOCK + 1), 0, 0, 0, 0 };
+    if (reader.buffer == NULL) {
+        fclose(fp);
+        return 0;
+    }
+
+    char nameBuffer[100], idBuffer[20], pwBuffer[50], subjectBuffer[50], descBuffer[50];
+    StudentBatch batch = { NULL, 0, 0 };
+    StudentNode* lastStudent = NULL;
+    int ok = 1;
+    char* keyword;
+
+    while (ok && (keyword = nextLine(&reader)) != NULL && strcmp(keyword, "END_OF_FILE") != 0) {
+        if (strcmp(keyword, "RECORD") == 0) {
+            int type = 0, value = 0;
+            readInt(&reader, &type);
+            readInt(&reader, &value);
+            readField(&reader, subjectBuffer, sizeof(subjectBuffer));
+            readField(&reader, descBuffer, sizeof(descBuffer));
+            if (lastStudent == NULL) continue;
+
+            // Appended at the tail so the history keeps its file order.
+            SymbolId subject = internSymbol(subjectBuffer);
+            SymbolId description = internSymbol(descBuffer);
+            if (subject == SYMBOL_INVALID || description == SYMBOL_INVALID ||
+                !appendPerformanceRecord(lastStudent, (RecordType)type, value, subject, description)) {
+                ok = 0;
+                break;
+            }
+
+        } else if (strcmp(keyword, "STUDENT") == 0) {
+            readField(&reader, idBuffer, sizeof(idBuffer));
+            readField(&reader, nameBuffer, sizeof(nameBuffer));
+            lastStudent = createStudent(idBuffer, nameBuffer);
+            if (lastStudent == NULL || !studentBatchAdd(&batch, lastStudent)) {
+                freeStudent(lastStudent);
+                ok = 0;
+                break;
+            }
+
+        } else if (strcmp(keyword, "TEACHER") == 0) {
+            readField(&reader, idBuffer, sizeof(idBuffer));
+            readField(&reader, nameBuffer, sizeof(nameBuffer));
+            readField(&reader, pwBuffer, sizeof(pwBuffer));
+            readField(&reader, subjectBuffer, sizeof(subjectBuffer));
+            *teacherRoot = addTeacher(*teacherRoot, idBuffer, nameBuffer, pwBuffer, subjectBuffer);
+
+        } else if (strcmp(keyword, "SEQUENCE") == 0) {
+            char* line = nextLine(&reader);
+            if (line != NULL) setDataSequence(strtoull(line, NULL, 10));
+        }
+    }
+
+    free(reader.buffer);
+    fclose(fp);
+
+    if (!ok || !finishStudentBatch(&batch, studentRoot)) {
+        printf("Error: Out of memory while loading %s.\n", path);
+        discardStudentBatch(&batch);
+        return 0;
+    }
+    return 1;
+}
+
+// --- Parallel Text Loader ---
+//
+// The file is mapped and cut into chunks of about BULK_CHUNK_BYTES, each
+// starting at a STUDENT line. Workers parse chunks ahead into ParsedChunk
+// arenas: the keywords and their fields, the chunk's distinct record
+// strings (all pointing into the mapping) and its distinct attendance
+// sessions, which every attendance record refers to by index. The loading
+// thread builds each chunk's teachers, students and records in file order,
+// since creating nodes, interning and storing records are not thread-safe,
+// but it looks each session up once per chunk rather than once per record:
+// finding sessions was most of the time it spent on a typical class.
+//
+// A cut is only a guess: a name or description could read "STUDENT". So a
+// chunk parses on past its end until a keyword starts at or after the next
+// cut, and the next chunk is used only if it began exactly there. If not, it
+// is parsed again from where the previous one stopped.
+
+typedef enum { PARSED_RECORD, PARSED_STUDENT, PARSED_TEACHER, PARSED_SEQUENCE, PARSED_END } ParsedKind;
+
+typedef struct {
+    const char* text;         // Inside the mapping, not terminated
+    uint32_t length;
+} ParsedText;
+
+// One keyword. A record's subject and description index the chunk's
+// distinct strings, and an attendance record's (subject, date) also its
+// distinct sessions; a student, teacher or sequence keeps its fields in the
+// chunk's 'fields', from 'subject' on.
+typedef struct {
+    uint8_t kind;             // ParsedKind
+    int32_t type;
+    int32_t value;
+    uint32_t subject;
+    uint32_t description;
+    uint32_t session;
+} ParsedItem;
+
+typedef struct {
+    size_t from;              // Where parsing started
+    size_t stop;              // The keyword it stopped at (or the end of the file)
+    ParsedItem* items;
+    size_t itemCount, itemCapacity;
+    ParsedText* fields;
+    size_t fieldCount, fieldCapacity;
+    ParsedText* strings;
+    size_t stringCount, stringCapacity;
+    uint32_t* slots;          // Hash of 'strings': index + 1, 0 = empty
+    size_t slotCapacity;
+    uint64_t* sessions;       // Subject string << 32 | date string
+    size_t sessionCount, sessionCapacity;
+    uint32_t* sessionSlots;   // Hash of 'sessions', like 'slots'
+    size_t sessionSlotCapacity;
+    int failed;               // Out of memory
+} ParsedChunk;
+
+static int growArray(void** array, size_t* capacity, size_t needed, size_t size) {
+    if (needed <= *capacity) return 1;
+    size_t newCapacity = *capacity ? *capacity * 2 : 256;
+    while (newCapacity < needed) newCapacity *= 2;
+    void* grown = realloc(*array, newCapacity * size);
+    if (grown == NULL) return 0;
+    *array = grown;
+    *capacity = newCapacity;
+    return 1;
+}
+
+static void freeParsedChunk(ParsedChunk* chunk) {
+    if (chunk == NULL) return;
+    free(chunk->items);
+    free(chunk->fields);
+    free(chunk->strings);
+    free(chunk->slots);
+    free(chunk->sessions);
+    free(chunk->sessionSlots);
+    free(chunk);
+}
+
+// Reads lines straight from the mapping, the way nextLine does: without the
+// terminator (and a '\r' before it), cut at a '\0'. At the end of the file
+// it returns 0 and an empty line, which reads like the empty field
+// readField gives there.
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t pos;
+} TextScan;
+
+static int scanLine(TextScan* scan, ParsedText* line) {
+    line->text = scan->data + scan->pos;
+    line->length = 0;
+    if (scan->pos >= scan->size) return 0;
+    size_t pending = scan->size - scan->pos;
+    const char* newline = (const char*)memchr(line->text, '\n', pending);
+    size_t length = newline ? (size_t)(newline - line->text) : pending;
+    scan->pos += length + (newline != NULL);
+    if (newline != NULL && length > 0 && line->text[length - 1] == '\r') length--;
+    const char* nul = (const char*)memchr(line->text, '\0', length);
+    if (nul != NULL) length = (size_t)(nul - line->text);
+    line->length = length < UINT32_MAX ? (uint32_t)length : UINT32_MAX;
+    return 1;
+}
+
+// The next line, truncated to fit a buffer of 'size' like readField does.
+static ParsedText scanField(TextScan* scan, size_t size) {
+    ParsedText field;
+    scanLine(scan, &field);
+    if (field.length >= size) field.length = (uint32_t)(size - 1);
+    return field;
+}
+
+static int scanInt(TextScan* scan) {
+    ParsedText line;
+    scanLine(scan, &line);
+    const char* at = line.text;
+    const char* end = at + line.length;
+    int negative = (at < end && *at == '-');
+    if (negative) at++;
+    long long result = 0;
+    while (at < end && *at >= '0' && *at <= '9') {
+        result = result * 10 + (*at++ - '0');
+        if (result > INT_MAX) result = INT_MAX;
+    }
+    return (int)(negative ? -result : result);
+}
+
+static int isKeyword(const ParsedText* line, const char* keyword) {
+    size_t length = strlen(keyword);
+    return line->length == length && memcmp(line->text, keyword, length) == 0;
+}
+
+static uint32_t hashText(const ParsedText* text) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < text->length; i++) hash = (hash ^ (unsigned char)text->text[i]) * 16777619u;
+    return hash;
+}
+
+// The chunk's index for a record string, adding it on first use.
+static uint32_t chunkString(ParsedChunk* chunk, ParsedText text) {
+    if (chunk->stringCount * 2 >= chunk->slotCapacity) {
+        size_t capacity = chunk->slotCapacity ? chunk->slotCapacity * 2 : 64;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        if (slots == NULL) {
+            chunk->failed = 1;
+            return 0;
+        }
+        for (size_t i = 0; i < chunk->stringCount; i++) {
+            size_t slot = hashText(&chunk->strings[i]) & (capacity - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = (uint32_t)i + 1;
+        }
+        free(chunk->slots);
+        chunk->slots = slots;
+        chunk->slotCapacity = capacity;
+    }
+    size_t slot = hashText(&text) & (chunk->slotCapacity - 1);
+    for (; chunk->slots[slot] != 0; slot = (slot + 1) & (chunk->slotCapacity - 1)) {
+        const ParsedText* known = &chunk->strings[chunk->slots[slot] - 1];
+        if (known->length == text.length && memcmp(known->text, text.text, text.length) == 0) return chunk->slots[slot] - 1;
+    }
+    if (!growArray((void**)&chunk->strings, &chunk->stringCapacity, chunk->stringCount + 1, sizeof(ParsedText))) {
+        chunk->failed = 1;
+        return 0;
+    }
+    chunk->strings[chunk->stringCount] = text;
+    chunk->slots[slot] = (uint32_t)++chunk->stringCount;
+    return (uint32_t)chunk->stringCount - 1;
+}
+
+static uint32_t hashSession(uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// The chunk's index for the attendance session (subject, date), both
+// indexes of distinct strings, adding it on first use.
+static uint32_t chunkSession(ParsedChunk* chunk, uint32_t subject, uint32_t date) {
+    uint64_t key = (uint64_t)subject << 32 | date;
+    if (chunk->sessionCount * 2 >= chunk->sessionSlotCapacity) {
+        size_t capacity = chunk->sessionSlotCapacity ? chunk->sessionSlotCapacity * 2 : 64;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        if (slots == NULL) {
+            chunk->failed = 1;
+            return 0;
+        }
+        for (size_t i = 0; i < chunk->sessionCount; i++) {
+            size_t slot = hashSession(chunk->sessions[i]) & (capacity - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = (uint32_t)i + 1;
+        }
+        free(chunk->sessionSlots);
+        chunk->sessionSlots = slots;
+        chunk->sessionSlotCapacity = capacity;
+    }
+    size_t slot = hashSession(key) & (chunk->sessionSlotCapacity - 1);
+    for (; chunk->sessionSlots[slot] != 0; slot = (slot + 1) & (chunk->sessionSlotCapacity - 1)) {
+        if (chunk->sessions[chunk->sessionSlots[slot] - 1] == key) return chunk->sessionSlots[slot] - 1;
+    }
+    if (!growArray((void**)&chunk->sessions, &chunk->sessionCapacity, chunk->sessionCount + 1, sizeof(uint64_t))) {
+        chunk->failed = 1;
+        return 0;
+    }
+    chunk->sessions[chunk->sessionCount] = key;
+    chunk->sessionSlots[slot] = (uint32_t)++chunk->sessionCount;
+    return (uint32_t)chunk->sessionCount - 1;
+}
+
+static ParsedItem* addItem(ParsedChunk* chunk, ParsedKind kind) {
+    if (!growArray((void**)&chunk->items, &chunk->itemCapacity, chunk->itemCount + 1, sizeof(ParsedItem))) {
+        chunk->failed = 1;
+        return NULL;
+    }
+    ParsedItem* item = &chunk->items[chunk->itemCount++];
+    memset(item, 0, sizeof(*item));
+    item->kind = (uint8_t)kind;
+    item->subject = (uint32_t)chunk->fieldCount;
+    return item;
+}
+
+// Reads 'count' fields (truncated to 'sizes') into the chunk after 'item'.
+static void addFields(ParsedChunk* chunk, TextScan* scan, const size_t* sizes, int count) {
+    if (!growArray((void**)&chunk->fields, &chunk->fieldCapacity, chunk->fieldCount + (size_t)count, sizeof(ParsedText))) {
+        chunk->failed = 1;
+        return;
+    }
+    for (int i = 0; i < count; i++) chunk->fields[chunk->fieldCount++] = scanField(scan, sizes[i]);
+}
+
+// Parses keywords from 'from' until one starts at or after 'limit' (or the
+// file or END_OF_FILE ends them). Field sizes match serialLoadTextFile's buffers.
+static void parseChunk(const MappedFile* file, size_t from, size_t limit, ParsedChunk* chunk) {
+    static const size_t studentSizes[] = { 20, 100 };
+    static const size_t teacherSizes[] = { 20, 100, 50, 50 };
+    TextScan scan = { file->data, file->size, from };
+    ParsedText line;
+    chunk->from = from;
+    while (!chunk->failed && scan.pos < limit) {
+        size_t at = scan.pos;
+        if (!scanLine(&scan, &line)) break;
+        if (isKeyword(&line, "END_OF_FILE")) {
+            addItem(chunk, PARSED_END);
+            scan.pos = at;
+            break;
+        } else if (isKeyword(&line, "RECORD")) {
+            int type = scanInt(&scan);
+            int value = scanInt(&scan);
+            ParsedText subject = scanField(&scan, 50), description = scanField(&scan, 50);
+            ParsedItem* item = addItem(chunk, PARSED_RECORD);
+            if (item == NULL) break;
+            item->type = type;
+            item->value = value;
+            item->subject = chunkString(chunk, subject);
+            item->description = chunkString(chunk, description);
+            if (type == ATTENDANCE) item->session = chunkSession(chunk, item->subject, item->description);
+        } else if (isKeyword(&line, "STUDENT")) {
+            if (addItem(chunk, PARSED_STUDENT)) addFields(chunk, &scan, studentSizes, 2);
+        } else if (isKeyword(&line, "TEACHER")) {
+            if (addItem(chunk, PARSED_TEACHER)) addFields(chunk, &scan, teacherSizes, 4);
+        } else if (isKeyword(&line, "SEQUENCE")) {
+            size_t sequenceSize = 64;
+            TextScan peek = scan;
+            if (scanLine(&peek, &line) && addItem(chunk, PARSED_SEQUENCE)) addFields(chunk, &scan, &sequenceSize, 1);
+            else scan = peek; // Nothing follows: like the serial loader, no sequence
+        }
+    }
+    chunk->stop = scan.pos;
+}
+
+// The start of the first line reading "STUDENT" at or after 'offset', or the file size.
+static size_t nextStudentLine(const MappedFile* file, size_t offset) {
+    TextScan scan = { file->data, file->size, offset };
+    ParsedText line;
+    if (offset > 0 && file->data[offset - 1] != '\n') scanLine(&scan, &line); // Finish the line 'offset' is in
+    for (size_t at = scan.pos; scanLine(&scan, &line); at = scan.pos) {
+        if (isKeyword(&line, "STUDENT")) return at;
+    }
+    return file->size;
+}
+
+// --- Building Parsed Chunks ---
+
+typedef struct {
+    TeacherNode** teacherRoot;
+    StudentBatch* batch;
+    StudentNode* lastStudent;  // Records belong to it, across chunks
+    SymbolId* symbols;         // Per chunk string, SYMBOL_INVALID until a record uses it
+    size_t symbolCapacity;
+    AttendanceSession** sessions; // Per chunk session, NULL until a record uses it
+    size_t sessionCapacity;
+    int ended;                 // END_OF_FILE was reached
+} ChunkBuilder;
+
+static void copyText(char* dest, const ParsedText* text) {
+    memcpy(dest, text->text, text->length);
+    dest[text->length] = '\0';
+}
+
+static SymbolId chunkSymbol(ChunkBuilder* builder, const ParsedChunk* chunk, uint32_t index) {
+    if (builder->symbols[index] == SYMBOL_INVALID) {
+        char text[50];
+        copyText(text, &chunk->strings[index]);
+        builder->symbols[index] = internSymbol(text);
+    }
+    return builder->symbols[index];
+}
+
+// Adds a chunk's keywords in file order, as serialLoadTextFile would. Returns 0 if memory runs out.
+static int buildChunk(ChunkBuilder* builder, const ParsedChunk* chunk) {
+    if (!growArray((void**)&builder->symbols, &builder->symbolCapacity, chunk->stringCount, sizeof(SymbolId))) return 0;
+    for (size_t i = 0; i < chunk->stringCount; i++) builder->symbols[i] = SYMBOL_INVALID;
+    if (!growArray((void**)&builder->sessions, &builder->sessionCapacity, chunk->sessionCount, sizeof(AttendanceSession*))) return 0;
+    for (size_t i = 0; i < chunk->sessionCount; i++) builder->sessions[i] = NULL;
+    char nameBuffer[100], idBuffer[20], pwBuffer[50], subjectBuffer[50], sequenceBuffer[64];
+    for (size_t i = 0; i < chunk->itemCount; i++) {
+        const ParsedItem* item = &chunk->items[i];
+        const ParsedText* fields = chunk->fields + item->subject;
+        if (item->kind == PARSED_RECORD) {
+            if (builder->lastStudent == NULL) continue;
+            if (item->type == ATTENDANCE) {
+                // Interned on the session's first use, which is each string's first use too.
+                AttendanceSession** session = &builder->sessions[item->session];
+                if (*session == NULL) {
+                    SymbolId subject = chunkSymbol(builder, chunk, item->subject);
+                    SymbolId date = chunkSymbol(builder, chunk, item->description);
+                    if (subject == SYMBOL_INVALID || date == SYMBOL_INVALID) return 0;
+                    *session = attendanceSessionFor(subject, date);
+                    if (*session == NULL) return 0;
+                }
+                if (!setSessionAttendance(*session, builder->lastStudent->ordinal, item->value == 1)) return 0;
+                continue;
+            }
+            SymbolId subject = chunkSymbol(builder, chunk, item->subject);
+            SymbolId description = chunkSymbol(builder, chunk, item->description);
+            if (subject == SYMBOL_INVALID || description == SYMBOL_INVALID ||
+                !appendPerformanceRecord(builder->lastStudent, (RecordType)item->type, item->value, subject, description)) {
+                return 0;
+            }
+        } else if (item->kind == PARSED_STUDENT) {
+            copyText(idBuffer, &fields[0]);
+            copyText(nameBuffer, &fields[1]);
+            builder->lastStudent = createStudent(idBuffer, nameBuffer);
+            if (builder->lastStudent == NULL || !studentBatchAdd(builder->batch, builder->lastStudent)) {
+                freeStudent(builder->lastStudent);
+                builder->lastStudent = NULL;
+                return 0;
+            }
+        } else if (item->kind == PARSED_TEACHER) {
+            copyText(idBuffer, &fields[0]);
+            copyText(nameBuffer, &fields[1]);
+            copyText(pwBuffer, &fields[2]);
+            copyText(subjectBuffer, &fields[3]);
+            *builder->teacherRoot = addTeacher(*builder->teacherRoot, idBuffer, nameBuffer, pwBuffer, subjectBuffer);
+        } else if (item->kind == PARSED_SEQUENCE) {
+            copyText(sequenceBuffer, &fields[0]);
+            setDataSequence(strtoull(sequenceBuffer, NULL, 10));
+        } else {
+            builder->ended = 1;
+            return 1;
+        }
+    }
+    return 1;
+}
+
+// --- Parse Workers ---
+//
+// The same scheme as the block store's loader: workers claim chunks in
+// order and stay at most BULK_LOAD_WINDOW ahead of the loading thread, which
+// parses a chunk itself rather than wait for one nobody has claimed.
+
+typedef enum { CHUNK_PENDING, CHUNK_READY } ChunkState;
+
+typedef struct {
+    const MappedFile* file;
+    size_t* starts;           // chunkCount + 1 cuts, the last at the end of the file
+    ParsedChunk** chunks;     // NULL once built, or if a chunk could not be allocated
+    unsigned char* states;    // ChunkState per chunk
+    uint32_t chunkCount;
+    uint32_t next;            // Next chunk to claim
+    uint32_t built;           // Chunks the loading thread is done with
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} TextLoadJob;
+
+static ParsedChunk* parseChunkAt(const TextLoadJob* job, size_t from, uint32_t index) {
+    ParsedChunk* chunk = (ParsedChunk*)calloc(1, sizeof(ParsedChunk));
+    if (chunk != NULL) parseChunk(job->file, from, job->starts[index + 1], chunk);
+    return chunk;
+}
+
+static void finishChunk(TextLoadJob* job, uint32_t index, ParsedChunk* chunk) {
+    pthread_mutex_lock(&job->lock);
+    job->chunks[index] = chunk;
+    job->states[index] = CHUNK_READY;
+    pthread_cond_broadcast(&job->changed);
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void* textWorker(void* arg) {
+    TextLoadJob* job = (TextLoadJob*)arg;
+    pthread_mutex_lock(&job->lock);
+    while (!job->stop && job->next < job->chunkCount) {
+        if (job->next >= job->built + BULK_LOAD_WINDOW) {
+            pthread_cond_wait(&job->changed, &job->lock);
+            continue;
+        }
+        uint32_t index = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        finishChunk(job, index, parseChunkAt(job, job->starts[index], index));
+        pthread_mutex_lock(&job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+// Waits for chunk 'index', parsing it here if no worker has claimed it.
+static ParsedChunk* awaitChunk(TextLoadJob* job, uint32_t index) {
+    pthread_mutex_lock(&job->lock);
+    if (job->next == index) {
+        job->next++;
+        pthread_mutex_unlock(&job->lock);
+        finishChunk(job, index, parseChunkAt(job, job->starts[index], index));
+        pthread_mutex_lock(&job->lock);
+    }
+    while (job->states[index] == CHUNK_PENDING) pthread_cond_wait(&job->changed, &job->lock);
+    ParsedChunk* chunk = job->chunks[index];
+    job->chunks[index] = NULL;
+    pthread_mutex_unlock(&job->lock);
+    return chunk;
+}
+
+// Cuts the file at STUDENT lines about BULK_CHUNK_BYTES apart. Returns the
+// number of chunks, 0 if memory runs out.
+static uint32_t cutChunks(const MappedFile* file, size_t** starts) {
+    size_t maxChunks = file->size / BULK_CHUNK_BYTES + 1;
+    *starts = (size_t*)malloc((maxChunks + 1) * sizeof(size_t));
+    if (*starts == NULL) return 0;
+    uint32_t count = 0;
+    (*starts)[count++] = 0;
+    for (size_t k = 1; k < maxChunks; k++) {
+        size_t start = nextStudentLine(file, k * BULK_CHUNK_BYTES);
+        if (start >= file->size) break;
+        if (start > (*starts)[count - 1]) (*starts)[count++] = start;
+    }
+    (*starts)[count] = file->size;
+    return count;
+}
+
+static int parallelLoadTextFile(const MappedFile* file, int threads, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    TextLoadJob job;
+    memset(&job, 0, sizeof(job));
+    job.file = file;
+    job.chunkCount = cutChunks(file, &job.starts);
+    job.chunks = (ParsedChunk**)calloc(job.chunkCount ? job.chunkCount : 1, sizeof(ParsedChunk*));
+    job.states = (unsigned char*)calloc(job.chunkCount ? job.chunkCount : 1, 1);
+    if (job.chunkCount == 0 || job.chunks == NULL || job.states == NULL) {
+        free(job.starts);
+        free(job.chunks);
+        free(job.states);
+        return 0;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.changed, NULL);
+    if ((uint32_t)threads > job.chunkCount) threads = (int)job.chunkCount;
+    pthread_t ids[BULK_MAX_THREADS];
+    int running = 0;
+    for (int t = 1; t < threads; t++) { // The loading thread parses too when it would wait
+        if (pthread_create(&ids[running], NULL, textWorker, &job) == 0) running++;
+    }
+
+    StudentBatch batch = { NULL, 0, 0 };
+    ChunkBuilder builder = { teacherRoot, &batch, NULL, NULL, 0, NULL, 0, 0 };
+    size_t expected = 0; // Where the last chunk stopped, so where the next must begin
+    int ok = 1;
+    for (uint32_t i = 0; i < job.chunkCount && ok && !builder.ended; i++) {
+        ParsedChunk* chunk = awaitChunk(&job, i);
+        if (chunk != NULL && chunk->from != expected) {
+            freeParsedChunk(chunk); // Cut inside an entry
+            chunk = parseChunkAt(&job, expected, i);
+        }
+        ok = chunk != NULL && !chunk->failed && buildChunk(&builder, chunk);
+        if (chunk != NULL) expected = chunk->stop;
+        freeParsedChunk(chunk);
+        pthread_mutex_lock(&job.lock);
+        job.built = i + 1;
+        if (!ok) job.stop = 1;
+        pthread_cond_broadcast(&job.changed);
+        pthread_mutex_unlock(&job.lock);
+    }
+    pthread_mutex_lock(&job.lock);
+    job.stop = 1;
+    pthread_cond_broadcast(&job.changed);
+    pthread_mutex_unlock(&job.lock);
+    for (int t = 0; t < running; t++) pthread_join(ids[t], NULL);
+
+    for (uint32_t i = 0; i < job.chunkCount; i++) freeParsedChunk(job.chunks[i]);
+    free(builder.symbols);
+    free(builder.sessions);
+    free(job.starts);
+    free(job.chunks);
+    free(job.states);
+    pthread_cond_destroy(&job.changed);
+    pthread_mutex_destroy(&job.lock);
+
+    if (!ok || !finishStudentBatch(&batch, studentRoot)) {
+        discardStudentBatch(&batch);
+        return 0;
+    }
+    return 1;
+}
+
+int bulkLoadTextFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    int threads = bulkThreads > 0 ? bulkThreads : cohortDefaultThreads();
+    if (threads > BULK_MAX_THREADS) threads = BULK_MAX_THREADS;
+    MappedFile file;
+    if (threads < 2 || !mapDataFile(path, &file)) return serialLoadTextFile(path, teacherRoot, studentRoot);
+    if (file.size <= 2 * (size_t)BULK_CHUNK_BYTES) {
+        unmapDataFile(&file);
+        return serialLoadTextFile(path, teacherRoot, studentRoot);
+    }
+    int ok = parallelLoadTextFile(&file, threads, teacherRoot, studentRoot);
+    unmapDataFile(&file);
+    if (!ok) printf("Error: Out of memory while loading %s.\n", path);
+    return ok;
+}
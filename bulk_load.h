@@ -0,0 +1,45 @@
+#ifndef BULK_LOAD_H
+#define BULK_LOAD_H
+
+#include "student_tracker.h"
+
+// --- Bulk Loading ---
+//
+// Loaders collect freshly created, detached student nodes into a
+// StudentBatch instead of inserting them one by one. finishStudentBatch then
+// builds a perfectly balanced index in O(n) from the sorted keys (every save
+// format writes students in SRN order; anything else is sorted first).
+
+#define BULK_READ_BLOCK (1 << 20) // Bytes read from a text file per fread
+#define BULK_CHUNK_BYTES (1 << 20) // Text parsed per chunk by the parallel loader
+#define BULK_MAX_THREADS 64
+
+typedef struct {
+    StudentNode** students;
+    size_t count;
+    size_t capacity;
+} StudentBatch;
+
+// Appends a detached node. Returns 0 if the batch could not grow.
+int studentBatchAdd(StudentBatch* batch, StudentNode* student);
+
+// Merges the batch into *studentRoot and rebuilds it balanced. A duplicate
+// SRN keeps the node that came first (existing tree nodes before batch nodes)
+// and moves the duplicate's history onto it. The batch is emptied.
+// Returns 0 on allocation failure, leaving the tree untouched.
+int finishStudentBatch(StudentBatch* batch, StudentNode** studentRoot);
+
+// Frees every node still in the batch, along with its history.
+void discardStudentBatch(StudentBatch* batch);
+
+// Parses a text-format save file with a buffered tokenizer. Returns 1 on
+// success, 0 if the file cannot be opened or memory runs out. Files of more
+// than two chunks are parsed on several threads (see bulk_load.c) with the
+// same result.
+int bulkLoadTextFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+// Threads bulkLoadTextFile parses with (0, the default, means one per CPU;
+// 1 keeps the single-threaded tokenizer).
+void setBulkLoadThreads(int threads);
+
+#endif // BULK_LOAD_H
@@ -0,0 +1,17 @@
+#include "checksum.h"
+
+static uint32_t crcTable[256];
+
+uint32_t crc32Checksum(const void* data, size_t length) {
+    if (crcTable[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crcTable[i] = c;
+        }
+    }
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) crc = crcTable[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
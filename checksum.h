@@ -0,0 +1,10 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3), used to detect torn or corrupted on-disk data.
+uint32_t crc32Checksum(const void* data, size_t length);
+
+#endif // CHECKSUM_H
@@ -0,0 +1,332 @@
+#include "client.h"
+#include "batch.h"
+#include "text_buffer.h"
+
+#ifdef _WIN32
+
+int runClient(const char* socketPath) {
+    (void)socketPath;
+    printf("Error: Client mode needs Unix domain sockets.\n");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef struct {
+    int fd;
+    TextBuffer reply;
+    char teacherName[100];
+    char subject[50];
+} Connection;
+
+// --- Requests ---
+
+// Sends one command and reads its reply (up to the NUL). Returns 0 if the
+// server went away.
+static int request(Connection* connection, const char* command) {
+    size_t length = strlen(command);
+    char line[BATCH_LINE_SIZE + 1];
+    textReset(&connection->reply);
+    if (length >= BATCH_LINE_SIZE) {
+        textPrintf(&connection->reply, "Error: What was entered is too long.\n");
+        return 1;
+    }
+    memcpy(line, command, length);
+    line[length] = '\n';
+    for (size_t sent = 0; sent <= length;) {
+        ssize_t n = send(connection->fd, line + sent, length + 1 - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        sent += (size_t)n;
+    }
+
+    char buffer[4096];
+    while (1) {
+        ssize_t got = recv(connection->fd, buffer, sizeof(buffer), 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return 0;
+        char* end = (char*)memchr(buffer, '\0', (size_t)got);
+        textAppend(&connection->reply, buffer, end ? (size_t)(end - buffer) : (size_t)got);
+        if (end != NULL) return 1; // One command in flight, so nothing follows the NUL
+    }
+}
+
+// Runs a command and prints its reply. 'done' is printed when the command
+// succeeds without saying anything. Returns 0 if the server went away.
+static int run(Connection* connection, const char* command, const char* done) {
+    if (!request(connection, command)) return 0;
+    textWrite(&connection->reply, stdout);
+    if (connection->reply.size == 0 && done != NULL) printf("%s\n", done);
+    return 1;
+}
+
+// --- Input ---
+
+static void readLine(const char* prompt, char* buffer, int size) {
+    printf("%s", prompt);
+    if (fgets(buffer, size, stdin) == NULL) buffer[0] = '\0';
+    buffer[strcspn(buffer, "\n")] = 0;
+}
+
+// Reads a field of a command; '|' would split it, so it is refused.
+static int readField(const char* prompt, char* buffer, int size) {
+    readLine(prompt, buffer, size);
+    if (strchr(buffer, '|') != NULL) {
+        printf("Error: '|' cannot be used here.\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int readChoice(void) {
+    char buffer[32];
+    if (fgets(buffer, sizeof(buffer), stdin) == NULL) return -1;
+    return atoi(buffer);
+}
+
+// --- Menus ---
+
+static void displayClientMenu(Connection* connection) {
+    printf("\n==============================================\n");
+    printf("   Student Performance Tracker (connected)\n");
+    printf("==============================================\n");
+    printf("--- Student Management ---\n");
+    printf(" 1. Add New Student\n");
+    printf(" 2. List All Students (Sorted by SRN)\n");
+    printf("18. Search Students by Name\n");
+    printf("\n--- Data Modification ---\n");
+    printf(" 5. Modify Student SRN\n");
+    printf(" 6. Modify an Existing Mark\n");
+    printf("20. Re-key SRNs in Bulk (mapping file or prefix)\n");
+    printf("\n--- Data Entry (Subject: %s) ---\n", connection->subject);
+    printf(" 7. Take Class Attendance\n");
+    printf(" 8. Log Internal 1 Mark (20)\n");
+    printf(" 9. Log Assignment 1 Mark (5)\n");
+    printf("10. Log Internal 2 Mark (20)\n");
+    printf("11. Log Assignment 2 Mark (5)\n");
+    printf("12. Log Semester Exam Mark (100)\n");
+    printf("\n--- Reporting ---\n");
+    printf("13. Generate Subject Marks Report\n");
+    printf("14. Generate Full Master Report\n");
+    printf("16. Class Statistics Report\n");
+    printf("17. Generate Cohort Reports (on the server)\n");
+    printf("19. Show Server Operation Statistics\n");
+    printf("15. Logout\n");
+    printf("==============================================\n");
+    printf("Logged in as: %s | Enter your choice: ", connection->teacherName);
+}
+
+static const char* componentCode(int choice) {
+    static const char* codes[] = { "I1", "A1", "I2", "A2", "SEM" };
+    return (choice >= 1 && choice <= 5) ? codes[choice - 1] : NULL;
+}
+
+// One pass of the main menu. Returns 0 to log out, -1 if the server went away.
+static int mainMenu(Connection* connection) {
+    // 'command' holds the longest one ("rollcall|", 'extra', '|', 'text') uncut,
+    // so request() sees and refuses it instead of sending a truncated line.
+    char srn[20], text[BATCH_LINE_SIZE], extra[100], command[BATCH_LINE_SIZE + 128];
+    displayClientMenu(connection);
+    int choice = readChoice();
+    if (choice < 0) return -1;
+
+    int alive = 1;
+    switch (choice) {
+        case 1:
+            printf("\n--- Add New Student ---\n");
+            if (!readField("Enter Student SRN: ", srn, sizeof(srn))) break;
+            if (!readField("Enter Student Name: ", extra, sizeof(extra))) break;
+            snprintf(command, sizeof(command), "add|%s|%s", srn, extra);
+            alive = run(connection, command, "Student added.");
+            break;
+
+        case 2:
+            printf("\n--- All Students (Sorted by SRN) ---\n");
+            alive = run(connection, "list", NULL);
+            if (alive && connection->reply.size == 0) printf("No students in the system.\n");
+            break;
+
+        case 18:
+            printf("\n--- Search Students by Name ---\n");
+            if (!readField("Enter the name or part of it: ", extra, sizeof(extra))) break;
+            readLine("Match only the start of the name? (y/n): ", text, sizeof(text));
+            snprintf(command, sizeof(command), "find|%s%s", extra, text[0] == 'y' ? "|prefix" : "");
+            alive = run(connection, command, NULL);
+            if (alive && connection->reply.size == 0) printf("No student's name matches '%s'.\n", extra);
+            break;
+
+        case 5:
+            printf("\n--- Modify Student SRN ---\n");
+            if (!readField("Enter OLD Student SRN: ", srn, sizeof(srn))) break;
+            if (!readField("Enter NEW Student SRN: ", extra, sizeof(extra))) break;
+            snprintf(command, sizeof(command), "rekey|%s|%s", srn, extra);
+            alive = run(connection, command, "SRN modified successfully.");
+            break;
+
+        case 20:
+            printf("\n--- Re-key SRNs in Bulk ---\n");
+            if (!readField("Enter a mapping file on the server (leave blank for a prefix rule): ", text, sizeof(text))) break;
+            if (text[0] != '\0') {
+                snprintf(command, sizeof(command), "rekey|file|%s", text);
+            } else {
+                if (!readField("Enter OLD SRN prefix (e.g., PES1UG22): ", srn, sizeof(srn))) break;
+                if (!readField("Enter NEW SRN prefix (e.g., PES2UG22): ", extra, sizeof(extra))) break;
+                snprintf(command, sizeof(command), "rekey|prefix|%s|%s", srn, extra);
+            }
+            alive = run(connection, command, "SRNs re-keyed.");
+            break;
+
+        case 6:
+            printf("\n--- Modify Existing Mark ---\n");
+            if (!readField("Enter Student SRN: ", srn, sizeof(srn))) break;
+            readLine("Which mark type?\n1=I1, 2=A1, 3=I2, 4=A2, 5=SEM: ", extra, sizeof(extra));
+            if (componentCode(atoi(extra)) == NULL) {
+                printf("Invalid type.\n");
+                break;
+            }
+            if (!readField("Enter the new mark: ", text, sizeof(text))) break;
+            snprintf(command, sizeof(command), "edit|%s|%s|%s", srn, componentCode(atoi(extra)), text);
+            alive = run(connection, command, "Mark updated.");
+            break;
+
+        case 7:
+            printf("\n--- Take Class Attendance (%s) ---\n", connection->subject);
+            if (!readField("Enter Date (e.g., 2025-11-01): ", extra, sizeof(extra))) break;
+            if (!readField("Enter absent SRNs separated by spaces (leave blank if all present): ", text, sizeof(text))) break;
+            snprintf(command, sizeof(command), "rollcall|%s|%s", extra, text);
+            alive = run(connection, command, NULL);
+            if (alive) printf("...Attendance complete.\n");
+            break;
+
+        case 8: case 9: case 10: case 11: case 12:
+            if (!readField("Enter Student SRN: ", srn, sizeof(srn))) break;
+            if (!readField("Enter the score: ", text, sizeof(text))) break;
+            snprintf(command, sizeof(command), "mark|%s|%s|%s", srn, componentCode(choice - 7), text);
+            alive = run(connection, command, "Mark added successfully.");
+            break;
+
+        case 13:
+            if (!readField("Enter Student SRN: ", srn, sizeof(srn))) break;
+            printf("Enter Subject Name for report (or leave blank for %s): ", connection->subject);
+            if (!readField("", extra, sizeof(extra))) break;
+            snprintf(command, sizeof(command), "report|%s|%s", srn, extra);
+            alive = run(connection, command, NULL);
+            break;
+
+        case 14:
+            if (!readField("Enter Student SRN: ", srn, sizeof(srn))) break;
+            snprintf(command, sizeof(command), "master|%s", srn);
+            alive = run(connection, command, NULL);
+            break;
+
+        case 16:
+            printf("\n--- Class Statistics ---\n");
+            printf("Enter Subject Name (or leave blank for %s): ", connection->subject);
+            if (!readField("", extra, sizeof(extra))) break;
+            readLine("Which mark type?\n1=I1, 2=A1, 3=I2, 4=A2, 5=SEM: ", text, sizeof(text));
+            if (componentCode(atoi(text)) == NULL) {
+                printf("Invalid type.\n");
+                break;
+            }
+            if (extra[0] != '\0') snprintf(command, sizeof(command), "stats|%s|%s", componentCode(atoi(text)), extra);
+            else snprintf(command, sizeof(command), "stats|%s", componentCode(atoi(text)));
+            alive = run(connection, command, NULL);
+            break;
+
+        case 17:
+            printf("\n--- Cohort Reports ---\n");
+            if (!readField("Enter output file on the server: ", text, sizeof(text)) || text[0] == '\0') break;
+            readLine("Include each student's master report? (y/n): ", extra, sizeof(extra));
+            snprintf(command, sizeof(command), "cohort|%s%s", text, extra[0] == 'y' ? "|master" : "");
+            alive = run(connection, command, NULL);
+            break;
+
+        case 19:
+            alive = run(connection, "perf", NULL);
+            break;
+
+        case 15:
+            printf("You are logging out, %s.\n", connection->teacherName);
+            printf("Every change is already journaled by the server.\n");
+            return 0;
+
+        default:
+            printf("Invalid choice. That option is not available when connected to a server.\n");
+    }
+    return alive ? 1 : -1;
+}
+
+// Logs in and learns the teacher's name and subject. Returns 1 on success,
+// 0 on a failed login, -1 if the server went away.
+static int clientLogin(Connection* connection) {
+    char id[20], password[50], command[BATCH_LINE_SIZE];
+    printf("\n--- Login ---\n");
+    if (!readField("Enter Teacher ID: ", id, sizeof(id))) return 0;
+    if (!readField("Enter Password: ", password, sizeof(password))) return 0;
+    snprintf(command, sizeof(command), "login|%s|%s", id, password);
+    if (!run(connection, command, NULL)) return -1;
+    if (!request(connection, "whoami")) return -1;
+    if (connection->reply.size == 0 || strncmp(connection->reply.data, "Error:", 6) == 0) return 0;
+
+    // "<id>|<name>|<subject>\n"
+    char* name = strchr(connection->reply.data, '|');
+    char* subject = name ? strchr(name + 1, '|') : NULL;
+    if (subject == NULL) return 0;
+    *subject++ = '\0';
+    subject[strcspn(subject, "\n")] = '\0';
+    snprintf(connection->teacherName, sizeof(connection->teacherName), "%s", name + 1);
+    snprintf(connection->subject, sizeof(connection->subject), "%s", subject);
+    return 1;
+}
+
+int runClient(const char* socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("Error: Socket path %s is too long.\n", socketPath);
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    Connection connection;
+    memset(&connection, 0, sizeof(connection));
+    connection.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection.fd < 0 || connect(connection.fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        printf("Error: Could not connect to a server at %s.\n", socketPath);
+        if (connection.fd >= 0) close(connection.fd);
+        return 1;
+    }
+    printf("Connected to %s.\n", socketPath);
+
+    int state = 1;
+    while (state >= 0) {
+        printf("\n==============================================\n");
+        printf("         WELCOME TO THE TRACKER SYSTEM\n");
+        printf("==============================================\n");
+        printf("1. Login\n");
+        printf("3. Exit\n");
+        printf("==============================================\n");
+        printf("Enter your choice: ");
+        int choice = readChoice();
+        if (choice == 3 || choice < 0) break;
+        if (choice != 1) {
+            printf("Invalid choice. Please try again.\n");
+            continue;
+        }
+        state = clientLogin(&connection);
+        while (state > 0) state = mainMenu(&connection);
+    }
+
+    if (state < 0) printf("Error: The server closed the connection.\n");
+    close(connection.fd);
+    textFree(&connection.reply);
+    return state < 0 ? 1 : 0;
+}
+
+#endif // _WIN32
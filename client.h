@@ -0,0 +1,17 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+// --- Client Mode ---
+//
+// "student_tracker --connect [socket]" shows the familiar login and main
+// menus but keeps no data itself: every choice becomes one batch command
+// (see batch.h) sent to a running server (see server.h), and the server's
+// reply is printed. Menu entries keep their usual numbers; the ones the
+// command language has no equivalent for (deleting a student, renaming,
+// changing an SRN, creating a teacher) stay at the keyboard of the server
+// machine and are not offered here.
+
+// Returns the process exit code.
+int runClient(const char* socketPath);
+
+#endif // CLIENT_H
@@ -0,0 +1,361 @@
+#include "cohort_report.h"
+#include "block_store.h"
+#include "tree_cursor.h"
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#define COHORT_MAX_THREADS 64
+
+// One work item: a run of COHORT_CHUNK_STUDENTS consecutive students.
+typedef struct {
+    TextBuffer text; // Single-file mode: the chunk's reports, until the writer takes them
+    int done;
+} CohortChunk;
+
+// A worker's share of the chunks. Only ever shrinks: the owner takes from
+// the front (lowest SRNs first, which the writer needs first), thieves take
+// from the back.
+typedef struct {
+    size_t* items;
+    size_t head, tail; // items[head .. tail) are still queued
+    pthread_mutex_t lock;
+} WorkQueue;
+
+typedef struct {
+    const CohortOptions* options;
+    StudentNode** students; // In SRN order
+    size_t studentCount;
+    char** subjects;        // Distinct teacher subjects, sorted
+    AttendanceTally* tallies; // Class attendance per subject, computed once
+    size_t subjectCount;
+    CohortChunk* chunks;
+    size_t chunkCount;
+    WorkQueue* queues;      // One per worker
+    int threads;
+    pthread_mutex_t lock;   // Guards chunks[].done and failures
+    pthread_cond_t chunkDone;
+    size_t failures;
+} CohortJob;
+
+typedef struct {
+    CohortJob* job;
+    int self;
+} CohortWorker;
+
+// --- Gathering ---
+
+static int addSubject(CohortJob* job, char* subject, size_t* capacity) {
+    for (size_t i = 0; i < job->subjectCount; i++) {
+        if (strcmp(job->subjects[i], subject) == 0) return 1;
+    }
+    if (job->subjectCount == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 8;
+        char** subjects = (char**)realloc(job->subjects, grown * sizeof(char*));
+        if (subjects == NULL) return 0;
+        job->subjects = subjects;
+        *capacity = grown;
+    }
+    job->subjects[job->subjectCount++] = subject;
+    return 1;
+}
+
+// The subjects are sorted afterwards, so any order will do; pre-order keeps
+// the cursor's stack shortest on a lopsided teacher tree.
+static int collectSubjects(CohortJob* job, TeacherNode* root, size_t* capacity) {
+    TreeCursor cursor;
+    TeacherNode* teacher;
+    int ok = 1;
+    openTeacherCursor(&cursor, root, CURSOR_PRE_ORDER);
+    while (ok && (teacher = nextTeacher(&cursor)) != NULL) ok = addSubject(job, teacher->subject, capacity);
+    if (cursor.failed) ok = 0;
+    closeCursor(&cursor);
+    return ok;
+}
+
+static int compareSubjects(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// --- Workers ---
+
+static int takeChunk(CohortJob* job, int self, size_t* chunk) {
+    WorkQueue* own = &job->queues[self];
+    pthread_mutex_lock(&own->lock);
+    int found = own->head < own->tail;
+    if (found) *chunk = own->items[own->head++];
+    pthread_mutex_unlock(&own->lock);
+    if (found) return 1;
+
+    for (int k = 1; k < job->threads; k++) {
+        WorkQueue* victim = &job->queues[(self + k) % job->threads];
+        pthread_mutex_lock(&victim->lock);
+        found = victim->head < victim->tail;
+        if (found) *chunk = victim->items[--victim->tail];
+        pthread_mutex_unlock(&victim->lock);
+        if (found) return 1;
+    }
+    return 0; // Nothing is ever queued again, so every queue is empty for good
+}
+
+static void renderStudent(CohortJob* job, ReportWriter* writer, StudentNode* student) {
+    reportCohortStudent(writer, student, job->subjects, job->tallies, job->subjectCount, job->options->includeMaster);
+}
+
+// Writes one student's file. SRN characters that are not safe in a file
+// name become '_'.
+static int writeStudentFile(CohortJob* job, char* path, StudentNode* student, const TextBuffer* text) {
+    size_t length = (size_t)sprintf(path, "%s/", job->options->outputPath);
+    for (const char* c = student->studentSRN; *c != '\0'; c++) {
+        path[length++] = (isalnum((unsigned char)*c) || *c == '-' || *c == '_') ? *c : '_';
+    }
+    strcpy(path + length, reportFormatExtension(job->options->format));
+
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("Error: Could not create report file %s.\n", path);
+        return 0;
+    }
+    int written = textWrite(text, fp);
+    if (fclose(fp) != 0) written = 0;
+    if (!written) printf("Error: Could not write report file %s.\n", path);
+    return written;
+}
+
+static void* cohortWorker(void* arg) {
+    CohortWorker* worker = (CohortWorker*)arg;
+    CohortJob* job = worker->job;
+    ReportWriter writer; // Directory mode: reused for every student
+    reportOpen(&writer, job->options->format, REPORT_COHORT, NULL);
+    char* path = NULL;
+    if (job->options->perStudentFiles) {
+        path = (char*)malloc(strlen(job->options->outputPath) + sizeof(((StudentNode*)0)->studentSRN) + 8);
+    }
+
+    size_t chunk;
+    while (takeChunk(job, worker->self, &chunk)) {
+        size_t first = chunk * COHORT_CHUNK_STUDENTS;
+        size_t last = first + COHORT_CHUNK_STUDENTS;
+        if (last > job->studentCount) last = job->studentCount;
+        size_t failures = 0;
+
+        if (job->options->perStudentFiles) {
+            for (size_t i = first; i < last; i++) {
+                textReset(&writer.text);
+                writer.entries = 0;
+                reportBegin(&writer);
+                renderStudent(job, &writer, job->students[i]);
+                reportEnd(&writer);
+                if (path == NULL || !writeStudentFile(job, path, job->students[i], &writer.text)) failures++;
+            }
+        } else {
+            // The chunk is the middle of the file: the entry count carries on
+            // from the chunks before it, so JSON separators come out right.
+            ReportWriter part;
+            reportOpen(&part, job->options->format, REPORT_COHORT, NULL);
+            part.entries = first;
+            for (size_t i = first; i < last; i++) renderStudent(job, &part, job->students[i]);
+            job->chunks[chunk].text = part.text;
+        }
+
+        pthread_mutex_lock(&job->lock);
+        job->chunks[chunk].done = 1;
+        job->failures += failures;
+        pthread_cond_broadcast(&job->chunkDone);
+        pthread_mutex_unlock(&job->lock);
+    }
+    reportClose(&writer);
+    free(path);
+    return NULL;
+}
+
+// --- Job ---
+
+int cohortDefaultThreads(void) {
+    long cpus;
+#ifdef _WIN32
+    const char* env = getenv("NUMBER_OF_PROCESSORS");
+    cpus = env ? atol(env) : 1;
+#else
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpus < 1) return 1;
+    return cpus > COHORT_MAX_THREADS ? COHORT_MAX_THREADS : (int)cpus;
+}
+
+static double wallSeconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+static int makeReportDirectory(const char* path) {
+#ifdef _WIN32
+    int made = _mkdir(path);
+#else
+    int made = mkdir(path, 0755);
+#endif
+    if (made == 0 || errno == EEXIST) return 1;
+    printf("Error: Could not create report directory %s.\n", path);
+    return 0;
+}
+
+// Writes the chunks to 'fp' in order as they finish, between the document's
+// opening and closing. Each buffer is freed as soon as it is written.
+static int mergeChunks(CohortJob* job, FILE* fp) {
+    ReportWriter document;
+    reportOpen(&document, job->options->format, REPORT_COHORT, fp);
+    reportBegin(&document);
+    int written = reportClose(&document);
+    for (size_t c = 0; c < job->chunkCount; c++) {
+        pthread_mutex_lock(&job->lock);
+        while (!job->chunks[c].done) pthread_cond_wait(&job->chunkDone, &job->lock);
+        pthread_mutex_unlock(&job->lock);
+        if (written && !textWrite(&job->chunks[c].text, fp)) written = 0;
+        textFree(&job->chunks[c].text);
+    }
+    reportOpen(&document, job->options->format, REPORT_COHORT, fp);
+    document.entries = job->studentCount;
+    if (!reportEnd(&document)) written = 0;
+    reportClose(&document);
+    return written;
+}
+
+static void releaseJob(CohortJob* job) {
+    if (job->queues != NULL) {
+        for (int t = 0; t < job->threads; t++) {
+            free(job->queues[t].items);
+            pthread_mutex_destroy(&job->queues[t].lock);
+        }
+    }
+    if (job->chunks != NULL) {
+        for (size_t c = 0; c < job->chunkCount; c++) textFree(&job->chunks[c].text);
+    }
+    free(job->queues);
+    free(job->chunks);
+    free(job->tallies);
+    free(job->subjects);
+    free(job->students);
+}
+
+int generateCohortReports(TeacherNode* teacherRoot, StudentNode* studentRoot, const CohortOptions* options) {
+    CohortJob job;
+    memset(&job, 0, sizeof(job));
+    job.options = options;
+
+    if (options->format == REPORT_FORMAT_CSV && options->includeMaster) {
+        printf("Error: A CSV cohort holds subject rows only; use text or JSON for master reports.\n");
+        return 0;
+    }
+    size_t total = countStudentTree(studentRoot);
+    if (total == 0) {
+        printf("No students to report on.\n");
+        return 1;
+    }
+    // The workers only read, so every lazily loaded history comes in first.
+    if (!faultInAllHistories()) return 0;
+    size_t subjectCapacity = 0;
+    job.students = (StudentNode**)malloc(total * sizeof(StudentNode*));
+    if (job.students == NULL || !collectSubjects(&job, teacherRoot, &subjectCapacity)) {
+        printf("Error: Memory allocation failed!\n");
+        releaseJob(&job);
+        return 0;
+    }
+    job.studentCount = flattenStudentTree(studentRoot, job.students);
+    if (job.subjectCount > 1) qsort(job.subjects, job.subjectCount, sizeof(char*), compareSubjects);
+
+    job.tallies = (AttendanceTally*)calloc(job.subjectCount ? job.subjectCount : 1, sizeof(AttendanceTally));
+    job.chunkCount = (job.studentCount + COHORT_CHUNK_STUDENTS - 1) / COHORT_CHUNK_STUDENTS;
+    job.chunks = (CohortChunk*)calloc(job.chunkCount, sizeof(CohortChunk));
+    job.threads = options->threads > 0 ? options->threads : cohortDefaultThreads();
+    if (job.threads > COHORT_MAX_THREADS) job.threads = COHORT_MAX_THREADS;
+    if ((size_t)job.threads > job.chunkCount) job.threads = (int)job.chunkCount;
+    job.queues = (WorkQueue*)calloc(job.threads, sizeof(WorkQueue));
+    if (job.tallies == NULL || job.chunks == NULL || job.queues == NULL) {
+        printf("Error: Memory allocation failed!\n");
+        job.threads = 0; // No queue locks were initialised yet
+        releaseJob(&job);
+        return 0;
+    }
+    for (size_t i = 0; i < job.subjectCount; i++) {
+        SymbolId subject;
+        if (lookupSymbol(job.subjects[i], &subject)) job.tallies[i] = classAttendance(subject);
+    }
+
+    // Deal the chunks round-robin, so every queue starts with low SRNs.
+    size_t perQueue = (job.chunkCount + job.threads - 1) / job.threads;
+    for (int t = 0; t < job.threads; t++) {
+        job.queues[t].items = (size_t*)malloc(perQueue * sizeof(size_t));
+        pthread_mutex_init(&job.queues[t].lock, NULL);
+    }
+    for (int t = 0; t < job.threads; t++) {
+        if (job.queues[t].items == NULL) {
+            printf("Error: Memory allocation failed!\n");
+            releaseJob(&job);
+            return 0;
+        }
+    }
+    for (size_t c = 0; c < job.chunkCount; c++) {
+        WorkQueue* queue = &job.queues[c % job.threads];
+        queue->items[queue->tail++] = c;
+    }
+
+    FILE* fp = NULL;
+    if (options->perStudentFiles) {
+        if (!makeReportDirectory(options->outputPath)) {
+            releaseJob(&job);
+            return 0;
+        }
+    } else if ((fp = fopen(options->outputPath, "w")) == NULL) {
+        printf("Error: Could not create report file %s.\n", options->outputPath);
+        releaseJob(&job);
+        return 0;
+    }
+
+    double started = wallSeconds();
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.chunkDone, NULL);
+    CohortWorker workers[COHORT_MAX_THREADS];
+    pthread_t ids[COHORT_MAX_THREADS];
+    int running = 0;
+    for (int t = 0; t < job.threads; t++) {
+        workers[t].job = &job;
+        workers[t].self = t;
+        if (pthread_create(&ids[running], NULL, cohortWorker, &workers[t]) == 0) running++;
+    }
+    // Queues of workers that failed to start are stolen by the others; with
+    // none started, this thread does all the work itself.
+    if (running == 0) cohortWorker(&workers[0]);
+
+    int ok = 1;
+    if (fp != NULL) {
+        ok = mergeChunks(&job, fp);
+        if (fclose(fp) != 0) ok = 0;
+        if (!ok) printf("Error: Could not write report file %s.\n", options->outputPath);
+    }
+    for (int t = 0; t < running; t++) pthread_join(ids[t], NULL);
+    if (job.failures > 0) ok = 0;
+    double seconds = wallSeconds() - started;
+
+    size_t perStudent = job.subjectCount + (options->includeMaster ? 1 : 0);
+    printf("Wrote %zu report(s) for %zu student(s) to %s in %.2fs using %d thread(s).\n",
+           perStudent * job.studentCount, job.studentCount, options->outputPath, seconds,
+           running ? running : 1);
+
+    pthread_cond_destroy(&job.chunkDone);
+    pthread_mutex_destroy(&job.lock);
+    releaseJob(&job);
+    return ok;
+}
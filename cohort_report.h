@@ -0,0 +1,40 @@
+#ifndef COHORT_REPORT_H
+#define COHORT_REPORT_H
+
+#include "report_writer.h"
+
+// --- Cohort Reports ---
+//
+// End-of-term job: every student's subject report for every subject taught
+// (one per teacher subject), optionally followed by their master report.
+//
+// The students are flattened in SRN order and cut into small chunks, which
+// are dealt out to a pool of worker threads. Each worker drains its own
+// queue from the front and, once empty, steals from the back of the others,
+// so a run of students with long histories does not leave threads idle.
+// Reports are rendered into per-chunk buffers and written in SRN order, so
+// the output is the same whatever the thread count.
+//
+// Any report format works (see report_writer.h). A CSV cohort holds the
+// subject rows only, so it cannot include master reports.
+//
+// Rendering only reads the data; nothing may modify it while a job runs.
+
+#define COHORT_CHUNK_STUDENTS 32 // Students per work item
+
+typedef struct {
+    const char* outputPath; // One file, or a directory when perStudentFiles is set
+    int perStudentFiles;    // Write <outputPath>/<SRN>.txt (.csv, .json) per student instead
+    int includeMaster;      // Append each student's master report
+    int threads;            // Worker threads; 0 = one per online CPU
+    ReportFormat format;
+} CohortOptions;
+
+// Runs the job and prints a one-line summary. Returns 1 on success, 0 if
+// an output file could not be written (the other reports are still written).
+int generateCohortReports(TeacherNode* teacherRoot, StudentNode* studentRoot, const CohortOptions* options);
+
+// The thread count a 0 in CohortOptions.threads stands for.
+int cohortDefaultThreads(void);
+
+#endif // COHORT_REPORT_H
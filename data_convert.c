@@ -0,0 +1,48 @@
+#include "student_tracker.h"
+
+// Converts a save file between the text, binary snapshot, segmented and
+// compressed block formats.
+//
+// Usage: data_convert <to-binary|to-segments|to-blocks|to-text> <input file> <output file>
+//
+// The input format is detected automatically, so either direction also works
+// as a plain copy/normalisation of a file that is already in that format.
+
+static void printUsage(const char* program) {
+    printf("Usage: %s <to-binary|to-segments|to-blocks|to-text> <input file> <output file>\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    DataFormat format;
+    if (strcmp(argv[1], "to-binary") == 0) {
+        format = DATA_FORMAT_BINARY;
+    } else if (strcmp(argv[1], "to-segments") == 0) {
+        format = DATA_FORMAT_SEGMENTED;
+    } else if (strcmp(argv[1], "to-blocks") == 0) {
+        format = DATA_FORMAT_BLOCKS;
+    } else if (strcmp(argv[1], "to-text") == 0) {
+        format = DATA_FORMAT_TEXT;
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TeacherNode* teacherRoot = NULL;
+    StudentNode* studentRoot = NULL;
+    if (!loadDataFromFile(argv[2], &teacherRoot, &studentRoot)) {
+        printf("Error: Could not read %s.\n", argv[2]);
+        return 1;
+    }
+
+    int ok = saveDataToFile(argv[3], format, teacherRoot, studentRoot);
+    if (ok) printf("Converted %s -> %s (%s).\n", argv[2], argv[3], argv[1]);
+    else printf("Error: Could not write %s.\n", argv[3]);
+
+    releaseAllData();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,389 @@
+#include "history.h"
+#include "node_pool.h"
+#include <string.h>
+
+#define HISTORY_TYPE_ESCAPE 7
+#define HISTORY_SAME_SUBJECT 0x08
+#define HISTORY_DEFAULT_DESC 0x10
+#define HISTORY_NEGATIVE 0x20
+#define HISTORY_RUN 0x40
+#define HISTORY_UNIT_MAX 40          // Longest run: header, subject, count and five 5-byte values
+#define HISTORY_CHUNK_RECORDS HISTORY_CHUNK_BYTES // Every record takes at least one byte
+#define HISTORY_SPLIT_MAX 3          // Chunks one rewritten chunk can spread over
+
+static NodePool chunkPool = NODE_POOL_INIT(HistoryChunk, next);
+
+// The symbol of each mark type's name, once a record has used it as its
+// description. Ids stay valid until releaseHistoryStore. A name that was
+// not interned yet is looked up again only once new symbols appear.
+static SymbolId defaultDescriptions[MARK_COMPONENTS] = {
+    SYMBOL_INVALID, SYMBOL_INVALID, SYMBOL_INVALID, SYMBOL_INVALID, SYMBOL_INVALID
+};
+static size_t symbolsSeen[MARK_COMPONENTS];
+
+static int isMarkType(RecordType type) {
+    return type >= INTERNAL_1 && type <= SEMESTER_EXAM;
+}
+
+static int isDefaultDescription(RecordType type, SymbolId description) {
+    if (!isMarkType(type)) return 0;
+    int c = type - INTERNAL_1;
+    if (defaultDescriptions[c] == SYMBOL_INVALID && symbolsSeen[c] != symbolCount()) {
+        symbolsSeen[c] = symbolCount();
+        if (!lookupSymbol(recordTypeName(type), &defaultDescriptions[c])) defaultDescriptions[c] = SYMBOL_INVALID;
+    }
+    return description == defaultDescriptions[c];
+}
+
+// --- Varints ---
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static uint32_t getVarint(const uint8_t** in) {
+    const uint8_t* p = *in;
+    uint32_t value = 0;
+    int shift = 0;
+    do {
+        value |= (uint32_t)(*p & 0x7F) << shift;
+        shift += 7;
+    } while (*p++ & 0x80);
+    *in = p;
+    return value;
+}
+
+static uint32_t magnitude(int value) {
+    return value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+}
+
+// --- Encoding ---
+
+// Number of records from the first that can share one run.
+static size_t runLength(const PerformanceRecord* records, size_t count) {
+    const PerformanceRecord* first = &records[0];
+    if (!isMarkType(first->type) || first->value < 0 || !isDefaultDescription(first->type, first->description)) return 1;
+    size_t length = 1;
+    while (length < count) {
+        const PerformanceRecord* next = &records[length];
+        if ((int)next->type != (int)first->type - (int)length || !isMarkType(next->type) ||
+            next->subject != first->subject || next->value < 0 ||
+            !isDefaultDescription(next->type, next->description)) break;
+        length++;
+    }
+    return length;
+}
+
+// Encodes the record (or run) at the start of 'records' into 'out', which
+// holds HISTORY_UNIT_MAX bytes. Returns how many records it took.
+static size_t encodeUnit(const PerformanceRecord* records, size_t count, SymbolId previousSubject,
+                         uint8_t* out, size_t* length) {
+    const PerformanceRecord* first = &records[0];
+    size_t run = runLength(records, count);
+    size_t n = 1;
+    int type = (int)first->type;
+    uint8_t header = (type >= 0 && type < HISTORY_TYPE_ESCAPE) ? (uint8_t)type : HISTORY_TYPE_ESCAPE;
+    if (first->subject == previousSubject) header |= HISTORY_SAME_SUBJECT;
+    if (isDefaultDescription(first->type, first->description)) header |= HISTORY_DEFAULT_DESC;
+    if (first->value < 0) header |= HISTORY_NEGATIVE;
+    if (run > 1) header |= HISTORY_RUN;
+    out[0] = header;
+    if ((header & 0x07) == HISTORY_TYPE_ESCAPE) {
+        n += putVarint(out + n, ((uint32_t)type << 1) ^ (uint32_t)(type >> 31));
+    }
+    if (!(header & HISTORY_SAME_SUBJECT)) n += putVarint(out + n, first->subject);
+    if (!(header & HISTORY_DEFAULT_DESC)) n += putVarint(out + n, first->description);
+    if (run > 1) out[n++] = (uint8_t)run;
+    for (size_t i = 0; i < run; i++) n += putVarint(out + n, magnitude(records[i].value));
+    *length = n;
+    return run;
+}
+
+// Packs records into at most 'capacity' bytes. 'previousSubject' is the
+// subject of the record just before 'out' in its chunk (SYMBOL_INVALID at
+// the start of a chunk). Returns how many records fit; 'lastUnit' is where
+// the last of their units starts.
+static size_t packRecords(const PerformanceRecord* records, size_t count, SymbolId previousSubject,
+                          uint8_t* out, size_t capacity, size_t* used, size_t* lastUnit) {
+    uint8_t unit[HISTORY_UNIT_MAX];
+    size_t packed = 0, length;
+    *used = 0;
+    *lastUnit = 0;
+    while (packed < count) {
+        size_t taken = encodeUnit(records + packed, count - packed, previousSubject, unit, &length);
+        if (*used + length > capacity) break;
+        memcpy(out + *used, unit, length);
+        *lastUnit = *used;
+        *used += length;
+        packed += taken;
+        previousSubject = records[packed - 1].subject;
+    }
+    return packed;
+}
+
+// --- Decoding ---
+
+// Reads a record (or the first record of a run) at 'cursor->offset' in
+// its chunk; its value is left for readValue. Returns the run length.
+static size_t readUnit(HistoryCursor* cursor, const uint8_t** in, int* negative) {
+    const uint8_t* p = *in;
+    uint8_t header = *p++;
+    PerformanceRecord* record = &cursor->last;
+    if ((header & 0x07) == HISTORY_TYPE_ESCAPE) {
+        uint32_t zigzag = getVarint(&p);
+        record->type = (RecordType)(int)((zigzag >> 1) ^ (0u - (zigzag & 1)));
+    } else {
+        record->type = (RecordType)(header & 0x07);
+    }
+    if (!(header & HISTORY_SAME_SUBJECT)) record->subject = getVarint(&p); // Otherwise unchanged
+    record->description = (header & HISTORY_DEFAULT_DESC) ? defaultDescriptions[record->type - INTERNAL_1] : getVarint(&p);
+    size_t run = (header & HISTORY_RUN) ? *p++ : 1;
+    *negative = (header & HISTORY_NEGATIVE) != 0;
+    *in = p;
+    return run;
+}
+
+static int readValue(const uint8_t** in, int negative) {
+    uint32_t value = getVarint(in);
+    return negative ? (int)(0u - value) : (int)value;
+}
+
+// Like nextHistoryRecord, but stays within the cursor's chunk.
+static int nextInChunk(HistoryCursor* cursor, PerformanceRecord* record) {
+    const uint8_t* p = cursor->chunk->bytes + cursor->offset;
+    int negative = 0;
+    if (cursor->runLeft > 0) {
+        cursor->last.type--;
+        cursor->last.description = defaultDescriptions[cursor->last.type - INTERNAL_1];
+        cursor->runLeft--;
+    } else {
+        if (cursor->offset >= cursor->chunk->used) return 0;
+        cursor->runLeft = readUnit(cursor, &p, &negative) - 1;
+    }
+    cursor->last.value = readValue(&p, negative);
+    cursor->offset = (size_t)(p - cursor->chunk->bytes);
+    *record = cursor->last;
+    return 1;
+}
+
+void openHistoryCursor(HistoryCursor* cursor, const StudentNode* student) {
+    cursor->chunk = student->historyHead;
+    cursor->offset = 0;
+    cursor->runLeft = 0;
+    cursor->last.subject = SYMBOL_INVALID;
+}
+
+int nextHistoryRecord(HistoryCursor* cursor, PerformanceRecord* record) {
+    while (cursor->chunk != NULL) {
+        if (nextInChunk(cursor, record)) return 1;
+        cursor->chunk = cursor->chunk->next;
+        cursor->offset = 0;
+        cursor->last.subject = SYMBOL_INVALID;
+    }
+    return 0;
+}
+
+static size_t unpackChunk(const HistoryChunk* chunk, PerformanceRecord* records) {
+    HistoryCursor cursor = { chunk, 0, 0, { ATTENDANCE, 0, SYMBOL_INVALID, SYMBOL_INVALID } };
+    size_t count = 0;
+    while (nextInChunk(&cursor, &records[count])) count++;
+    return count;
+}
+
+// --- Changing a History ---
+
+static HistoryChunk* newChunk(const PerformanceRecord* record) {
+    HistoryChunk* chunk = (HistoryChunk*)poolAlloc(&chunkPool);
+    if (chunk == NULL) return NULL;
+    size_t used, lastUnit;
+    packRecords(record, 1, SYMBOL_INVALID, chunk->bytes, HISTORY_CHUNK_BYTES, &used, &lastUnit);
+    chunk->used = (uint8_t)used;
+    chunk->lastUnit = (uint8_t)lastUnit;
+    chunk->next = NULL;
+    return chunk;
+}
+
+// Only the first record (or run) of the head chunk can change: the new
+// record may join its run, and it may now repeat the new record's subject.
+// The bytes after it stay as they are and move up.
+int pushHistoryRecord(StudentNode* student, const PerformanceRecord* record) {
+    HistoryChunk* head = student->historyHead;
+    if (head != NULL) {
+        HistoryCursor cursor = { head, 0, 0, { ATTENDANCE, 0, SYMBOL_INVALID, SYMBOL_INVALID } };
+        PerformanceRecord records[MARK_COMPONENTS + 1];
+        size_t count = 1;
+        records[0] = *record;
+        do {
+            nextInChunk(&cursor, &records[count++]);
+        } while (cursor.runLeft > 0);
+        size_t rest = cursor.offset, restLength = head->used - rest;
+        uint8_t packed[HISTORY_CHUNK_BYTES];
+        size_t used, lastUnit;
+        if (packRecords(records, count, SYMBOL_INVALID, packed, HISTORY_CHUNK_BYTES - restLength, &used, &lastUnit) == count) {
+            memmove(head->bytes + used, head->bytes + rest, restLength);
+            memcpy(head->bytes, packed, used);
+            head->lastUnit = (uint8_t)(restLength == 0 ? lastUnit : head->lastUnit - rest + used);
+            head->used = (uint8_t)(used + restLength);
+            return 1;
+        }
+    }
+    HistoryChunk* chunk = newChunk(record);
+    if (chunk == NULL) return 0;
+    chunk->next = head;
+    student->historyHead = chunk;
+    if (student->historyTail == NULL) student->historyTail = chunk;
+    return 1;
+}
+
+// Only the last record (or run) of the tail chunk can change, so it alone
+// is decoded and repacked together with the new one. Its subject is spelled
+// out unless it repeats the one before, which only a scan from the start of
+// the chunk can tell.
+static int repackLastUnit(HistoryChunk* tail, const PerformanceRecord* record) {
+    HistoryCursor cursor = { tail, 0, 0, { ATTENDANCE, 0, SYMBOL_INVALID, SYMBOL_INVALID } };
+    PerformanceRecord records[MARK_COMPONENTS + 1];
+    size_t start = tail->lastUnit, count = 0;
+    if (tail->bytes[start] & HISTORY_SAME_SUBJECT) {
+        while (cursor.offset < start) nextInChunk(&cursor, &records[0]);
+    } else {
+        cursor.offset = start;
+    }
+    SymbolId previousSubject = cursor.last.subject;
+    while (nextInChunk(&cursor, &records[count])) count++;
+    records[count++] = *record;
+    uint8_t packed[HISTORY_CHUNK_BYTES];
+    size_t used, lastUnit;
+    if (packRecords(records, count, previousSubject, packed, HISTORY_CHUNK_BYTES - start, &used, &lastUnit) != count) return 0;
+    memcpy(tail->bytes + start, packed, used);
+    tail->used = (uint8_t)(start + used);
+    tail->lastUnit = (uint8_t)(start + lastUnit);
+    return 1;
+}
+
+// Loaders append every record, so the common cases skip the decoding: the
+// new record either extends the last run (a single record becomes a run of
+// two) or follows as a unit of its own. Returns 0 if the chunk is full.
+static int appendToChunk(HistoryChunk* tail, const PerformanceRecord* record) {
+    uint8_t* unit = tail->bytes + tail->lastUnit;
+    uint8_t header = unit[0];
+    int unitType = header & 0x07;
+    if ((header & HISTORY_SAME_SUBJECT) || unitType == HISTORY_TYPE_ESCAPE) return repackLastUnit(tail, record);
+    const uint8_t* p = unit + 1;
+    SymbolId subject = getVarint(&p);
+    uint8_t* countByte = unit + (p - unit);
+    size_t room = HISTORY_CHUNK_BYTES - tail->used;
+    if ((header & HISTORY_DEFAULT_DESC) && !(header & HISTORY_NEGATIVE) && record->value >= 0 &&
+        record->subject == subject && isMarkType(record->type) &&
+        (int)record->type == unitType - (int)((header & HISTORY_RUN) ? *countByte : 1) &&
+        isDefaultDescription(record->type, record->description)) {
+        uint8_t value[5];
+        size_t length = putVarint(value, (uint32_t)record->value);
+        if (header & HISTORY_RUN) {
+            if (length > room) return 0;
+            (*countByte)++;
+        } else {
+            if (length + 1 > room) return 0;
+            memmove(countByte + 1, countByte, (size_t)(tail->bytes + tail->used - countByte));
+            *countByte = 2;
+            unit[0] |= HISTORY_RUN;
+            tail->used++;
+        }
+        memcpy(tail->bytes + tail->used, value, length);
+        tail->used = (uint8_t)(tail->used + length);
+        return 1;
+    }
+    uint8_t encoded[HISTORY_UNIT_MAX];
+    size_t length;
+    encodeUnit(record, 1, subject, encoded, &length);
+    if (length > room) return 0;
+    memcpy(tail->bytes + tail->used, encoded, length);
+    tail->lastUnit = tail->used;
+    tail->used = (uint8_t)(tail->used + length);
+    return 1;
+}
+
+int appendHistoryRecord(StudentNode* student, const PerformanceRecord* record) {
+    HistoryChunk* tail = student->historyTail;
+    if (tail != NULL && appendToChunk(tail, record)) return 1;
+    HistoryChunk* chunk = newChunk(record);
+    if (chunk == NULL) return 0;
+    if (tail != NULL) tail->next = chunk;
+    else student->historyHead = chunk;
+    student->historyTail = chunk;
+    return 1;
+}
+
+// A new value can take more bytes, or split a run, so the chunk is
+// repacked and may overflow into new chunks linked in after it.
+static int repackChunk(StudentNode* student, HistoryChunk* chunk, const PerformanceRecord* records, size_t count) {
+    uint8_t packed[HISTORY_SPLIT_MAX][HISTORY_CHUNK_BYTES];
+    size_t used[HISTORY_SPLIT_MAX], lastUnit[HISTORY_SPLIT_MAX];
+    HistoryChunk* spill[HISTORY_SPLIT_MAX] = { chunk, NULL, NULL };
+    size_t pieces = 0, done = 0;
+    while (done < count) {
+        if (pieces == HISTORY_SPLIT_MAX) return 0;
+        done += packRecords(records + done, count - done, SYMBOL_INVALID, packed[pieces], HISTORY_CHUNK_BYTES,
+                             &used[pieces], &lastUnit[pieces]);
+        pieces++;
+    }
+    for (size_t i = 1; i < pieces; i++) {
+        spill[i] = (HistoryChunk*)poolAlloc(&chunkPool);
+        if (spill[i] == NULL) {
+            while (--i > 0) poolFree(&chunkPool, spill[i]);
+            printf("Error: Memory allocation failed!\n");
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < pieces; i++) {
+        memcpy(spill[i]->bytes, packed[i], used[i]);
+        spill[i]->used = (uint8_t)used[i];
+        spill[i]->lastUnit = (uint8_t)lastUnit[i];
+        if (i > 0) {
+            spill[i]->next = spill[i - 1]->next;
+            spill[i - 1]->next = spill[i];
+        }
+    }
+    if (student->historyTail == chunk) student->historyTail = spill[pieces - 1];
+    return 1;
+}
+
+int rewriteHistoryValue(StudentNode* student, RecordType type, SymbolId subject, int value) {
+    PerformanceRecord records[HISTORY_CHUNK_RECORDS];
+    for (HistoryChunk* chunk = student->historyHead; chunk != NULL; chunk = chunk->next) {
+        size_t count = unpackChunk(chunk, records);
+        for (size_t i = 0; i < count; i++) {
+            if (records[i].type != type || records[i].subject != subject) continue;
+            records[i].value = value;
+            return repackChunk(student, chunk, records, count);
+        }
+    }
+    return 0;
+}
+
+// The chunks are already chained through 'next', the pool's free-list
+// link, so the whole history goes back in one splice.
+void freeHistoryChunks(StudentNode* student) {
+    poolFreeChain(&chunkPool, student->historyHead, student->historyTail);
+    student->historyHead = NULL;
+    student->historyTail = NULL;
+}
+
+size_t historyFootprint(const StudentNode* student) {
+    size_t bytes = 0;
+    for (const HistoryChunk* chunk = student->historyHead; chunk != NULL; chunk = chunk->next) bytes += sizeof(HistoryChunk);
+    return bytes;
+}
+
+void releaseHistoryStore(void) {
+    poolReleaseAll(&chunkPool);
+    for (int c = 0; c < MARK_COMPONENTS; c++) {
+        defaultDescriptions[c] = SYMBOL_INVALID;
+        symbolsSeen[c] = 0;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "student_tracker.h"
+
+// --- Packed Student Histories ---
+//
+// A student's history is a chain of fixed-size chunks from one pool, newest
+// records first. Inside a chunk each record takes a few bytes instead of a
+// 24-byte list node:
+//
+//   header     bits 0-2  type (7: a zigzag varint type follows)
+//              bit 3     same subject as the previous record in this chunk
+//              bit 4     the description is the type's own name ("Internal 1")
+//              bit 5     the value is negative (its magnitude is stored)
+//              bit 6     a run: a count byte follows
+//   [type]     only for type 7
+//   [subject]  varint symbol id, unless bit 3
+//   [desc]     varint symbol id, unless bit 4
+//   [count]    only for a run
+//   value      varint, one per record of the run
+//
+// A run is the marks of one assessment cycle as they are entered: same
+// subject, default descriptions, types one apart (SEMESTER_EXAM, ASSIGNMENT_2,
+// ... newest first) and non-negative values. A term's five marks in a
+// subject pack into 8 bytes, so a typical student-term fits one chunk.
+// Attendance never reaches the history; it has its own 2-bit session
+// bitmaps (see attendance.h).
+//
+// Records are read in place with a cursor, never expanded into a list:
+//
+//   HistoryCursor cursor;
+//   PerformanceRecord record;
+//   openHistoryCursor(&cursor, student);
+//   while (nextHistoryRecord(&cursor, &record)) { ... }
+//
+// The history must not change while a cursor is open.
+
+#define HISTORY_CHUNK_SIZE 64
+#define HISTORY_CHUNK_BYTES (HISTORY_CHUNK_SIZE - sizeof(struct HistoryChunk*) - 2)
+
+struct HistoryChunk {
+    struct HistoryChunk* next; // Older records; also the pool's free-list link
+    uint8_t used;              // Bytes of 'bytes' in use (never 0 in a history)
+    uint8_t lastUnit;          // Where the last record (or run) starts, for appends
+    uint8_t bytes[HISTORY_CHUNK_BYTES];
+};
+
+typedef struct {
+    const HistoryChunk* chunk;
+    size_t offset;            // Next byte to decode in 'chunk'
+    size_t runLeft;           // Records of the current run not returned yet
+    PerformanceRecord last;   // The record returned last
+} HistoryCursor;
+
+void openHistoryCursor(HistoryCursor* cursor, const StudentNode* student);
+int nextHistoryRecord(HistoryCursor* cursor, PerformanceRecord* record); // 0 once every record was read
+
+/* --- Changing a History --- */
+// Used by student_tracker.c, which keeps the mark columns in step. Each
+// returns 0, leaving the history as it was, if memory runs out.
+int pushHistoryRecord(StudentNode* student, const PerformanceRecord* record);   // As the newest
+int appendHistoryRecord(StudentNode* student, const PerformanceRecord* record); // As the oldest
+// Sets the value of the newest record of 'type' in 'subject'. Returns 0 if
+// there is none.
+int rewriteHistoryValue(StudentNode* student, RecordType type, SymbolId subject, int value);
+void freeHistoryChunks(StudentNode* student);
+
+// Bytes the student's history holds on to.
+size_t historyFootprint(const StudentNode* student);
+
+// Returns every chunk at once. Every history becomes invalid.
+void releaseHistoryStore(void);
+
+#endif // HISTORY_H
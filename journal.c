@@ -0,0 +1,697 @@
+#include "journal.h"
+#include "checksum.h"
+#include "rekey.h"
+#include "segment_store.h"
+#include "op_stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+#define ftruncate _chsize
+#define JOURNAL_NO_FORK
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// --- On-disk Layout ---
+//
+//   header: "STRKJRNL" | u32 version | u32 reserved
+//   entry:  u32 bodyLength | body | u32 crc32(body)
+//   body:   u8 op | u64 sequence | fields...
+//
+// Strings are stored as a u8 length followed by the bytes, integers as 4
+// bytes in host order. A torn or corrupt entry ends the journal; anything
+// after it is discarded on the next startup.
+
+#define JOURNAL_MAGIC "STRKJRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 16
+#define JOURNAL_MAX_ENTRY 1024
+#define JOURNAL_GROUP_BYTES (64 * 1024) // Entries buffered between writes while grouping
+
+static int journalFd = -1;
+static long journalSize = 0;
+static long keptSize = 0;          // Journal bytes kept by a logout: everything up to the last sync
+static int rollbackSaved = 0;      // The last sync's data.dat and journal are set aside
+static int rollbackHadSave = 0;    // ...and data.dat existed then
+static int replaying = 0;
+static long compactionPid = 0;    // Background compaction process, 0 if none
+static uint32_t compactionEpoch = 0; // Save epoch covered by that process
+static int compactionFailed = 0;
+static unsigned char* groupBuffer = NULL; // Non-NULL while changes are grouped
+static size_t groupUsed = 0;
+static int groupDepth = 0;                // Groups nest; the outermost end flushes
+
+// --- Entry Encoding ---
+
+typedef struct {
+    unsigned char data[JOURNAL_MAX_ENTRY];
+    size_t size;
+} EntryBuilder;
+
+static void beginEntry(EntryBuilder* entry, JournalOp op, uint64_t sequence) {
+    entry->size = 4; // Room for bodyLength
+    entry->data[entry->size++] = (unsigned char)op;
+    memcpy(entry->data + entry->size, &sequence, sizeof(sequence));
+    entry->size += sizeof(sequence);
+}
+
+static void putString(EntryBuilder* entry, const char* str) {
+    size_t length = strlen(str);
+    if (length > 255) length = 255;
+    entry->data[entry->size++] = (unsigned char)length;
+    memcpy(entry->data + entry->size, str, length);
+    entry->size += length;
+}
+
+static void putInt(EntryBuilder* entry, int value) {
+    int32_t v = value;
+    memcpy(entry->data + entry->size, &v, sizeof(v));
+    entry->size += sizeof(v);
+}
+
+static void finishEntry(EntryBuilder* entry) {
+    uint32_t bodyLength = (uint32_t)(entry->size - 4);
+    memcpy(entry->data, &bodyLength, sizeof(bodyLength));
+    uint32_t crc = crc32Checksum(entry->data + 4, bodyLength);
+    memcpy(entry->data + entry->size, &crc, sizeof(crc));
+    entry->size += sizeof(crc);
+}
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+    int failed;
+} EntryReader;
+
+static void getString(EntryReader* reader, char* out, size_t outSize) {
+    if (reader->failed || reader->pos + 1 > reader->size) {
+        reader->failed = 1;
+        return;
+    }
+    size_t length = reader->data[reader->pos++];
+    if (length >= outSize || reader->pos + length > reader->size) {
+        reader->failed = 1;
+        return;
+    }
+    memcpy(out, reader->data + reader->pos, length);
+    out[length] = '\0';
+    reader->pos += length;
+}
+
+static int getInt(EntryReader* reader) {
+    int32_t v = 0;
+    if (reader->failed || reader->pos + sizeof(v) > reader->size) {
+        reader->failed = 1;
+        return 0;
+    }
+    memcpy(&v, reader->data + reader->pos, sizeof(v));
+    reader->pos += sizeof(v);
+    return v;
+}
+
+// --- Appending ---
+
+static int openJournalFile(void) {
+    journalFd = open(JOURNAL_FILE, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (journalFd < 0) return 0;
+    struct stat st;
+    if (fstat(journalFd, &st) != 0) {
+        close(journalFd);
+        journalFd = -1;
+        return 0;
+    }
+    journalSize = (long)st.st_size;
+    if (journalSize == 0) {
+        unsigned char header[JOURNAL_HEADER_SIZE] = {0};
+        uint32_t version = JOURNAL_VERSION;
+        memcpy(header, JOURNAL_MAGIC, 8);
+        memcpy(header + 8, &version, sizeof(version));
+        if (write(journalFd, header, sizeof(header)) != (long)sizeof(header)) {
+            close(journalFd);
+            journalFd = -1;
+            return 0;
+        }
+        journalSize = JOURNAL_HEADER_SIZE;
+    }
+    keptSize = journalSize;
+    return 1;
+}
+
+static int journalActive(void) {
+    return journalFd >= 0 && !replaying;
+}
+
+static void flushGroup(void) {
+    if (groupUsed == 0 || journalFd < 0) return;
+    uint64_t started = STAT_START();
+    if (write(journalFd, groupBuffer, groupUsed) != (long)groupUsed) {
+        printf("Warning: Could not write to %s. Recent changes may not be durable.\n", JOURNAL_FILE);
+    }
+    STAT_STOP(STAT_JOURNAL_WRITE, started, groupUsed);
+    groupUsed = 0;
+}
+
+static void appendEntry(EntryBuilder* entry) {
+    finishEntry(entry);
+    if (groupBuffer != NULL) {
+        if (groupUsed + entry->size > JOURNAL_GROUP_BYTES) flushGroup();
+        memcpy(groupBuffer + groupUsed, entry->data, entry->size);
+        groupUsed += entry->size;
+        journalSize += (long)entry->size;
+        return;
+    }
+    uint64_t started = STAT_START();
+    if (write(journalFd, entry->data, entry->size) != (long)entry->size) {
+        printf("Warning: Could not write to %s. Recent changes may not be durable.\n", JOURNAL_FILE);
+        return;
+    }
+    STAT_STOP(STAT_JOURNAL_WRITE, started, entry->size);
+    journalSize += (long)entry->size;
+}
+
+void journalBeginGroup(void) {
+    if (groupDepth++ > 0) return;
+    groupBuffer = (unsigned char*)malloc(JOURNAL_GROUP_BYTES); // Without one, entries are written at once
+    groupUsed = 0;
+}
+
+void journalEndGroup(void) {
+    if (groupDepth == 0 || --groupDepth > 0) return;
+    flushGroup();
+    free(groupBuffer);
+    groupBuffer = NULL;
+}
+
+// Starts an entry with the next sequence number.
+static void beginChange(EntryBuilder* entry, JournalOp op) {
+    uint64_t sequence = getDataSequence() + 1;
+    setDataSequence(sequence);
+    beginEntry(entry, op, sequence);
+}
+
+void journalAddTeacher(const char* id, const char* name, const char* password, const char* subject) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_ADD_TEACHER);
+    putString(&entry, id);
+    putString(&entry, name);
+    putString(&entry, password);
+    putString(&entry, subject);
+    appendEntry(&entry);
+}
+
+void journalAddStudent(const char* srn, const char* name) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_ADD_STUDENT);
+    putString(&entry, srn);
+    putString(&entry, name);
+    appendEntry(&entry);
+}
+
+void journalDeleteStudent(const char* srn) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_DELETE_STUDENT);
+    putString(&entry, srn);
+    appendEntry(&entry);
+}
+
+void journalModifyName(const char* srn, const char* name) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_MODIFY_NAME);
+    putString(&entry, srn);
+    putString(&entry, name);
+    appendEntry(&entry);
+}
+
+void journalModifySRN(const char* oldSRN, const char* newSRN) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_MODIFY_SRN);
+    putString(&entry, oldSRN);
+    putString(&entry, newSRN);
+    appendEntry(&entry);
+}
+
+// Body: op | sequence | i32 last (1 in the final part) | (oldSRN, newSRN)...
+void journalRekey(const SRNChange* changes, size_t count) {
+    if (!journalActive() || count == 0) return;
+    journalBeginGroup();
+    size_t next = 0;
+    while (next < count) {
+        EntryBuilder entry;
+        beginChange(&entry, JOURNAL_REKEY);
+        size_t lastAt = entry.size;
+        putInt(&entry, 0);
+        // Each pair takes at most two length bytes and two 19-character SRNs.
+        while (next < count && entry.size + 2 + 2 * (sizeof(changes->oldSRN) - 1) + 4 <= JOURNAL_MAX_ENTRY) {
+            putString(&entry, changes[next].oldSRN);
+            putString(&entry, changes[next].newSRN);
+            next++;
+        }
+        int32_t last = (next == count);
+        memcpy(entry.data + lastAt, &last, sizeof(last));
+        appendEntry(&entry);
+    }
+    journalEndGroup();
+}
+
+void journalAddRecord(const char* srn, RecordType type, int value, const char* subject, const char* desc) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_ADD_RECORD);
+    putString(&entry, srn);
+    putInt(&entry, (int)type);
+    putInt(&entry, value);
+    putString(&entry, subject);
+    putString(&entry, desc);
+    appendEntry(&entry);
+}
+
+void journalModifyMark(const char* srn, RecordType type, const char* subject, int newValue) {
+    if (!journalActive()) return;
+    EntryBuilder entry;
+    beginChange(&entry, JOURNAL_MODIFY_MARK);
+    putString(&entry, srn);
+    putInt(&entry, (int)type);
+    putString(&entry, subject);
+    putInt(&entry, newValue);
+    appendEntry(&entry);
+}
+
+// --- Replay ---
+
+static SRNChangeList pendingRekey = { NULL, 0, 0 }; // Parts of a bulk re-key read so far
+
+// Collects one part of a bulk re-key and applies the batch after its last
+// part. Returns 0 if the body is malformed.
+static int applyRekeyPart(EntryReader* reader, StudentNode** studentRoot) {
+    int last = getInt(reader);
+    while (!reader->failed && reader->pos < reader->size) {
+        if (pendingRekey.count == pendingRekey.capacity) {
+            size_t capacity = pendingRekey.capacity ? pendingRekey.capacity * 2 : 64;
+            SRNChange* items = (SRNChange*)realloc(pendingRekey.items, capacity * sizeof(SRNChange));
+            if (items == NULL) return 0;
+            pendingRekey.items = items;
+            pendingRekey.capacity = capacity;
+        }
+        SRNChange* change = &pendingRekey.items[pendingRekey.count];
+        getString(reader, change->oldSRN, sizeof(change->oldSRN));
+        getString(reader, change->newSRN, sizeof(change->newSRN));
+        pendingRekey.count++;
+    }
+    if (reader->failed) return 0;
+    if (last) {
+        size_t rekeyed = 0;
+        *studentRoot = rekeyStudents(*studentRoot, pendingRekey.items, pendingRekey.count, &rekeyed);
+        pendingRekey.count = 0;
+    }
+    return 1;
+}
+
+// Applies one decoded entry body. Returns 0 if the body is malformed.
+static int applyEntry(EntryReader* reader, JournalOp op, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    char a[100], b[100], c[100], d[100];
+    int type, value, changed;
+    StudentNode* student;
+
+    if (op != JOURNAL_REKEY) pendingRekey.count = 0; // A batch cut short by a crash is dropped
+
+    switch (op) {
+        case JOURNAL_ADD_TEACHER:
+            getString(reader, a, 20); getString(reader, b, 100); getString(reader, c, 50); getString(reader, d, 50);
+            if (reader->failed) return 0;
+            *teacherRoot = addTeacher(*teacherRoot, a, b, c, d);
+            break;
+        case JOURNAL_ADD_STUDENT:
+            getString(reader, a, 20); getString(reader, b, 100);
+            if (reader->failed) return 0;
+            *studentRoot = addStudent(*studentRoot, a, b);
+            break;
+        case JOURNAL_DELETE_STUDENT:
+            getString(reader, a, 20);
+            if (reader->failed) return 0;
+            *studentRoot = deleteStudent(*studentRoot, a);
+            break;
+        case JOURNAL_MODIFY_NAME:
+            getString(reader, a, 20); getString(reader, b, 100);
+            if (reader->failed) return 0;
+            student = lookupStudent(*studentRoot, a);
+            if (student) renameStudent(student, b);
+            break;
+        case JOURNAL_MODIFY_SRN:
+            getString(reader, a, 20); getString(reader, b, 20);
+            if (reader->failed) return 0;
+            *studentRoot = changeStudentSRN(*studentRoot, a, b, &changed);
+            break;
+        case JOURNAL_ADD_RECORD:
+            getString(reader, a, 20); type = getInt(reader); value = getInt(reader);
+            getString(reader, b, 50); getString(reader, c, 50);
+            if (reader->failed || type < ATTENDANCE || type > SEMESTER_EXAM) return 0;
+            addPerformanceRecord(lookupStudent(*studentRoot, a), (RecordType)type, value, b, c);
+            break;
+        case JOURNAL_MODIFY_MARK:
+            getString(reader, a, 20); type = getInt(reader); getString(reader, b, 50); value = getInt(reader);
+            if (reader->failed || type < ATTENDANCE || type > SEMESTER_EXAM) return 0;
+            student = lookupStudent(*studentRoot, a);
+            if (student) updateMark(student, (RecordType)type, b, value);
+            break;
+        case JOURNAL_REKEY:
+            return applyRekeyPart(reader, studentRoot);
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+static unsigned char* readWholeFile(const char* path, size_t* size) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    unsigned char* data = (length > 0) ? (unsigned char*)malloc((size_t)length) : NULL;
+    if (data == NULL || fread(data, 1, (size_t)length, fp) != (size_t)length) {
+        free(data);
+        fclose(fp);
+        return NULL;
+    }
+    fclose(fp);
+    *size = (size_t)length;
+    return data;
+}
+
+// Replays every intact entry newer than the loaded data. If 'trimTail' is
+// set, a torn tail left by a crash is cut off so new entries append cleanly.
+// Returns the number of entries applied, or -1 if the file does not exist.
+static int replayFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot, int trimTail) {
+    size_t size = 0;
+    unsigned char* data = readWholeFile(path, &size);
+    if (data == NULL) return -1;
+    if (size < JOURNAL_HEADER_SIZE || memcmp(data, JOURNAL_MAGIC, 8) != 0) {
+        printf("Warning: %s is not a journal file; ignoring it.\n", path);
+        free(data);
+        return 0;
+    }
+
+    int applied = 0;
+    size_t pos = JOURNAL_HEADER_SIZE;
+    replaying = 1;
+    while (pos + 4 <= size) {
+        uint32_t bodyLength, crc;
+        memcpy(&bodyLength, data + pos, sizeof(bodyLength));
+        if (bodyLength < 9 || bodyLength > JOURNAL_MAX_ENTRY || pos + 4 + bodyLength + 4 > size) break;
+        const unsigned char* body = data + pos + 4;
+        memcpy(&crc, body + bodyLength, sizeof(crc));
+        if (crc != crc32Checksum(body, bodyLength)) break;
+
+        uint64_t sequence;
+        memcpy(&sequence, body + 1, sizeof(sequence));
+        if (sequence > getDataSequence()) {
+            EntryReader reader = { body, bodyLength, 9, 0 };
+            if (!applyEntry(&reader, (JournalOp)body[0], teacherRoot, studentRoot)) break;
+            setDataSequence(sequence);
+            applied++;
+        }
+        pos += 4 + bodyLength + 4;
+    }
+    replaying = 0;
+    free(data);
+    freeSRNChanges(&pendingRekey); // A batch whose last part is missing never happened
+
+    if (pos < size) {
+        printf("Warning: Discarding %lu damaged byte(s) at the end of %s.\n", (unsigned long)(size - pos), path);
+        if (trimTail) {
+            int fd = open(path, O_WRONLY);
+            if (fd >= 0) {
+                if (ftruncate(fd, (long)pos) != 0) printf("Warning: Could not trim %s.\n", path);
+                close(fd);
+            }
+        }
+    }
+    return applied;
+}
+
+// --- Compaction ---
+
+static int fsyncPath(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    int ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Makes data.dat reflect the trees durably. The segmented format updates
+// the file in place and commits atomically on its own; the single-file
+// formats are written to a temporary file that replaces data.dat.
+static int writeSnapshotDurably(TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    if (getSaveFormat() == DATA_FORMAT_SEGMENTED) {
+        return saveDataToFile(SAVE_FILE, DATA_FORMAT_SEGMENTED, teacherRoot, studentRoot);
+    }
+    const char* tempPath = SAVE_FILE ".tmp";
+    if (!saveDataToFile(tempPath, getSaveFormat(), teacherRoot, studentRoot)) return 0;
+    if (!fsyncPath(tempPath)) return 0;
+    if (rename(tempPath, SAVE_FILE) != 0) return 0;
+#ifndef _WIN32
+    fsyncPath("."); // Persist the rename itself
+#endif
+    return 1;
+}
+
+// Copies the first 'limit' bytes of 'from' (all of it if 'limit' is
+// negative) to 'to' and syncs the copy. Returns 1 on success.
+static int copyFileDurably(const char* from, const char* to, long limit) {
+    FILE* in = fopen(from, "rb");
+    if (in == NULL) return 0;
+    FILE* out = fopen(to, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return 0;
+    }
+    char buffer[64 * 1024];
+    int ok = 1;
+    while (limit != 0) {
+        size_t want = (limit < 0 || limit > (long)sizeof(buffer)) ? sizeof(buffer) : (size_t)limit;
+        size_t got = fread(buffer, 1, want, in);
+        if (got == 0) {
+            ok = limit < 0 && !ferror(in); // Only a whole-file copy may end early
+            break;
+        }
+        if (fwrite(buffer, 1, got, out) != got) {
+            ok = 0;
+            break;
+        }
+        if (limit > 0) limit -= (long)got;
+    }
+    fclose(in);
+    if (fclose(out) != 0) ok = 0;
+    if (ok) ok = fsyncPath(to);
+    if (!ok) remove(to);
+    return ok;
+}
+
+static void removeRollbackPoint(void) {
+    remove(SAVE_ROLLBACK_FILE);
+    remove(JOURNAL_ROLLBACK_FILE);
+    rollbackSaved = 0;
+}
+
+// Before the first compaction that would fold unsynced changes into
+// data.dat, sets aside data.dat and the synced part of the journal so a
+// discard can still go back to them. Called with the journal flushed and
+// closed. Returns 0 if they could not be copied.
+static int saveRollbackPoint(void) {
+    if (rollbackSaved || journalSize <= keptSize) return 1;
+    struct stat st;
+    rollbackHadSave = stat(SAVE_FILE, &st) == 0;
+    if ((rollbackHadSave && !copyFileDurably(SAVE_FILE, SAVE_ROLLBACK_FILE, -1)) ||
+        !copyFileDurably(JOURNAL_FILE, JOURNAL_ROLLBACK_FILE, keptSize)) {
+        removeRollbackPoint();
+        return 0;
+    }
+#ifndef _WIN32
+    fsyncPath(".");
+#endif
+    rollbackSaved = 1;
+    return 1;
+}
+
+// Collects a finished background compaction. Blocks if 'wait' is set.
+static void reapCompaction(int wait) {
+#ifndef JOURNAL_NO_FORK
+    if (compactionPid <= 0) return;
+    int status = 0;
+    pid_t pid = waitpid((pid_t)compactionPid, &status, wait ? 0 : WNOHANG);
+    if (pid == 0) return; // Still running
+    compactionPid = 0;
+    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        compactionFailed = 1;
+        printf("Warning: Background compaction failed; changes remain in %s.\n", JOURNAL_COMPACTING_FILE);
+    } else {
+        confirmSaveEpoch(compactionEpoch, SAVE_FILE);
+    }
+#else
+    (void)wait;
+#endif
+}
+
+void journalMaybeCompact(TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    reapCompaction(0);
+    if (journalFd < 0 || compactionPid > 0 || compactionFailed) return;
+    if (journalSize < JOURNAL_COMPACT_THRESHOLD) return;
+
+    // Rotate: everything up to now goes into the snapshot being written,
+    // new changes keep landing in a fresh journal.
+    flushGroup();
+    fsync(journalFd);
+    close(journalFd);
+    journalFd = -1;
+    long synced = keptSize;
+    if (!saveRollbackPoint() || rename(JOURNAL_FILE, JOURNAL_COMPACTING_FILE) != 0) {
+        printf("Warning: Could not compact %s; it keeps growing.\n", JOURNAL_FILE);
+        compactionFailed = 1; // Do not retry after every change
+        openJournalFile();
+        keptSize = synced;
+        return;
+    }
+    if (!openJournalFile()) {
+        printf("Warning: Could not reopen %s. Changes will not be journaled.\n", JOURNAL_FILE);
+    }
+
+    compactionEpoch = beginSaveEpoch();
+#ifndef JOURNAL_NO_FORK
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Child: works on a copy-on-write view of the trees as of the rotation.
+        int ok = writeSnapshotDurably(teacherRoot, studentRoot);
+        if (ok) unlink(JOURNAL_COMPACTING_FILE);
+        _exit(ok ? 0 : 1);
+    }
+    if (pid > 0) {
+        compactionPid = (long)pid;
+        return;
+    }
+#endif
+    // No fork available (or it failed): compact in the foreground.
+    if (writeSnapshotDurably(teacherRoot, studentRoot)) {
+        remove(JOURNAL_COMPACTING_FILE);
+        confirmSaveEpoch(compactionEpoch, SAVE_FILE);
+    } else {
+        compactionFailed = 1;
+        printf("Warning: Compaction failed; changes remain in %s.\n", JOURNAL_COMPACTING_FILE);
+    }
+}
+
+// --- Lifecycle ---
+
+int journalStart(TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    // A rollback point left by a crash is stale: the changes it could have
+    // undone are kept, as they would be without a compaction.
+    removeRollbackPoint();
+
+    // A leftover compacting journal means a background compaction never
+    // finished; its entries are older than the ones in the live journal.
+    int recovered = replayFile(JOURNAL_COMPACTING_FILE, teacherRoot, studentRoot, 0);
+    int replayed = replayFile(JOURNAL_FILE, teacherRoot, studentRoot, 1);
+    int total = (recovered > 0 ? recovered : 0) + (replayed > 0 ? replayed : 0);
+    if (total > 0) printf("Replayed %d change(s) from the journal.\n", total);
+
+    if (!openJournalFile()) {
+        printf("Warning: Could not open %s. Changes will only be saved at logout.\n", JOURNAL_FILE);
+        return 0;
+    }
+
+    if (recovered >= 0) {
+        // Fold both journals into data.dat now so the next rotation cannot
+        // overwrite the leftover file.
+        uint32_t epoch = beginSaveEpoch();
+        if (writeSnapshotDurably(*teacherRoot, *studentRoot)) {
+            confirmSaveEpoch(epoch, SAVE_FILE);
+            remove(JOURNAL_COMPACTING_FILE);
+            if (ftruncate(journalFd, JOURNAL_HEADER_SIZE) == 0) journalSize = keptSize = JOURNAL_HEADER_SIZE;
+        } else {
+            compactionFailed = 1;
+        }
+    }
+    return 1;
+}
+
+int journalIsOpen(void) {
+    return journalFd >= 0;
+}
+
+void journalSync(void) {
+    if (journalFd < 0) return;
+    flushGroup();
+    uint64_t started = STAT_START();
+    if (fsync(journalFd) != 0) {
+        printf("Warning: Could not sync %s to disk.\n", JOURNAL_FILE);
+        return;
+    }
+    STAT_STOP(STAT_JOURNAL_SYNC, started, 0);
+    keptSize = journalSize;
+    if (rollbackSaved) removeRollbackPoint();
+    printf("All changes are safely journaled in %s.\n", JOURNAL_FILE);
+}
+
+// Puts back the data.dat and journal set aside by saveRollbackPoint. The
+// journal goes first: if this stops halfway, the next start replays it on
+// top of the compacted data.dat, which only holds changes it already has
+// or the discarded ones, so the result is still a state the session saw.
+static int restoreRollbackPoint(void) {
+    reapCompaction(1); // The child may still be writing data.dat
+    close(journalFd);
+    journalFd = -1;
+    if (rename(JOURNAL_ROLLBACK_FILE, JOURNAL_FILE) != 0) {
+        printf("Warning: Could not restore %s; the discarded changes stay.\n", JOURNAL_FILE);
+        openJournalFile();
+        return 0;
+    }
+    int ok = rollbackHadSave ? rename(SAVE_ROLLBACK_FILE, SAVE_FILE) == 0 : (remove(SAVE_FILE) == 0 || errno == ENOENT);
+    if (!ok) printf("Warning: Could not restore %s; changes up to the last compaction stay.\n", SAVE_FILE);
+    remove(JOURNAL_COMPACTING_FILE);
+#ifndef _WIN32
+    fsyncPath(".");
+#endif
+    removeRollbackPoint();
+    compactionFailed = 0;
+    if (!openJournalFile()) {
+        printf("Warning: Could not reopen %s. Changes will not be journaled.\n", JOURNAL_FILE);
+        return 0;
+    }
+    return ok;
+}
+
+int journalDiscardUnsynced(void) {
+    if (journalFd < 0) return 0;
+    groupUsed = 0; // Buffered entries never reach the file
+    if (rollbackSaved) return restoreRollbackPoint();
+    if (ftruncate(journalFd, keptSize) != 0) {
+        printf("Warning: Could not discard the changes in %s.\n", JOURNAL_FILE);
+        return 0;
+    }
+    journalSize = keptSize;
+    return 1;
+}
+
+void journalClose(void) {
+    reapCompaction(1);
+    if (groupDepth > 0) {
+        groupDepth = 1;
+        journalEndGroup();
+    }
+    if (journalFd < 0) return;
+    fsync(journalFd);
+    close(journalFd);
+    journalFd = -1;
+}
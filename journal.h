@@ -0,0 +1,70 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "student_tracker.h"
+
+// --- Write-Ahead Journal ---
+//
+// Every change to the trees is appended to JOURNAL_FILE as it happens, so a
+// logout only needs an fsync instead of rewriting data.dat. At startup the
+// journal is replayed on top of the last saved snapshot. Once it grows past
+// JOURNAL_COMPACT_THRESHOLD it is rotated to JOURNAL_COMPACTING_FILE and a
+// background process folds it into a fresh data.dat.
+//
+// Each entry carries a sequence number; the save file records the last
+// sequence it contains (see getDataSequence), so replay skips anything that
+// was already compacted even if a crash left an old journal behind.
+
+#define JOURNAL_FILE "data.journal"
+#define JOURNAL_COMPACTING_FILE "data.journal.compacting"
+#define JOURNAL_ROLLBACK_FILE "data.journal.synced" // The journal as of the last sync...
+#define SAVE_ROLLBACK_FILE SAVE_FILE ".synced"      // ...and data.dat, kept while a compaction holds unsynced changes
+#ifndef JOURNAL_COMPACT_THRESHOLD
+#define JOURNAL_COMPACT_THRESHOLD (4L * 1024 * 1024) // Bytes; override with -D at build time
+#endif
+
+typedef enum {
+    JOURNAL_ADD_TEACHER = 1,
+    JOURNAL_ADD_STUDENT,
+    JOURNAL_DELETE_STUDENT,
+    JOURNAL_MODIFY_NAME,
+    JOURNAL_MODIFY_SRN,
+    JOURNAL_ADD_RECORD,
+    JOURNAL_MODIFY_MARK,
+    JOURNAL_REKEY          // Part of a bulk re-key; replayed once its last part is read
+} JournalOp;
+
+/* --- Lifecycle --- */
+int journalStart(TeacherNode** teacherRoot, StudentNode** studentRoot);
+int journalIsOpen(void);
+void journalSync(void);
+// Cuts every change made since the last journalSync (or since the journal
+// was opened) from the file, so the next start does not replay them; the
+// trees in memory still hold them. If a compaction has folded some of them
+// into data.dat, data.dat and the journal are put back as they were at the
+// last sync. Returns 0 if the journal is closed or could not be cut back.
+int journalDiscardUnsynced(void);
+void journalMaybeCompact(TeacherNode* teacherRoot, StudentNode* studentRoot);
+void journalClose(void);
+
+// Buffers entries in memory and writes them in 64 KB blocks until the
+// matching journalEndGroup (or a sync, compaction or close) flushes them.
+// Groups nest. Used for bulk work such as batch mode and roll calls, where a
+// write per change dominates.
+void journalBeginGroup(void);
+void journalEndGroup(void);
+
+/* --- Change Hooks (no-ops while the journal is closed or replaying) --- */
+void journalAddTeacher(const char* id, const char* name, const char* password, const char* subject);
+void journalAddStudent(const char* srn, const char* name);
+void journalDeleteStudent(const char* srn);
+void journalModifyName(const char* srn, const char* name);
+void journalModifySRN(const char* oldSRN, const char* newSRN);
+// A whole rekeyStudents batch, split over as many entries as it needs.
+// Replay applies it only if every part survived, and all at once, since a
+// shift or swap cannot be applied one change at a time.
+void journalRekey(const SRNChange* changes, size_t count);
+void journalAddRecord(const char* srn, RecordType type, int value, const char* subject, const char* desc);
+void journalModifyMark(const char* srn, RecordType type, const char* subject, int newValue);
+
+#endif // JOURNAL_H
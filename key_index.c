@@ -0,0 +1,81 @@
+#include "key_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t hashKey(const char* key) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Returns the slot holding 'key', or the empty slot where it would go.
+static KeySlot* probe(KeySlot* slots, size_t capacity, uint32_t hash, const char* key) {
+    size_t mask = capacity - 1;
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+        KeySlot* slot = &slots[pos];
+        if (slot->key == NULL) return slot;
+        if (slot->hash == hash && strcmp(slot->key, key) == 0) return slot;
+    }
+}
+
+static int grow(KeyIndex* index) {
+    size_t capacity = index->capacity ? index->capacity * 2 : 1024;
+    KeySlot* slots = (KeySlot*)calloc(capacity, sizeof(KeySlot));
+    if (slots == NULL) return 0;
+    for (size_t i = 0; i < index->capacity; i++) {
+        KeySlot* old = &index->slots[i];
+        if (old->key != NULL) *probe(slots, capacity, old->hash, old->key) = *old;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return 1;
+}
+
+int keyIndexPut(KeyIndex* index, const char* key, void* value) {
+    if ((index->count + 1) * 4 > index->capacity * 3 && !grow(index)) return 0;
+    uint32_t hash = hashKey(key);
+    KeySlot* slot = probe(index->slots, index->capacity, hash, key);
+    if (slot->key == NULL) index->count++;
+    slot->hash = hash;
+    slot->key = key;
+    slot->value = value;
+    return 1;
+}
+
+void* keyIndexGet(const KeyIndex* index, const char* key) {
+    if (index->count == 0) return NULL;
+    KeySlot* slot = probe(index->slots, index->capacity, hashKey(key), key);
+    return slot->value; // An empty slot's value is NULL
+}
+
+void keyIndexRemove(KeyIndex* index, const char* key, const void* value) {
+    if (index->count == 0) return;
+    size_t mask = index->capacity - 1;
+    KeySlot* slot = probe(index->slots, index->capacity, hashKey(key), key);
+    if (slot->key == NULL || slot->value != value) return;
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless that would move them before their home slot.
+    size_t hole = (size_t)(slot - index->slots);
+    for (size_t pos = (hole + 1) & mask; index->slots[pos].key != NULL; pos = (pos + 1) & mask) {
+        size_t home = index->slots[pos].hash & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            index->slots[hole] = index->slots[pos];
+            hole = pos;
+        }
+    }
+    index->slots[hole].key = NULL;
+    index->slots[hole].value = NULL;
+    index->count--;
+}
+
+void keyIndexFree(KeyIndex* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
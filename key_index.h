@@ -0,0 +1,44 @@
+#ifndef KEY_INDEX_H
+#define KEY_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Key Index ---
+//
+// An open-addressing hash table from a string key to a node. Keys are not
+// copied: each entry points at the key inside its node (a studentSRN or a
+// teacherID), which stays put because nodes never move. Linear probing over
+// a power-of-two table kept at most 3/4 full; every slot caches its key's
+// hash so a probe only compares strings when the hashes match. Removal
+// shifts the following entries back, so there are no tombstones.
+
+typedef struct {
+    uint32_t hash;
+    const char* key; // NULL: the slot is empty
+    void* value;
+} KeySlot;
+
+typedef struct {
+    KeySlot* slots;
+    size_t capacity; // 0 or a power of two
+    size_t count;
+} KeyIndex;
+
+#define KEY_INDEX_INIT { NULL, 0, 0 }
+
+uint32_t hashKey(const char* key); // FNV-1a
+
+// Maps 'key' (which must outlive the entry) to 'value', replacing any
+// earlier entry for the same key. Returns 0 if the table could not grow.
+int keyIndexPut(KeyIndex* index, const char* key, void* value);
+
+void* keyIndexGet(const KeyIndex* index, const char* key); // NULL if absent
+
+// Removes the entry for 'key' if it maps to 'value' (a node that was never
+// indexed, or lost its key to another node, leaves the table alone).
+void keyIndexRemove(KeyIndex* index, const char* key, const void* value);
+
+void keyIndexFree(KeyIndex* index); // Leaves an empty, usable table
+
+#endif // KEY_INDEX_H
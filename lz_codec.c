@@ -0,0 +1,134 @@
+#include "lz_codec.h"
+#include <stdint.h>
+#include <string.h>
+
+#define LZ_HASH_BITS 13
+#define LZ_LAST_LITERALS 5   // Matches stop this far from the end (the hash reads 4 bytes)
+#define LZ_SHORT_COPY 16     // Short literal runs and matches are copied as one fixed-size block
+
+size_t lzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// --- Compression ---
+
+static uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hashOf(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Writes the remainder of a length that did not fit in its nibble.
+static unsigned char* putLength(unsigned char* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+static unsigned char* putSequence(unsigned char* op, const unsigned char* literals, size_t literalCount,
+                                  size_t offset, size_t matchLength) {
+    unsigned char* token = op++;
+    *token = (unsigned char)((literalCount < 15 ? literalCount : 15) << 4);
+    if (literalCount >= 15) op = putLength(op, literalCount - 15);
+    memcpy(op, literals, literalCount);
+    op += literalCount;
+    if (matchLength == 0) return op; // The last sequence
+    *op++ = (unsigned char)(offset & 0xFF);
+    *op++ = (unsigned char)(offset >> 8);
+    size_t extra = matchLength - LZ_MIN_MATCH;
+    *token |= (unsigned char)(extra < 15 ? extra : 15);
+    if (extra >= 15) op = putLength(op, extra - 15);
+    return op;
+}
+
+// Greedy parse: each position's 4 bytes are hashed to the last position
+// with the same hash, and a match is taken whenever those bytes agree.
+size_t lzCompress(const char* data, size_t size, char* out) {
+    const unsigned char* src = (const unsigned char*)data;
+    unsigned char* op = (unsigned char*)out;
+    uint32_t table[1 << LZ_HASH_BITS]; // Position + 1, 0 = empty
+    memset(table, 0, sizeof(table));
+
+    size_t anchor = 0, pos = 0;
+    size_t limit = size > LZ_LAST_LITERALS ? size - LZ_LAST_LITERALS : 0;
+    while (pos < limit) {
+        uint32_t sequence = read32(src + pos);
+        uint32_t* slot = &table[hashOf(sequence)];
+        size_t candidate = *slot;
+        *slot = (uint32_t)(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > LZ_MAX_OFFSET || read32(src + candidate - 1) != sequence) {
+            pos++;
+            continue;
+        }
+        candidate--;
+        size_t length = LZ_MIN_MATCH;
+        while (pos + length < limit && src[candidate + length] == src[pos + length]) length++;
+        op = putSequence(op, src + anchor, pos - anchor, pos - candidate, length);
+        // Index a position inside the match so runs keep finding each other.
+        if (length > 2) table[hashOf(read32(src + pos + length - 2))] = (uint32_t)(pos + length - 1);
+        pos += length;
+        anchor = pos;
+    }
+    op = putSequence(op, src + anchor, size - anchor, 0, 0);
+    return (size_t)(op - (unsigned char*)out);
+}
+
+// --- Decompression ---
+
+// Adds the length bytes that follow a saturated nibble. Returns 0 past the end.
+static int getLength(const unsigned char** ip, const unsigned char* end, size_t* length) {
+    unsigned char byte;
+    do {
+        if (*ip >= end) return 0;
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+int lzDecompress(const char* data, size_t size, char* out, size_t rawSize) {
+    const unsigned char* ip = (const unsigned char*)data;
+    const unsigned char* end = ip + size;
+    unsigned char* op = (unsigned char*)out;
+    unsigned char* opEnd = op + rawSize;
+    while (ip < end) {
+        unsigned char token = *ip++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !getLength(&ip, end, &literalCount)) return 0;
+        if (literalCount > (size_t)(end - ip) || literalCount > (size_t)(opEnd - op)) return 0;
+        if (literalCount <= LZ_SHORT_COPY && end - ip >= LZ_SHORT_COPY && opEnd - op >= LZ_SHORT_COPY) {
+            memcpy(op, ip, LZ_SHORT_COPY); // Whole 16 bytes; the extra ones are overwritten next
+        } else {
+            memcpy(op, ip, literalCount);
+        }
+        ip += literalCount;
+        op += literalCount;
+        if (ip == end) break; // The last sequence has no match
+
+        if (end - ip < 2) return 0;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !getLength(&ip, end, &matchLength)) return 0;
+        matchLength += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - (unsigned char*)out) || matchLength > (size_t)(opEnd - op)) return 0;
+        const unsigned char* match = op - offset;
+        if (matchLength <= LZ_SHORT_COPY && offset >= LZ_SHORT_COPY && opEnd - op >= LZ_SHORT_COPY) {
+            memcpy(op, match, LZ_SHORT_COPY);
+            op += matchLength;
+        } else if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        } else {
+            while (matchLength-- > 0) *op++ = *match++; // Overlapping: repeats the last 'offset' bytes
+        }
+    }
+    return op == opEnd;
+}
@@ -0,0 +1,36 @@
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <stddef.h>
+
+// --- LZ Block Codec ---
+//
+// A small LZ77 codec in the style of LZ4 for compressing save-file blocks.
+// A block is a series of sequences, each:
+//
+//   token      high nibble: literal count, low nibble: match length - 4
+//              (15 in either means more length bytes follow, each added
+//              until one is below 255)
+//   [length]   extra literal count bytes
+//   literals
+//   offset     2 bytes, little-endian, distance back to the match (1..65535)
+//   [length]   extra match length bytes
+//
+// The last sequence has literals only and ends the block. Blocks carry no
+// header; the caller stores the raw size alongside the compressed bytes.
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+// Largest possible output of lzCompress for 'size' input bytes.
+size_t lzCompressBound(size_t size);
+
+// Compresses 'size' bytes into 'out', which must hold lzCompressBound(size).
+// Returns the compressed size.
+size_t lzCompress(const char* data, size_t size, char* out);
+
+// Decompresses a block that must expand to exactly 'rawSize' bytes. Returns
+// 0 if the block is malformed (never reading or writing out of bounds).
+int lzDecompress(const char* data, size_t size, char* out, size_t rawSize);
+
+#endif // LZ_CODEC_H
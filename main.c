@@ -1,4 +1,12 @@
 #include "student_tracker.h"
+#include "journal.h"
+#include "batch.h"
+#include "cohort_report.h"
+#include "server.h"
+#include "client.h"
+#include "name_index.h"
+#include "op_stats.h"
+#include "rekey.h"
 
 // --- Login Menu (for startup) ---
 void displayLoginMenu() {
@@ -21,10 +29,12 @@ void displayMainMenu(TeacherNode* teacher) {
     printf(" 1. Add New Student\n");
     printf(" 2. List All Students (Sorted by SRN)\n");
     printf(" 3. Delete a Student\n");
+    printf("18. Search Students by Name\n");
     printf("\n--- Data Modification ---\n");
     printf(" 4. Modify Student Name\n");
     printf(" 5. Modify Student SRN\n");
     printf(" 6. Modify an Existing Mark\n");
+    printf("20. Re-key SRNs in Bulk (mapping file or prefix)\n");
     printf("\n--- Data Entry (Subject: %s) ---\n", teacher->subject);
     printf(" 7. Take Class Attendance\n");
     printf(" 8. Log Internal 1 Mark (20)\n");
@@ -35,11 +45,28 @@ void displayMainMenu(TeacherNode* teacher) {
     printf("\n--- Reporting ---\n");
     printf("13. Generate Subject Marks Report\n");
     printf("14. Generate Full Master Report\n");
+    printf("16. Class Statistics Report\n");
+    printf("17. Generate Cohort Reports (All Students)\n");
+    printf("19. Show Operation Statistics\n");
     printf("15. Logout\n");
     printf("==============================================\n");
     printf("Logged in as: %s | Enter your choice: ", teacher->name);
 }
 
+#define MAX_ABSENTEES 2048 // One per SRN that fits in the absentee line
+#define REPORT_PATH_SIZE 256
+
+// Reads a y/n answer, asking again until it is one of the two.
+int readYesNo(const char* prompt) {
+    char answer = ' ';
+    while (answer != 'y' && answer != 'n') {
+        printf("%s (y/n): ", prompt);
+        if (scanf(" %c", &answer) != 1) return 0;
+        getchar(); // Consume newline
+    }
+    return answer == 'y';
+}
+
 // Helper function to read a line of input safely
 void readString(char* buffer, int size) {
     fgets(buffer, size, stdin);
@@ -51,15 +78,51 @@ StudentNode* getStudent(StudentNode* root) {
     char srnBuffer[20];
     printf("Enter Student SRN: ");
     readString(srnBuffer, 20);
-    StudentNode* student = findStudent(root, srnBuffer);
+    StudentNode* student = lookupStudent(root, srnBuffer);
     if (student == NULL) {
         printf("Error: Student SRN %s not found.\n", srnBuffer);
     }
     return student;
 }
 
+// Runs a command script instead of the menus (see batch.h), then syncs the
+// journal the way a logout with "save" would.
+int runBatchMode(const char* path) {
+    FILE* in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (in == NULL) {
+        printf("Error: Could not open batch file %s.\n", path);
+        return 1;
+    }
+
+    StudentNode* studentRoot = NULL;
+    TeacherNode* teacherRoot = NULL;
+    loadData(&teacherRoot, &studentRoot);
+    journalStart(&teacherRoot, &studentRoot);
+
+    int failed = runBatch(in, &teacherRoot, &studentRoot);
+    if (in != stdin) fclose(in);
+
+    if (journalIsOpen()) journalSync();
+    else saveData(teacherRoot, studentRoot);
+    journalClose();
+    if (statsOn()) printStats(stdout);
+    releaseAllData();
+    return failed > 0 ? 2 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    initStats();
+    initLazyLoading();
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+        return runBatchMode(argc >= 3 ? argv[2] : "-");
+    }
+    if (argc >= 2 && strcmp(argv[1], "--serve") == 0) {
+        return runServer(argc >= 3 ? argv[2] : SERVER_SOCKET);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--connect") == 0) {
+        return runClient(argc >= 3 ? argv[2] : SERVER_SOCKET);
+    }
 
-int main() {
     StudentNode* studentRoot = NULL; 
     TeacherNode* teacherRoot = NULL; 
     TeacherNode* currentTeacher = NULL;
@@ -69,6 +132,7 @@ int main() {
 
     // Load all data from file at startup
     loadData(&teacherRoot, &studentRoot);
+    journalStart(&teacherRoot, &studentRoot); // Re-apply changes made since the last save
     printf("\nPress Enter to continue...");
     getchar();
 
@@ -117,6 +181,7 @@ int main() {
                     printf("Invalid choice. Please try again.\n");
                     break;
             }
+            journalMaybeCompact(teacherRoot, studentRoot);
         }
         
         if (loginChoice == 3) {
@@ -134,8 +199,11 @@ int main() {
                 menuChoice = 0;
             }
             getchar(); // Consume newline
+            uint64_t actionStarted = STAT_START();
 
             char srnBuffer[20], srnBuffer2[20], dateBuffer[50], descBuffer[50];
+            static char absentBuffer[4096];
+            static char* absentees[MAX_ABSENTEES];
             int tempValue;
             StudentNode* foundStudent = NULL;
 
@@ -159,8 +227,9 @@ int main() {
                     printf("\n--- Delete Student ---\n");
                     foundStudent = getStudent(studentRoot);
                     if (foundStudent) {
-                        studentRoot = deleteStudent(studentRoot, foundStudent->studentSRN);
-                        printf("Student %s deleted.\n", foundStudent->studentSRN);
+                        strcpy(srnBuffer, foundStudent->studentSRN); // Node is freed by the delete
+                        studentRoot = deleteStudent(studentRoot, srnBuffer);
+                        printf("Student %s deleted.\n", srnBuffer);
                     }
                     break;
 
@@ -188,11 +257,21 @@ int main() {
                     break;
                 
                 case 7: // Take Attendance
-                    printf("\n--- Take Class Attendance ---\n");
+                    printf("\n--- Take Class Attendance (%s) ---\n", currentTeacher->subject);
                     printf("Enter Date (e.g., 2025-11-01): ");
                     readString(dateBuffer, 50);
-                    if (studentRoot == NULL) printf("No students to take attendance for.\n");
-                    else takeAttendance(studentRoot, dateBuffer);
+                    if (studentRoot == NULL) {
+                        printf("No students to take attendance for.\n");
+                        break;
+                    }
+                    printf("Enter absent SRNs separated by spaces (leave blank if all present, * to ask for each): ");
+                    readString(absentBuffer, sizeof(absentBuffer));
+                    if (strcmp(absentBuffer, "*") == 0) {
+                        takeAttendance(studentRoot, currentTeacher->subject, dateBuffer);
+                    } else {
+                        int absentCount = splitSRNList(absentBuffer, absentees, MAX_ABSENTEES);
+                        recordRollCall(studentRoot, currentTeacher->subject, dateBuffer, absentees, absentCount);
+                    }
                     printf("...Attendance complete.\n");
                     break;
 
@@ -201,7 +280,7 @@ int main() {
                     foundStudent = getStudent(studentRoot);
                     if (foundStudent == NULL) break;
                     
-                    RecordType currentType;
+                    RecordType currentType = INTERNAL_1; // Cases 8-12 each set it below
                     int maxMark = 0;
                     
                     if(menuChoice == 8)  { currentType = INTERNAL_1;   maxMark = 20; strcpy(descBuffer, "Internal 1"); }
@@ -239,6 +318,88 @@ int main() {
                     if (foundStudent) generateMasterReport(foundStudent);
                     break;
 
+                case 16: // Class Statistics
+                    printf("\n--- Class Statistics ---\n");
+                    printf("Enter Subject Name (or leave blank for %s): ", currentTeacher->subject);
+                    readString(subjectBuffer, 50);
+                    if (strlen(subjectBuffer) == 0) {
+                        strcpy(subjectBuffer, currentTeacher->subject);
+                    }
+                    printf("Which mark type?\n1=I1, 2=A1, 3=I2, 4=A2, 5=SEM: ");
+                    if (scanf("%d", &tempValue) != 1) tempValue = 0;
+                    getchar(); // Consume newline
+                    if (tempValue < 1 || tempValue > 5) {
+                        printf("Invalid type.\n");
+                        break;
+                    }
+                    generateClassStatsReport(subjectBuffer, (RecordType)(INTERNAL_1 + tempValue - 1));
+                    break;
+
+                case 17: { // Cohort Reports
+                    char pathBuffer[REPORT_PATH_SIZE];
+                    CohortOptions cohort = { pathBuffer, 0, 0, 0, REPORT_FORMAT_TEXT };
+                    printf("\n--- Cohort Reports ---\n");
+                    cohort.perStudentFiles = readYesNo("One file per student (in a directory)?");
+                    printf("Enter output %s: ", cohort.perStudentFiles ? "directory" : "file");
+                    readString(pathBuffer, REPORT_PATH_SIZE);
+                    if (strlen(pathBuffer) == 0) {
+                        printf("Error: No output path given.\n");
+                        break;
+                    }
+                    printf("Output format? 1=Text, 2=CSV, 3=JSON: ");
+                    if (scanf("%d", &tempValue) != 1) tempValue = 0;
+                    getchar(); // Consume newline
+                    if (tempValue < 1 || tempValue > 3) {
+                        printf("Invalid format.\n");
+                        break;
+                    }
+                    cohort.format = (ReportFormat)(REPORT_FORMAT_TEXT + tempValue - 1);
+                    if (cohort.format != REPORT_FORMAT_CSV) {
+                        cohort.includeMaster = readYesNo("Include each student's master report?");
+                    }
+                    generateCohortReports(teacherRoot, studentRoot, &cohort);
+                    break;
+                }
+
+                case 18: // Search by Name
+                    printf("\n--- Search Students by Name ---\n");
+                    printf("Enter the name or part of it: ");
+                    readString(nameBuffer, 100);
+                    if (readYesNo("Match only the start of the name?")) {
+                        listMatchingStudents(studentRoot, nameBuffer, NAME_PREFIX);
+                    } else {
+                        listMatchingStudents(studentRoot, nameBuffer, NAME_CONTAINS);
+                    }
+                    break;
+
+                case 19: // Operation Statistics
+                    printStats(stdout);
+#ifndef TRACKER_NO_STATS
+                    if (statsOn()) {
+                        if (readYesNo("Clear the statistics?")) resetStats();
+                    } else if (readYesNo("Start recording statistics now?")) {
+                        setStatsEnabled(1);
+                    }
+#endif
+                    break;
+
+                case 20: { // Bulk Re-key
+                    char pathBuffer[REPORT_PATH_SIZE];
+                    printf("\n--- Re-key SRNs in Bulk ---\n");
+                    printf("Enter a mapping file of OLD NEW lines (leave blank for a prefix rule): ");
+                    readString(pathBuffer, REPORT_PATH_SIZE);
+                    if (strlen(pathBuffer) > 0) {
+                        rekeyFromFile(&studentRoot, pathBuffer);
+                        break;
+                    }
+                    printf("Enter OLD SRN prefix (e.g., PES1UG22): ");
+                    readString(srnBuffer, 20);
+                    printf("Enter NEW SRN prefix (e.g., PES2UG22): ");
+                    readString(srnBuffer2, 20);
+                    rekeyByPrefix(&studentRoot, srnBuffer, srnBuffer2);
+                    break;
+                }
+
                 case 15: // Logout
                     printf("You are logging out, %s.\n", currentTeacher->name);
                     char saveChoice = ' ';
@@ -249,9 +410,21 @@ int main() {
                     }
                     
                     if (saveChoice == 'y') {
-                        saveData(teacherRoot, studentRoot);
+                        // Every change is already in the journal; saving only needs an fsync.
+                        if (journalIsOpen()) journalSync();
+                        else saveData(teacherRoot, studentRoot);
                     } else {
-                        printf("Changes not saved. Loading from last save on next login.\n");
+                        // Cut the session's changes from the journal, then reload what
+                        // is on disk so memory and the next start agree.
+                        if (journalIsOpen()) journalDiscardUnsynced();
+                        journalClose();
+                        releaseAllData();
+                        teacherRoot = NULL;
+                        studentRoot = NULL;
+                        setDataSequence(0);
+                        loadData(&teacherRoot, &studentRoot);
+                        journalStart(&teacherRoot, &studentRoot);
+                        printf("Changes not saved. Reloaded the last save.\n");
                     }
                     
                     printf("Logging out...\n");
@@ -259,15 +432,18 @@ int main() {
                     break;
 
                 default:
-                    printf("Invalid choice. Please enter a number between 1 and 15.\n");
+                    printf("Invalid choice. Please enter a number between 1 and 20.\n");
             }
+            STAT_STOP(statMenuAction(menuChoice), actionStarted, 0);
+            journalMaybeCompact(teacherRoot, studentRoot);
         }
     }
 
     // --- FINAL CLEANUP (Only on Exit from Login Menu) ---
+    journalClose();
+    if (statsOn()) printStats(stdout);
     printf("Freeing all allocated memory.\n");
-    freeTree(studentRoot);
-    freeTeacherTree(teacherRoot);
+    releaseAllData(); // Both trees and every history, slab by slab
     printf("All memory freed. Goodbye.\n");
     
     return 0;
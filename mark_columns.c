@@ -0,0 +1,209 @@
+#include "mark_columns.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MARK_COUNTING_RANGE_LIMIT (1u << 20) // Widest value range counted directly for the median
+
+static MarkColumns* columnList = NULL;
+
+// --- Student Ordinals ---
+
+static uint32_t nextOrdinal = 0;     // One past the highest ordinal ever handed out
+static uint32_t* freeOrdinals = NULL;
+static uint32_t freeCount = 0;
+static uint32_t freeCapacity = 0;
+
+uint32_t acquireStudentOrdinal(void) {
+    if (freeCount > 0) return freeOrdinals[--freeCount];
+    return nextOrdinal++;
+}
+
+void releaseStudentOrdinal(uint32_t ordinal) {
+    if (ordinal == NO_STUDENT_ORDINAL) return;
+    if (freeCount == freeCapacity) {
+        uint32_t capacity = freeCapacity ? freeCapacity * 2 : 256;
+        uint32_t* grown = (uint32_t*)realloc(freeOrdinals, capacity * sizeof(uint32_t));
+        if (grown == NULL) return; // The ordinal is simply never reused
+        freeOrdinals = grown;
+        freeCapacity = capacity;
+    }
+    freeOrdinals[freeCount++] = ordinal;
+}
+
+// --- Columns ---
+
+MarkColumns* markColumnsFor(SymbolId subject, int create) {
+    for (MarkColumns* columns = columnList; columns != NULL; columns = columns->next) {
+        if (columns->subject == subject) return columns;
+    }
+    if (!create) return NULL;
+    MarkColumns* columns = (MarkColumns*)calloc(1, sizeof(MarkColumns));
+    if (columns == NULL) return NULL;
+    columns->subject = subject;
+    columns->next = columnList;
+    columnList = columns;
+    return columns;
+}
+
+static int growColumn(MarkColumns* columns, int component, uint32_t needed) {
+    uint32_t capacity = columns->capacity[component] ? columns->capacity[component] : 1024;
+    while (capacity < needed) capacity *= 2;
+    int32_t* grown = (int32_t*)realloc(columns->values[component], (size_t)capacity * sizeof(int32_t));
+    if (grown == NULL) return 0;
+    for (uint32_t i = columns->capacity[component]; i < capacity; i++) grown[i] = MARK_MISSING;
+    columns->values[component] = grown;
+    columns->capacity[component] = capacity;
+    return 1;
+}
+
+int setColumnMark(MarkColumns* columns, int component, uint32_t ordinal, int32_t value) {
+    if (ordinal == NO_STUDENT_ORDINAL) return 1;
+    if (ordinal >= columns->capacity[component]) {
+        if (value == MARK_MISSING) return 1; // Already reads as missing
+        if (!growColumn(columns, component, ordinal + 1)) return 0;
+    }
+    columns->values[component][ordinal] = value;
+    return 1;
+}
+
+int32_t columnMark(const MarkColumns* columns, int component, uint32_t ordinal) {
+    if (columns == NULL || ordinal >= columns->capacity[component]) return MARK_MISSING;
+    return columns->values[component][ordinal];
+}
+
+void releaseMarkColumns(void) {
+    while (columnList != NULL) {
+        MarkColumns* next = columnList->next;
+        for (int i = 0; i < MARK_COLUMN_COUNT; i++) free(columnList->values[i]);
+        free(columnList);
+        columnList = next;
+    }
+    free(freeOrdinals);
+    freeOrdinals = NULL;
+    freeCount = freeCapacity = 0;
+    nextOrdinal = 0;
+}
+
+// --- Aggregate Kernels ---
+//
+// Each sweep is branch-free: missing cells are masked out of the
+// accumulators rather than skipped, so the loops vectorise.
+
+typedef struct {
+    uint32_t count;
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+} ColumnSummary;
+
+static ColumnSummary sweepColumn(const int32_t* restrict values, uint32_t n) {
+    uint32_t count = 0;
+    int64_t sum = 0;
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t v = values[i];
+        int32_t valid = (v != MARK_MISSING);
+        count += (uint32_t)valid;
+        sum += valid ? v : 0;
+        int32_t low = valid ? v : INT32_MAX;
+        min = low < min ? low : min;
+        max = v > max ? v : max; // MARK_MISSING is INT32_MIN, so it never wins
+    }
+    ColumnSummary summary = { count, sum, min, max };
+    return summary;
+}
+
+static double sweepSquaredDeviation(const int32_t* restrict values, uint32_t n, double mean) {
+    double total = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        double d = (values[i] != MARK_MISSING) ? values[i] - mean : 0.0;
+        total += d * d;
+    }
+    return total;
+}
+
+// counts[v - min] for every present value v in [min, min + range).
+static void countValues(const int32_t* restrict values, uint32_t n, int32_t min, uint32_t* restrict counts) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (values[i] != MARK_MISSING) counts[(int64_t)values[i] - min]++;
+    }
+}
+
+static int compareInt32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int bucketOf(int32_t value, int32_t maxMark, int buckets) {
+    if (value < 0) return 0;
+    if (value > maxMark) return buckets - 1;
+    return (int)((int64_t)value * buckets / ((int64_t)maxMark + 1));
+}
+
+// Median and histogram, from value counts when the range is small (marks
+// always are) and from a sorted copy otherwise.
+static int distribution(const int32_t* values, uint32_t n, int32_t maxMark, MarkStats* stats) {
+    uint64_t range = (uint64_t)((int64_t)stats->max - stats->min) + 1;
+    uint32_t lowerRank = (stats->count - 1) / 2, upperRank = stats->count / 2;
+    int32_t lower = 0, upper = 0;
+
+    if (range <= MARK_COUNTING_RANGE_LIMIT) {
+        uint32_t* counts = (uint32_t*)calloc((size_t)range, sizeof(uint32_t));
+        if (counts == NULL) return 0;
+        countValues(values, n, stats->min, counts);
+        uint64_t seen = 0;
+        int haveLower = 0, haveUpper = 0;
+        for (uint64_t i = 0; i < range; i++) {
+            if (counts[i] == 0) continue;
+            int32_t value = (int32_t)(stats->min + (int64_t)i);
+            stats->histogram[bucketOf(value, maxMark, stats->bucketCount)] += counts[i];
+            seen += counts[i];
+            if (!haveLower && seen > lowerRank) { lower = value; haveLower = 1; }
+            if (!haveUpper && seen > upperRank) { upper = value; haveUpper = 1; }
+        }
+        free(counts);
+    } else {
+        int32_t* present = (int32_t*)malloc((size_t)stats->count * sizeof(int32_t));
+        if (present == NULL) return 0;
+        uint32_t k = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            if (values[i] != MARK_MISSING) present[k++] = values[i];
+        }
+        qsort(present, k, sizeof(int32_t), compareInt32);
+        for (uint32_t i = 0; i < k; i++) stats->histogram[bucketOf(present[i], maxMark, stats->bucketCount)]++;
+        lower = present[lowerRank];
+        upper = present[upperRank];
+        free(present);
+    }
+    stats->median = ((double)lower + upper) / 2.0;
+    return 1;
+}
+
+int computeMarkStats(SymbolId subject, int component, int32_t maxMark, MarkStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (component < 0 || component >= MARK_COLUMN_COUNT || maxMark < 0) return 0;
+    MarkColumns* columns = markColumnsFor(subject, 0);
+    if (columns == NULL || columns->values[component] == NULL) return 0;
+
+    const int32_t* values = columns->values[component];
+    uint32_t n = columns->capacity[component];
+    if (n > nextOrdinal) n = nextOrdinal; // Cells past the last ordinal were never written
+
+    ColumnSummary summary = sweepColumn(values, n);
+    if (summary.count == 0) return 0;
+    stats->count = summary.count;
+    stats->min = summary.min;
+    stats->max = summary.max;
+    stats->mean = (double)summary.sum / summary.count;
+    stats->stddev = sqrt(sweepSquaredDeviation(values, n, stats->mean) / summary.count);
+
+    stats->bucketCount = (maxMark + 1 < MARK_HISTOGRAM_BUCKETS) ? maxMark + 1 : MARK_HISTOGRAM_BUCKETS;
+    // Bucket b holds the values v with v * buckets / (maxMark + 1) == b (see bucketOf).
+    int64_t span = (int64_t)maxMark + 1, buckets = stats->bucketCount;
+    for (int b = 0; b < stats->bucketCount; b++) {
+        stats->bucketLow[b] = (int32_t)((b * span + buckets - 1) / buckets);
+        stats->bucketHigh[b] = (int32_t)(((b + 1) * span + buckets - 1) / buckets) - 1;
+    }
+    return distribution(values, n, maxMark, stats);
+}
@@ -0,0 +1,65 @@
+#ifndef MARK_COLUMNS_H
+#define MARK_COLUMNS_H
+
+#include <stdint.h>
+#include "symbol_table.h"
+
+// --- Columnar Mark Store ---
+//
+// Every student gets a dense ordinal when created (freed ordinals are
+// reused). For each subject there is one column per assessment component:
+// a flat int32 array indexed by ordinal holding that student's newest mark,
+// or MARK_MISSING. The student's history (see student_tracker.h) keeps the
+// columns in step, so class-wide statistics sweep contiguous arrays instead
+// of walking the trees and histories, and a student's newest mark is one
+// lookup away.
+
+#define MARK_MISSING INT32_MIN
+#define NO_STUDENT_ORDINAL UINT32_MAX
+#define MARK_COLUMN_COUNT 5          // INTERNAL_1 .. SEMESTER_EXAM
+#define MARK_HISTOGRAM_BUCKETS 10
+
+typedef struct MarkColumns {
+    SymbolId subject;
+    int32_t* values[MARK_COLUMN_COUNT];   // Indexed by component (type - INTERNAL_1)
+    uint32_t capacity[MARK_COLUMN_COUNT]; // Cells allocated; the rest read as MARK_MISSING
+    struct MarkColumns* next;
+} MarkColumns;
+
+typedef struct {
+    uint32_t count;          // Students with a mark
+    int32_t min;
+    int32_t max;
+    double mean;
+    double median;
+    double stddev;
+    int bucketCount;
+    int32_t bucketLow[MARK_HISTOGRAM_BUCKETS];   // Inclusive value range of each bucket
+    int32_t bucketHigh[MARK_HISTOGRAM_BUCKETS];
+    uint32_t histogram[MARK_HISTOGRAM_BUCKETS];
+} MarkStats;
+
+/* --- Student Ordinals --- */
+uint32_t acquireStudentOrdinal(void);
+void releaseStudentOrdinal(uint32_t ordinal);
+
+/* --- Columns --- */
+// Returns the columns for 'subject', creating them when 'create' is set.
+// NULL if there are none (or memory ran out creating them).
+MarkColumns* markColumnsFor(SymbolId subject, int create);
+
+// Stores a mark (or MARK_MISSING) for one student. Returns 0 if the column
+// could not grow.
+int setColumnMark(MarkColumns* columns, int component, uint32_t ordinal, int32_t value);
+
+// One student's mark, or MARK_MISSING (also for NULL columns).
+int32_t columnMark(const MarkColumns* columns, int component, uint32_t ordinal);
+
+// Computes count, mean, median, spread and a histogram over [0, maxMark].
+// Returns 0 if no student has a mark in that column.
+int computeMarkStats(SymbolId subject, int component, int32_t maxMark, MarkStats* stats);
+
+// Drops every column and ordinal. Only safe once no student is left.
+void releaseMarkColumns(void);
+
+#endif // MARK_COLUMNS_H
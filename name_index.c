@@ -0,0 +1,281 @@
+#include "name_index.h"
+#include "key_index.h"
+#include "report_writer.h"
+#include "op_stats.h"
+#include "tree_cursor.h"
+#include <ctype.h>
+#include <pthread.h>
+
+#define NAME_GRAM 3
+#define NAME_START '\x02' // Marks the start of a name, so prefixes are pieces too
+#define NAME_END '\x03'
+#define NAME_PADDED 104   // A name (up to 99 characters) plus both markers
+
+// The students whose name contains one piece: an open-addressing set of
+// node pointers, so a rename or delete takes its entry out in O(1).
+typedef struct {
+    char gram[NAME_GRAM + 1];
+    StudentNode** slots; // NULL: the slot is empty
+    size_t capacity;     // 0 or a power of two
+    size_t count;
+} GramSet;
+
+static KeyIndex gramSets = KEY_INDEX_INIT; // Piece -> GramSet
+static int namesBuilt = 0;                 // Nothing is indexed until the first search
+static int namesPartial = 0;               // Set once an allocation failed
+static pthread_mutex_t buildLock = PTHREAD_MUTEX_INITIALIZER; // Searches may run side by side (see server.h)
+
+// --- Student Sets ---
+
+static size_t homeSlot(const StudentNode* student, size_t capacity) {
+    uint64_t hash = (uint64_t)(uintptr_t)student * 0x9E3779B97F4A7C15ull;
+    return (size_t)(hash >> 32) & (capacity - 1);
+}
+
+static StudentNode** findSlot(StudentNode** slots, size_t capacity, const StudentNode* student) {
+    size_t mask = capacity - 1;
+    for (size_t pos = homeSlot(student, capacity);; pos = (pos + 1) & mask) {
+        if (slots[pos] == NULL || slots[pos] == student) return &slots[pos];
+    }
+}
+
+static int setAdd(GramSet* set, StudentNode* student) {
+    if ((set->count + 1) * 4 > set->capacity * 3) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 8;
+        StudentNode** slots = (StudentNode**)calloc(capacity, sizeof(StudentNode*));
+        if (slots == NULL) return 0;
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->slots[i] != NULL) *findSlot(slots, capacity, set->slots[i]) = set->slots[i];
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->capacity = capacity;
+    }
+    StudentNode** slot = findSlot(set->slots, set->capacity, student);
+    if (*slot == NULL) {
+        *slot = student;
+        set->count++;
+    }
+    return 1;
+}
+
+static void setRemove(GramSet* set, const StudentNode* student) {
+    if (set->count == 0) return;
+    size_t mask = set->capacity - 1;
+    StudentNode** slot = findSlot(set->slots, set->capacity, student);
+    if (*slot == NULL) return;
+
+    // Backward-shift deletion, as in key_index.c.
+    size_t hole = (size_t)(slot - set->slots);
+    for (size_t pos = (hole + 1) & mask; set->slots[pos] != NULL; pos = (pos + 1) & mask) {
+        size_t home = homeSlot(set->slots[pos], set->capacity);
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            set->slots[hole] = set->slots[pos];
+            hole = pos;
+        }
+    }
+    set->slots[hole] = NULL;
+    set->count--;
+}
+
+// --- Pieces ---
+
+static void lowerInto(char* out, const char* text, size_t length) {
+    for (size_t i = 0; i < length; i++) out[i] = (char)tolower((unsigned char)text[i]);
+    out[length] = '\0';
+}
+
+// Writes "<start>name<end>" in lower case. Returns its length.
+static size_t padName(const char* name, char* padded) {
+    size_t length = strlen(name);
+    padded[0] = NAME_START;
+    lowerInto(padded + 1, name, length);
+    padded[length + 1] = NAME_END;
+    padded[length + 2] = '\0';
+    return length + 2;
+}
+
+static GramSet* gramSet(const char* text, size_t length, int create) {
+    char gram[NAME_GRAM + 1];
+    memcpy(gram, text, length);
+    gram[length] = '\0';
+    GramSet* set = (GramSet*)keyIndexGet(&gramSets, gram);
+    if (set != NULL || !create) return set;
+
+    set = (GramSet*)calloc(1, sizeof(GramSet));
+    if (set == NULL) return NULL;
+    memcpy(set->gram, gram, length + 1);
+    if (!keyIndexPut(&gramSets, set->gram, set)) {
+        free(set);
+        return NULL;
+    }
+    return set;
+}
+
+static void addPiece(const char* text, size_t length, StudentNode* student) {
+    GramSet* set = gramSet(text, length, 1);
+    if (set == NULL || !setAdd(set, student)) namesPartial = 1;
+}
+
+static void removePiece(const char* text, size_t length, const StudentNode* student) {
+    GramSet* set = gramSet(text, length, 0);
+    if (set != NULL) setRemove(set, student);
+}
+
+void indexStudentName(StudentNode* student) {
+    if (!namesBuilt) return;
+    char padded[NAME_PADDED];
+    size_t length = padName(student->name, padded);
+    addPiece(padded, 2, student); // The one-letter prefix
+    for (size_t i = 0; i + NAME_GRAM <= length; i++) addPiece(padded + i, NAME_GRAM, student);
+}
+
+void unindexStudentName(StudentNode* student) {
+    if (!namesBuilt || gramSets.count == 0) return;
+    char padded[NAME_PADDED];
+    size_t length = padName(student->name, padded);
+    removePiece(padded, 2, student);
+    for (size_t i = 0; i + NAME_GRAM <= length; i++) removePiece(padded + i, NAME_GRAM, student);
+}
+
+void releaseNameIndex(void) {
+    for (size_t i = 0; i < gramSets.capacity; i++) {
+        GramSet* set = (GramSet*)gramSets.slots[i].value;
+        if (set == NULL) continue;
+        free(set->slots);
+        free(set);
+    }
+    keyIndexFree(&gramSets);
+    namesBuilt = 0;
+    namesPartial = 0;
+}
+
+// --- Searching ---
+
+typedef struct {
+    const char* query; // Lower case
+    size_t queryLength;
+    NameMatch match;
+    StudentNode** items;
+    size_t count;
+    size_t capacity;
+    int failed;
+} MatchList;
+
+static int nameMatches(const char* name, const MatchList* list) {
+    char lowered[NAME_PADDED];
+    size_t length = strlen(name);
+    if (length < list->queryLength) return 0;
+    lowerInto(lowered, name, length);
+    if (list->match == NAME_PREFIX) return strncmp(lowered, list->query, list->queryLength) == 0;
+    return strstr(lowered, list->query) != NULL;
+}
+
+static void addMatch(MatchList* list, StudentNode* student) {
+    if (list->failed || !nameMatches(student->name, list)) return;
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        StudentNode** grown = (StudentNode**)realloc(list->items, capacity * sizeof(StudentNode*));
+        if (grown == NULL) {
+            list->failed = 1;
+            return;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = student;
+}
+
+static void scanTree(StudentNode* root, MatchList* list) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) addMatch(list, student);
+    closeCursor(&cursor);
+}
+
+static void indexTree(StudentNode* root) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) indexStudentName(student);
+    closeCursor(&cursor);
+}
+
+static int compareSRN(const void* a, const void* b) {
+    return strcmp((*(StudentNode* const*)a)->studentSRN, (*(StudentNode* const*)b)->studentSRN);
+}
+
+// The smallest set among the pattern's pieces, or NULL if a piece is in no
+// name at all (nothing can match).
+static GramSet* rarestSet(const char* pattern, size_t length) {
+    if (length == 2) return gramSet(pattern, 2, 0);
+    GramSet* rarest = NULL;
+    for (size_t i = 0; i + NAME_GRAM <= length; i++) {
+        GramSet* set = gramSet(pattern + i, NAME_GRAM, 0);
+        if (set == NULL || set->count == 0) return NULL;
+        if (rarest == NULL || set->count < rarest->count) rarest = set;
+    }
+    return rarest;
+}
+
+int searchStudentNames(StudentNode* root, const char* query, NameMatch match, StudentNode*** matches, size_t* count) {
+    *matches = NULL;
+    *count = 0;
+    size_t queryLength = strlen(query);
+    if (queryLength >= sizeof(root->name)) return 1; // Longer than any name
+    uint64_t started = STAT_START();
+
+    char pattern[NAME_PADDED];
+    pattern[0] = NAME_START;
+    lowerInto(pattern + 1, query, queryLength);
+    MatchList list = { pattern + 1, queryLength, match, NULL, 0, 0, 0 };
+    // A prefix query is a piece that starts with the start marker.
+    const char* piece = (match == NAME_PREFIX) ? pattern : pattern + 1;
+    size_t pieceLength = (match == NAME_PREFIX) ? queryLength + 1 : queryLength;
+
+    pthread_mutex_lock(&buildLock);
+    if (!namesBuilt) {
+        namesBuilt = 1;
+        indexTree(root);
+    }
+    pthread_mutex_unlock(&buildLock);
+
+    if (namesPartial || pieceLength < 2 || (pieceLength == 2 && match != NAME_PREFIX)) {
+        scanTree(root, &list); // Already in SRN order
+    } else {
+        GramSet* set = rarestSet(piece, pieceLength);
+        for (size_t i = 0; set != NULL && i < set->capacity; i++) {
+            if (set->slots[i] != NULL) addMatch(&list, set->slots[i]);
+        }
+        if (list.count > 1) qsort(list.items, list.count, sizeof(StudentNode*), compareSRN);
+    }
+
+    STAT_STOP(STAT_NAME_SEARCH, started, 0);
+    if (list.failed) {
+        free(list.items);
+        return 0;
+    }
+    *matches = list.items;
+    *count = list.count;
+    return 1;
+}
+
+void listMatchingStudents(StudentNode* root, const char* query, NameMatch match) {
+    StudentNode** matches;
+    size_t count;
+    if (!searchStudentNames(root, query, match, &matches, &count)) {
+        printf("Error: Out of memory searching names.\n");
+        return;
+    }
+    if (count == 0) {
+        printf("No student's name %s '%s'.\n", match == NAME_PREFIX ? "starts with" : "contains", query);
+    } else {
+        ReportWriter writer;
+        reportOpen(&writer, REPORT_FORMAT_TEXT, REPORT_STUDENT_LIST, stdout);
+        for (size_t i = 0; i < count; i++) reportStudent(&writer, matches[i]);
+        reportClose(&writer);
+        printf("%zu student(s) found.\n", count);
+    }
+    free(matches);
+}
@@ -0,0 +1,42 @@
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include "student_tracker.h"
+
+// --- Name Search Index ---
+//
+// Finds students by part of their name, ignoring case. Every name linked
+// into the student tree is broken into trigrams (three-character pieces)
+// of "<start>name<end>", with markers at both ends so a prefix is just a
+// piece that starts with the start marker; the start marker plus the first
+// letter is indexed too, so one-letter prefixes need no scan. Each piece
+// keeps the set of students whose name contains it.
+//
+// A search checks only the students in the smallest set among the query's
+// pieces, so its cost follows the number of near matches rather than the
+// size of the cohort. Substring queries shorter than a trigram (and any
+// search after the index ran out of memory) walk the tree instead.
+//
+// The index is built from the tree by the first search, so loading stays
+// as fast as before for sessions that never search; from then on
+// student_tracker.c keeps it in step wherever it keeps the SRN index (see
+// key_index.h), and on renames.
+
+typedef enum {
+    NAME_PREFIX,   // The name starts with the query
+    NAME_CONTAINS  // The query appears anywhere in the name
+} NameMatch;
+
+void indexStudentName(StudentNode* student);
+void unindexStudentName(StudentNode* student);
+void releaseNameIndex(void);
+
+// Collects the students whose name matches, sorted by SRN, into a malloc'd
+// array the caller frees. 'root' is the main student tree, only walked when
+// the index cannot answer. Returns 0 if memory ran out.
+int searchStudentNames(StudentNode* root, const char* query, NameMatch match, StudentNode*** matches, size_t* count);
+
+// Prints the matches like listAllStudents, or says that nothing matched.
+void listMatchingStudents(StudentNode* root, const char* query, NameMatch match);
+
+#endif // NAME_INDEX_H
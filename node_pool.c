@@ -0,0 +1,55 @@
+#include "node_pool.h"
+#include <stdlib.h>
+
+#define LINK_OF(pool, node) (*(void**)((char*)(node) + (pool)->linkOffset))
+
+static int poolGrow(NodePool* pool) {
+    size_t nodes = (NODE_POOL_SLAB_BYTES - sizeof(PoolSlab)) / pool->nodeSize;
+    if (nodes == 0) nodes = 1;
+    PoolSlab* slab = (PoolSlab*)malloc(sizeof(PoolSlab) + nodes * pool->nodeSize);
+    if (slab == NULL) return 0;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->bumpNext = (char*)(slab + 1);
+    pool->bumpEnd = pool->bumpNext + nodes * pool->nodeSize;
+    pool->slabCount++;
+    return 1;
+}
+
+void* poolAlloc(NodePool* pool) {
+    void* node = pool->freeList;
+    if (node != NULL) {
+        pool->freeList = LINK_OF(pool, node);
+    } else {
+        if (pool->bumpNext == pool->bumpEnd && !poolGrow(pool)) return NULL;
+        node = pool->bumpNext;
+        pool->bumpNext += pool->nodeSize;
+    }
+    return node;
+}
+
+void poolFree(NodePool* pool, void* node) {
+    if (node == NULL) return;
+    LINK_OF(pool, node) = pool->freeList;
+    pool->freeList = node;
+}
+
+void poolFreeChain(NodePool* pool, void* first, void* last) {
+    if (first == NULL) return;
+    LINK_OF(pool, last) = pool->freeList;
+    pool->freeList = first;
+}
+
+void poolReleaseAll(NodePool* pool) {
+    PoolSlab* slab = pool->slabs;
+    while (slab != NULL) {
+        PoolSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->bumpNext = NULL;
+    pool->bumpEnd = NULL;
+    pool->freeList = NULL;
+    pool->slabCount = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <stddef.h>
+
+// --- Fixed-Size Node Pools ---
+//
+// Nodes are carved out of large slabs instead of being malloc'd one at a
+// time. Freed nodes go onto a free list threaded through one of their own
+// pointer fields (linkOffset), so a linked list that already uses that field
+// (e.g. a student's history) can be handed back in one step with
+// poolFreeChain. poolReleaseAll returns every slab at once.
+
+#define NODE_POOL_SLAB_BYTES (256 * 1024)
+
+typedef struct PoolSlab {
+    struct PoolSlab* next;
+    size_t reserved;  // Keeps the nodes that follow 16-byte aligned
+} PoolSlab;
+
+typedef struct {
+    size_t nodeSize;
+    size_t linkOffset;   // Offset of the pointer field used as the free-list link
+    PoolSlab* slabs;
+    char* bumpNext;      // Unused tail of the newest slab
+    char* bumpEnd;
+    void* freeList;
+    size_t slabCount;
+} NodePool;
+
+#define NODE_POOL_INIT(type, linkField) { sizeof(type), offsetof(type, linkField), NULL, NULL, NULL, NULL, 0 }
+
+// Returns uninitialised storage for one node, or NULL if memory runs out.
+void* poolAlloc(NodePool* pool);
+
+// Returns one node to the free list.
+void poolFree(NodePool* pool, void* node);
+
+// Returns nodes that are already linked first -> ... -> last through the
+// pool's link field. Only 'last' is written, so this is O(1).
+void poolFreeChain(NodePool* pool, void* first, void* last);
+
+// Frees every slab. All nodes ever handed out by the pool become invalid.
+void poolReleaseAll(NodePool* pool);
+
+#endif // NODE_POOL_H
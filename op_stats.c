@@ -0,0 +1,195 @@
+#include "op_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STAT_SUB_BITS 3                       // 8 buckets per power of two
+#define STAT_SUB_BUCKETS (1 << STAT_SUB_BITS)
+#define STAT_MAX_EXPONENT 40                  // Anything from 2^40 ns (18 minutes) up shares the last bucket
+#define STAT_BUCKETS ((STAT_MAX_EXPONENT - STAT_SUB_BITS + 1) * STAT_SUB_BUCKETS)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define atomicAdd(target, value) __atomic_fetch_add((target), (value), __ATOMIC_RELAXED)
+#define atomicLoad(target) __atomic_load_n((target), __ATOMIC_RELAXED)
+#define atomicStore(target, value) __atomic_store_n((target), (value), __ATOMIC_RELAXED)
+#define leadingZeros64(x) __builtin_clzll(x)
+static void atomicMax(uint64_t* target, uint64_t value) {
+    uint64_t seen = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(target, &seen, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+#else
+#define atomicAdd(target, value) (*(target) += (value))
+#define atomicLoad(target) (*(target))
+#define atomicStore(target, value) (*(target) = (value))
+static int leadingZeros64(uint64_t x) {
+    int zeros = 0;
+    while (!(x & 0x8000000000000000ull)) {
+        x <<= 1;
+        zeros++;
+    }
+    return zeros;
+}
+static void atomicMax(uint64_t* target, uint64_t value) {
+    if (value > *target) *target = value;
+}
+#endif
+
+typedef struct {
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t bytes;
+    uint64_t buckets[STAT_BUCKETS];
+} OpStats;
+
+static OpStats opStats[STAT_OP_COUNT];
+int statsEnabled = 0;
+
+static const char* opNames[STAT_OP_COUNT] = {
+    "loadData", "saveData", "journal write", "journal sync", "login",
+    "findStudent", "lookupStudent", "lookupTeacher", "addStudent", "deleteStudent",
+    "renameStudent", "changeStudentSRN", "addPerformanceRecord", "updateMark", "recordRollCall",
+    "listAllStudents", "generateSubjectReport", "generateMasterReport", "generateClassStatsReport", "searchStudentNames",
+    "rekeyStudents", "faultInHistory",
+    "menu  1 Add Student", "menu  2 List Students", "menu  3 Delete Student", "menu  4 Modify Name",
+    "menu  5 Modify SRN", "menu  6 Modify Mark", "menu  7 Attendance", "menu  8 Internal 1",
+    "menu  9 Assignment 1", "menu 10 Internal 2", "menu 11 Assignment 2", "menu 12 Semester Exam",
+    "menu 13 Subject Report", "menu 14 Master Report", "menu 15 Logout", "menu 16 Class Stats",
+    "menu 17 Cohort Reports", "menu 18 Name Search", "menu 19 Show Stats", "menu 20 Bulk Re-key"
+};
+
+// --- Recording ---
+
+void initStats(void) {
+    const char* env = getenv("TRACKER_STATS");
+    setStatsEnabled(env != NULL && env[0] != '\0' && strcmp(env, "0") != 0);
+}
+
+void setStatsEnabled(int enabled) {
+#ifdef TRACKER_NO_STATS
+    (void)enabled;
+#else
+    atomicStore(&statsEnabled, enabled);
+#endif
+}
+
+void resetStats(void) {
+    for (int op = 0; op < STAT_OP_COUNT; op++) {
+        OpStats* stats = &opStats[op];
+        atomicStore(&stats->calls, 0);
+        atomicStore(&stats->totalNs, 0);
+        atomicStore(&stats->maxNs, 0);
+        atomicStore(&stats->bytes, 0);
+        for (int b = 0; b < STAT_BUCKETS; b++) atomicStore(&stats->buckets[b], 0);
+    }
+}
+
+uint64_t statClock(void) {
+    struct timespec ts;
+#ifdef _WIN32
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec + 1; // +1: 0 means "not timed"
+}
+
+// Values below 8 get a bucket each; above that, the top three bits after
+// the leading one pick one of 8 buckets within its power of two.
+static int bucketOf(uint64_t ns) {
+    if (ns < STAT_SUB_BUCKETS) return (int)ns;
+    int exponent = 63 - leadingZeros64(ns);
+    if (exponent >= STAT_MAX_EXPONENT) return STAT_BUCKETS - 1;
+    int sub = (int)((ns >> (exponent - STAT_SUB_BITS)) & (STAT_SUB_BUCKETS - 1));
+    return (exponent - STAT_SUB_BITS + 1) * STAT_SUB_BUCKETS + sub;
+}
+
+// The largest value that falls in 'bucket'.
+static uint64_t bucketLimit(int bucket) {
+    if (bucket < STAT_SUB_BUCKETS) return (uint64_t)bucket;
+    int exponent = bucket / STAT_SUB_BUCKETS + STAT_SUB_BITS - 1;
+    uint64_t width = (uint64_t)1 << (exponent - STAT_SUB_BITS);
+    uint64_t low = (uint64_t)(STAT_SUB_BUCKETS + bucket % STAT_SUB_BUCKETS) << (exponent - STAT_SUB_BITS);
+    return low + width - 1;
+}
+
+void statRecord(StatOp op, uint64_t started, uint64_t bytes) {
+    if ((int)op < 0 || op >= STAT_OP_COUNT) return;
+    uint64_t now = statClock();
+    uint64_t elapsed = now > started ? now - started : 0;
+    OpStats* stats = &opStats[op];
+    atomicAdd(&stats->calls, 1);
+    atomicAdd(&stats->totalNs, elapsed);
+    atomicAdd(&stats->bytes, bytes);
+    atomicAdd(&stats->buckets[bucketOf(elapsed)], 1);
+    atomicMax(&stats->maxNs, elapsed);
+}
+
+StatOp statMenuAction(int choice) {
+    if (choice < 1 || choice > STAT_MENU_CHOICES) return STAT_OP_COUNT;
+    return (StatOp)(STAT_MENU_ACTION + choice - 1);
+}
+
+// --- Output ---
+
+// The smallest bucket limit at or above fraction 'q' of the calls, capped
+// at the exact maximum.
+static uint64_t percentile(const OpStats* stats, uint64_t calls, double q) {
+    uint64_t rank = (uint64_t)(q * (double)calls + 0.999999);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0, maxNs = atomicLoad(&stats->maxNs);
+    for (int b = 0; b < STAT_BUCKETS; b++) {
+        seen += atomicLoad(&stats->buckets[b]);
+        if (seen >= rank) {
+            uint64_t limit = bucketLimit(b);
+            return limit < maxNs ? limit : maxNs;
+        }
+    }
+    return maxNs;
+}
+
+static void formatDuration(char* out, size_t size, uint64_t ns) {
+    if (ns < 1000) snprintf(out, size, "%lluns", (unsigned long long)ns);
+    else if (ns < 1000000) snprintf(out, size, "%.1fus", ns / 1e3);
+    else if (ns < 1000000000) snprintf(out, size, "%.2fms", ns / 1e6);
+    else snprintf(out, size, "%.2fs", ns / 1e9);
+}
+
+static void formatBytes(char* out, size_t size, uint64_t bytes) {
+    if (bytes == 0) snprintf(out, size, "-");
+    else if (bytes < 1024) snprintf(out, size, "%lluB", (unsigned long long)bytes);
+    else if (bytes < 1024 * 1024) snprintf(out, size, "%.1fKB", bytes / 1024.0);
+    else if (bytes < 1024ull * 1024 * 1024) snprintf(out, size, "%.1fMB", bytes / (1024.0 * 1024));
+    else snprintf(out, size, "%.2fGB", bytes / (1024.0 * 1024 * 1024));
+}
+
+void printStats(FILE* fp) {
+    char total[16], p50[16], p99[16], maxText[16], bytes[16];
+    int shown = 0;
+    fprintf(fp, "\n==========================================================================================\n");
+    fprintf(fp, "                                  OPERATION STATISTICS\n");
+    fprintf(fp, "==========================================================================================\n");
+    fprintf(fp, "%-26s %10s %10s %10s %10s %10s %10s\n", "Operation", "Calls", "Total", "p50", "p99", "Max", "Bytes");
+    fprintf(fp, "------------------------------------------------------------------------------------------\n");
+    for (int op = 0; op < STAT_OP_COUNT; op++) {
+        const OpStats* stats = &opStats[op];
+        uint64_t calls = atomicLoad(&stats->calls);
+        if (calls == 0) continue;
+        formatDuration(total, sizeof(total), atomicLoad(&stats->totalNs));
+        formatDuration(p50, sizeof(p50), percentile(stats, calls, 0.50));
+        formatDuration(p99, sizeof(p99), percentile(stats, calls, 0.99));
+        formatDuration(maxText, sizeof(maxText), atomicLoad(&stats->maxNs));
+        formatBytes(bytes, sizeof(bytes), atomicLoad(&stats->bytes));
+        fprintf(fp, "%-26s %10llu %10s %10s %10s %10s %10s\n", opNames[op], (unsigned long long)calls,
+                total, p50, p99, maxText, bytes);
+        shown++;
+    }
+    if (shown == 0) fprintf(fp, "Nothing recorded yet.\n");
+#ifdef TRACKER_NO_STATS
+    fprintf(fp, "Statistics were left out of this build (TRACKER_NO_STATS).\n");
+#else
+    if (!statsOn()) fprintf(fp, "Statistics are off (set TRACKER_STATS=1 to record from startup).\n");
+#endif
+    fprintf(fp, "==========================================================================================\n");
+}
@@ -0,0 +1,81 @@
+#ifndef OP_STATS_H
+#define OP_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// --- Operation Statistics ---
+//
+// Call counts, bytes moved and latency histograms for the hot paths in
+// student_tracker.c (and the journal), plus one entry per main menu action.
+// Each histogram has 8 buckets per power of two of nanoseconds, so p50 and
+// p99 are within 12.5%; the max is exact. Counters are updated atomically,
+// so the server's workers and the cohort threads can all record.
+//
+// Statistics are off unless TRACKER_STATS is set in the environment (to
+// anything but "0"), or they are turned on from the menu or with the
+// "perf|on" command. While off, an instrumented call costs one load and a
+// branch. Building with TRACKER_NO_STATS defined removes even that.
+//
+// Menu actions are timed from the choice to the end of the action, so they
+// include the time spent answering its prompts.
+
+typedef enum {
+    STAT_LOAD_DATA,        // Bytes: size of the file loaded
+    STAT_SAVE_DATA,        // Bytes: written to the save file
+    STAT_JOURNAL_WRITE,    // Bytes: appended to the journal
+    STAT_JOURNAL_SYNC,
+    STAT_LOGIN,
+    STAT_FIND_STUDENT,     // Tree walk
+    STAT_LOOKUP_STUDENT,   // Hash index
+    STAT_LOOKUP_TEACHER,
+    STAT_ADD_STUDENT,
+    STAT_DELETE_STUDENT,
+    STAT_RENAME_STUDENT,
+    STAT_CHANGE_SRN,
+    STAT_ADD_RECORD,
+    STAT_UPDATE_MARK,
+    STAT_ROLL_CALL,
+    STAT_LIST_STUDENTS,    // Bytes: report output
+    STAT_SUBJECT_REPORT,   // Bytes: report output
+    STAT_MASTER_REPORT,    // Bytes: report output
+    STAT_CLASS_STATS,
+    STAT_NAME_SEARCH,
+    STAT_REKEY_STUDENTS,
+    STAT_FAULT_IN,         // Bytes: compressed block bytes read
+    STAT_MENU_ACTION,      // Menu choice N is STAT_MENU_ACTION + N - 1
+    STAT_OP_COUNT = STAT_MENU_ACTION + 20
+} StatOp;
+
+#define STAT_MENU_CHOICES (STAT_OP_COUNT - STAT_MENU_ACTION)
+
+#ifdef TRACKER_NO_STATS
+#define STAT_START() ((uint64_t)0)
+#define STAT_STOP(op, started, bytes) ((void)(op), (void)(started), (void)(bytes))
+#define statsOn() 0
+#else
+extern int statsEnabled;
+#if defined(__GNUC__) || defined(__clang__)
+#define statsOn() (__atomic_load_n(&statsEnabled, __ATOMIC_RELAXED) != 0)
+#else
+#define statsOn() (statsEnabled != 0)
+#endif
+// Taken at the start of an operation; 0 while statistics are off.
+#define STAT_START() (statsOn() ? statClock() : (uint64_t)0)
+#define STAT_STOP(op, started, bytes) do { if (started) statRecord((op), (started), (bytes)); } while (0)
+#endif
+
+void initStats(void);             // Reads TRACKER_STATS
+void setStatsEnabled(int enabled);
+void resetStats(void);
+
+uint64_t statClock(void);         // Monotonic nanoseconds, never 0
+// Adds one call of 'op' that began at 'started' (a statClock() value).
+void statRecord(StatOp op, uint64_t started, uint64_t bytes);
+StatOp statMenuAction(int choice); // STAT_OP_COUNT (never recorded) if not a menu choice
+
+// Prints a table of every operation called so far: calls, total time,
+// p50, p99, max and bytes.
+void printStats(FILE* fp);
+
+#endif // OP_STATS_H
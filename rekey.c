@@ -0,0 +1,126 @@
+#include "rekey.h"
+#include "tree_cursor.h"
+
+#define REKEY_LINE_SIZE 256
+#define SRN_SIZE sizeof(((SRNChange*)0)->oldSRN)
+
+// --- Building Change Lists ---
+
+static SRNChange* addChange(SRNChangeList* list) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        SRNChange* grown = (SRNChange*)realloc(list->items, capacity * sizeof(SRNChange));
+        if (grown == NULL) {
+            printf("Error: Memory allocation failed!\n");
+            return NULL;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    return &list->items[list->count++];
+}
+
+int readRekeyFile(const char* path, SRNChangeList* list) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        printf("Error: Could not open mapping file %s.\n", path);
+        return 0;
+    }
+    char line[REKEY_LINE_SIZE];
+    unsigned long number = 0;
+    int ok = 1;
+    while (ok && fgets(line, sizeof(line), fp) != NULL) {
+        number++;
+        if (strchr(line, '\n') == NULL && !feof(fp)) {
+            printf("Error: Line %lu of %s is too long.\n", number, path);
+            ok = 0;
+            continue;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        char* oldSRN = strtok(line, " \t,|");
+        if (oldSRN == NULL || oldSRN[0] == '#') continue;
+        char* newSRN = strtok(NULL, " \t,|");
+        SRNChange* change;
+        if (newSRN == NULL || strtok(NULL, " \t,|") != NULL) {
+            printf("Error: Line %lu of %s: expected an old and a new SRN.\n", number, path);
+            ok = 0;
+        } else if (strlen(oldSRN) >= SRN_SIZE || strlen(newSRN) >= SRN_SIZE) {
+            printf("Error: Line %lu of %s: SRNs are at most %lu characters.\n", number, path, (unsigned long)(SRN_SIZE - 1));
+            ok = 0;
+        } else if ((change = addChange(list)) == NULL) {
+            ok = 0;
+        } else {
+            strcpy(change->oldSRN, oldSRN);
+            strcpy(change->newSRN, newSRN);
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+// The matching SRNs are one contiguous run of the tree, so the cursor
+// starts at the prefix and stops at the first SRN past it.
+int collectPrefixRekey(StudentNode* root, const char* oldPrefix, const char* newPrefix, SRNChangeList* list) {
+    size_t oldLength = strlen(oldPrefix), newLength = strlen(newPrefix);
+    if (oldLength == 0) {
+        printf("Error: The old prefix may not be empty.\n");
+        return 0;
+    }
+    TreeCursor cursor;
+    StudentNode* student;
+    int ok = 1;
+    seekStudentCursor(&cursor, root, oldPrefix);
+    while (ok && (student = nextStudent(&cursor)) != NULL && strncmp(student->studentSRN, oldPrefix, oldLength) == 0) {
+        const char* rest = student->studentSRN + oldLength;
+        SRNChange* change;
+        if (newLength + strlen(rest) >= SRN_SIZE) {
+            printf("Error: %s would be longer than %lu characters as %s%s.\n", student->studentSRN,
+                   (unsigned long)(SRN_SIZE - 1), newPrefix, rest);
+            ok = 0;
+        } else if ((change = addChange(list)) == NULL) {
+            ok = 0;
+        } else {
+            strcpy(change->oldSRN, student->studentSRN);
+            strcpy(change->newSRN, newPrefix);
+            strcat(change->newSRN, rest);
+        }
+    }
+    closeCursor(&cursor);
+    return ok;
+}
+
+void freeSRNChanges(SRNChangeList* list) {
+    free(list->items);
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// --- Applying ---
+
+static size_t applyChanges(StudentNode** studentRoot, SRNChangeList* list, const char* source) {
+    size_t rekeyed = 0;
+    if (list->count == 0) {
+        printf("No SRNs to change in %s.\n", source);
+        return 0;
+    }
+    *studentRoot = rekeyStudents(*studentRoot, list->items, list->count, &rekeyed);
+    if (rekeyed > 0) printf("Re-keyed %lu student(s) from %s.\n", (unsigned long)rekeyed, source);
+    return rekeyed;
+}
+
+size_t rekeyFromFile(StudentNode** studentRoot, const char* path) {
+    SRNChangeList list = { NULL, 0, 0 };
+    size_t rekeyed = readRekeyFile(path, &list) ? applyChanges(studentRoot, &list, path) : 0;
+    freeSRNChanges(&list);
+    return rekeyed;
+}
+
+size_t rekeyByPrefix(StudentNode** studentRoot, const char* oldPrefix, const char* newPrefix) {
+    SRNChangeList list = { NULL, 0, 0 };
+    char source[REKEY_LINE_SIZE];
+    snprintf(source, sizeof(source), "prefix %s -> %s", oldPrefix, newPrefix);
+    size_t rekeyed = collectPrefixRekey(*studentRoot, oldPrefix, newPrefix, &list) ? applyChanges(studentRoot, &list, source) : 0;
+    freeSRNChanges(&list);
+    return rekeyed;
+}
@@ -0,0 +1,39 @@
+#ifndef REKEY_H
+#define REKEY_H
+
+#include "student_tracker.h"
+
+// --- Bulk SRN Re-keying ---
+//
+// Renumbers a batch of students at once, such as a PES1UG22 -> PES2UG22
+// migration, through rekeyStudents (student_tracker.h): every change is
+// checked first, then the tree is relinked once instead of detaching and
+// re-inserting each student. The changes come from either
+//
+//   a mapping file   one "OLD NEW" pair per line, separated by spaces, tabs,
+//                    a comma or '|'; blank lines and lines starting with '#'
+//                    are skipped
+//   a prefix rule    every SRN that starts with the old prefix gets the new
+//                    prefix in its place
+//
+// Swaps and chains (A -> B while B -> C) are fine: only the SRNs of students
+// that keep theirs are off limits.
+
+typedef struct {
+    SRNChange* items;
+    size_t count;
+    size_t capacity;
+} SRNChangeList;
+
+// Append to 'list'. Return 0 with the problem printed on a bad line, an SRN
+// that would not fit, or a failed allocation.
+int readRekeyFile(const char* path, SRNChangeList* list);
+int collectPrefixRekey(StudentNode* root, const char* oldPrefix, const char* newPrefix, SRNChangeList* list);
+void freeSRNChanges(SRNChangeList* list);
+
+// Build the changes, apply them to the main tree and print the outcome.
+// Return the number of students re-keyed (0 if nothing was changed).
+size_t rekeyFromFile(StudentNode** studentRoot, const char* path);
+size_t rekeyByPrefix(StudentNode** studentRoot, const char* oldPrefix, const char* newPrefix);
+
+#endif // REKEY_H
@@ -0,0 +1,434 @@
+#include "report_writer.h"
+#include "block_store.h"
+#include "tree_cursor.h"
+#include "history.h"
+#include <string.h>
+
+#define REPORT_RULE  "============================================\n"
+#define REPORT_LINE  "--------------------------------------------\n"
+
+static const char* csvColumns[] = {
+    "srn,name\n",
+    "srn,name,subject,internal_1,assignment_1,internal_2,assignment_2,semester_exam,"
+    "cie_total,semester_scaled,final,attendance_present,attendance_sessions,attendance_percent,"
+    "class_attendance_percent\n",
+    "srn,name,subject,description,type,value,max_value\n",
+};
+
+// JSON keys of the mark components, in RecordType order.
+static const char* componentKeys[MARK_COMPONENTS] = {
+    "internal_1", "assignment_1", "internal_2", "assignment_2", "semester_exam"
+};
+
+static double attendancePercent(AttendanceTally tally) {
+    return tally.sessions ? 100.0 * tally.present / tally.sessions : 0.0;
+}
+
+// --- Output ---
+
+static void flushText(ReportWriter* writer) {
+    if (writer->fp == NULL) return;
+    writer->written += writer->text.size;
+    if (!textWrite(&writer->text, writer->fp)) writer->failed = 1;
+    textReset(&writer->text);
+}
+
+// Called after every entry: the buffer is written in large pieces only.
+static void entryDone(ReportWriter* writer) {
+    writer->entries++;
+    if (writer->text.size >= REPORT_FLUSH_BYTES) flushText(writer);
+}
+
+void reportOpen(ReportWriter* writer, ReportFormat format, ReportKind kind, FILE* fp) {
+    TextBuffer empty = TEXT_BUFFER_INIT;
+    writer->format = format;
+    writer->kind = kind;
+    writer->text = empty;
+    writer->fp = fp;
+    writer->entries = 0;
+    writer->written = 0;
+    writer->failed = 0;
+}
+
+void reportBegin(ReportWriter* writer) {
+    if (writer->format == REPORT_FORMAT_CSV) {
+        const char* columns = csvColumns[writer->kind == REPORT_COHORT ? REPORT_SUBJECT : writer->kind];
+        textAppend(&writer->text, columns, strlen(columns));
+    } else if (writer->format == REPORT_FORMAT_JSON) {
+        textAppend(&writer->text, "[\n", 2);
+    }
+}
+
+int reportEnd(ReportWriter* writer) {
+    if (writer->format == REPORT_FORMAT_JSON) {
+        textPrintf(&writer->text, "%s]\n", writer->entries ? "\n" : "");
+    }
+    flushText(writer);
+    return !writer->failed && !writer->text.failed;
+}
+
+int reportClose(ReportWriter* writer) {
+    flushText(writer);
+    int ok = !writer->failed && !writer->text.failed;
+    textFree(&writer->text);
+    return ok;
+}
+
+// --- Field Encoding ---
+
+// Quotes a CSV field only when it has to be (comma, quote or line break).
+static void csvField(TextBuffer* out, const char* text) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        textAppend(out, text, strlen(text));
+        return;
+    }
+    textAppend(out, "\"", 1);
+    for (const char* quote; (quote = strchr(text, '"')) != NULL; text = quote + 1) {
+        textAppend(out, text, (size_t)(quote - text + 1));
+        textAppend(out, "\"", 1);
+    }
+    textAppend(out, text, strlen(text));
+    textAppend(out, "\"", 1);
+}
+
+static void jsonString(TextBuffer* out, const char* text) {
+    textAppend(out, "\"", 1);
+    const char* run = text;
+    for (; *text != '\0'; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        textAppend(out, run, (size_t)(text - run));
+        if (c == '"' || c == '\\') textPrintf(out, "\\%c", c);
+        else textPrintf(out, "\\u%04x", c);
+        run = text + 1;
+    }
+    textAppend(out, run, (size_t)(text - run));
+    textAppend(out, "\"", 1);
+}
+
+// JSON separator before the next entry.
+static void jsonEntry(ReportWriter* writer) {
+    if (writer->entries > 0) textAppend(&writer->text, ",\n", 2);
+}
+
+static void csvMark(TextBuffer* out, int mark) {
+    if (mark != -1) textPrintf(out, ",%d", mark);
+    else textAppend(out, ",", 1);
+}
+
+static void csvNumber(TextBuffer* out, int present, double value) {
+    if (present) textPrintf(out, ",%.2f", value);
+    else textAppend(out, ",", 1);
+}
+
+static void jsonNumber(TextBuffer* out, const char* key, int present, double value) {
+    if (present) textPrintf(out, ",\"%s\":%.2f", key, value);
+    else textPrintf(out, ",\"%s\":null", key);
+}
+
+// --- Student List ---
+
+void reportStudent(ReportWriter* writer, StudentNode* student) {
+    TextBuffer* out = &writer->text;
+    switch (writer->format) {
+        case REPORT_FORMAT_TEXT:
+            textPrintf(out, "  -> SRN: %-15s | Name: %s\n", student->studentSRN, student->name);
+            break;
+        case REPORT_FORMAT_CSV:
+            csvField(out, student->studentSRN);
+            textAppend(out, ",", 1);
+            csvField(out, student->name);
+            textAppend(out, "\n", 1);
+            break;
+        case REPORT_FORMAT_JSON:
+            jsonEntry(writer);
+            textAppend(out, "{\"srn\":", 7);
+            jsonString(out, student->studentSRN);
+            textAppend(out, ",\"name\":", 8);
+            jsonString(out, student->name);
+            textAppend(out, "}", 1);
+            break;
+    }
+    entryDone(writer);
+}
+
+void reportStudentList(ReportWriter* writer, StudentNode* root) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) reportStudent(writer, student);
+    closeCursor(&cursor);
+}
+
+// --- Subject Report ---
+
+static void textSubject(TextBuffer* out, StudentNode* student, const char* subjectName, const SubjectSummary* summary) {
+    static const char* labels[MARK_COMPONENTS] = {
+        "[Internal 1]   ", "[Assignment 1] ", "[Internal 2]   ", "[Assignment 2] ", "[Semester Exam]"
+    };
+    textPrintf(out, "\n" REPORT_RULE "            STUDENT SUBJECT REPORT\n" REPORT_RULE);
+    textPrintf(out, "SRN:    %s\nName:   %s\nSubject: %s\n", student->studentSRN, student->name, subjectName);
+    textPrintf(out, REPORT_LINE "Detailed Marks:\n\n");
+    for (int c = 0; c < MARK_COMPONENTS; c++) {
+        if (summary->marks[c] != -1) {
+            textPrintf(out, "  %s: %d / %d\n", labels[c], summary->marks[c], recordTypeMaxMark((RecordType)(INTERNAL_1 + c)));
+        }
+    }
+
+    textPrintf(out, "\n--- Summary & Calculation ---\n");
+    if (summary->cieComplete) textPrintf(out, "Total CIE (I1+A1+I2+A2):      %.2f / 50\n", summary->cieTotal);
+    else textPrintf(out, "Total CIE (I1+A1+I2+A2):      N/A (Missing components)\n");
+    if (summary->semesterScaled >= 0) textPrintf(out, "Semester Mark (Scaled):       %.2f / 50\n", summary->semesterScaled);
+    else textPrintf(out, "Semester Mark (Scaled):       N/A (Missing SEM score)\n");
+    if (summary->cieComplete && summary->semesterScaled >= 0) {
+        textPrintf(out, "\nFINAL SUBJECT MARK (Total):   %.2f / 100\n", summary->cieTotal + summary->semesterScaled);
+    } else {
+        textPrintf(out, "\nFINAL SUBJECT MARK (Total):   N/A (Missing components)\n");
+    }
+
+    if (summary->attendance.sessions > 0) {
+        textPrintf(out, "Attendance:                   %llu / %llu sessions (%.1f%%, class %.1f%%)\n",
+                   (unsigned long long)summary->attendance.present, (unsigned long long)summary->attendance.sessions,
+                   attendancePercent(summary->attendance), attendancePercent(summary->classAttendance));
+    } else {
+        textPrintf(out, "Attendance:                   N/A (No sessions recorded)\n");
+    }
+    textPrintf(out, REPORT_RULE);
+}
+
+static void csvSubject(TextBuffer* out, StudentNode* student, const char* subjectName, const SubjectSummary* summary) {
+    csvField(out, student->studentSRN);
+    textAppend(out, ",", 1);
+    csvField(out, student->name);
+    textAppend(out, ",", 1);
+    csvField(out, subjectName);
+    for (int c = 0; c < MARK_COMPONENTS; c++) csvMark(out, summary->marks[c]);
+    int hasSem = summary->semesterScaled >= 0;
+    csvNumber(out, summary->cieComplete, summary->cieTotal);
+    csvNumber(out, hasSem, summary->semesterScaled);
+    csvNumber(out, summary->cieComplete && hasSem, summary->cieTotal + summary->semesterScaled);
+    if (summary->attendance.sessions > 0) {
+        textPrintf(out, ",%llu,%llu,%.1f,%.1f\n", (unsigned long long)summary->attendance.present,
+                   (unsigned long long)summary->attendance.sessions, attendancePercent(summary->attendance),
+                   attendancePercent(summary->classAttendance));
+    } else {
+        textAppend(out, ",,,,\n", 5);
+    }
+}
+
+// The subject's members of a JSON object, without the braces.
+static void jsonSubjectFields(TextBuffer* out, const char* subjectName, const SubjectSummary* summary) {
+    textAppend(out, "\"subject\":", 10);
+    jsonString(out, subjectName);
+    textAppend(out, ",\"marks\":{", 10);
+    for (int c = 0; c < MARK_COMPONENTS; c++) {
+        if (summary->marks[c] != -1) textPrintf(out, "%s\"%s\":%d", c ? "," : "", componentKeys[c], summary->marks[c]);
+        else textPrintf(out, "%s\"%s\":null", c ? "," : "", componentKeys[c]);
+    }
+    textAppend(out, "}", 1);
+    int hasSem = summary->semesterScaled >= 0;
+    jsonNumber(out, "cie_total", summary->cieComplete, summary->cieTotal);
+    jsonNumber(out, "semester_scaled", hasSem, summary->semesterScaled);
+    jsonNumber(out, "final", summary->cieComplete && hasSem, summary->cieTotal + summary->semesterScaled);
+    if (summary->attendance.sessions > 0) {
+        textPrintf(out, ",\"attendance\":{\"present\":%llu,\"sessions\":%llu,\"percent\":%.1f,\"class_percent\":%.1f}",
+                   (unsigned long long)summary->attendance.present, (unsigned long long)summary->attendance.sessions,
+                   attendancePercent(summary->attendance), attendancePercent(summary->classAttendance));
+    } else {
+        textAppend(out, ",\"attendance\":null", 18);
+    }
+}
+
+static void jsonStudentFields(TextBuffer* out, StudentNode* student) {
+    textAppend(out, "\"srn\":", 6);
+    jsonString(out, student->studentSRN);
+    textAppend(out, ",\"name\":", 8);
+    jsonString(out, student->name);
+}
+
+static void writeSubject(ReportWriter* writer, StudentNode* student, const char* subjectName, const AttendanceTally* classTally) {
+    SubjectSummary summary;
+    summarizeSubject(student, subjectName, classTally, &summary);
+    TextBuffer* out = &writer->text;
+    switch (writer->format) {
+        case REPORT_FORMAT_TEXT:
+            textSubject(out, student, subjectName, &summary);
+            break;
+        case REPORT_FORMAT_CSV:
+            csvSubject(out, student, subjectName, &summary);
+            break;
+        case REPORT_FORMAT_JSON:
+            textAppend(out, "{", 1);
+            jsonStudentFields(out, student);
+            textAppend(out, ",", 1);
+            jsonSubjectFields(out, subjectName, &summary);
+            textAppend(out, "}", 1);
+            break;
+    }
+}
+
+void reportSubject(ReportWriter* writer, StudentNode* student, const char* subjectName, const AttendanceTally* classTally) {
+    if (writer->format == REPORT_FORMAT_JSON) jsonEntry(writer);
+    writeSubject(writer, student, subjectName, classTally);
+    entryDone(writer);
+}
+
+// --- Master Report ---
+
+static void textMaster(TextBuffer* out, StudentNode* student) {
+    textPrintf(out, "\n" REPORT_RULE "           MASTER STUDENT REPORT\n" REPORT_RULE);
+    textPrintf(out, "SRN:    %s\nName:   %s\n", student->studentSRN, student->name);
+    AttendanceTally attendance = studentAttendance(student->ordinal, ANY_SUBJECT);
+    if (attendance.sessions > 0) {
+        textPrintf(out, "Attendance: %llu / %llu sessions (%.1f%%)\n", (unsigned long long)attendance.present,
+                   (unsigned long long)attendance.sessions, attendancePercent(attendance));
+    }
+    textPrintf(out, REPORT_LINE);
+
+    if (student->historyHead == NULL && attendance.sessions == 0) {
+        textPrintf(out, "...No records found for this student.\n" REPORT_RULE);
+        return;
+    }
+    HistoryCursor history;
+    PerformanceRecord record;
+    openHistoryCursor(&history, student);
+    while (nextHistoryRecord(&history, &record)) {
+        textPrintf(out, "\nSubject: %s\n  Description: %s\n", symbolText(record.subject), symbolText(record.description));
+        if (record.type == ATTENDANCE) {
+            textPrintf(out, "  Type:  Attendance\n  Value: %s\n", record.value == 1 ? "Present" : "Absent");
+        } else {
+            textPrintf(out, "  Type:  %s\n  Value: %d / %d\n", recordTypeName(record.type), record.value,
+                       recordTypeMaxMark(record.type));
+        }
+    }
+
+    // Attendance sessions, in date order.
+    size_t cursor = 0;
+    AttendanceEntry entry;
+    while (nextAttendance(student->ordinal, &cursor, &entry)) {
+        textPrintf(out, "\nSubject: %s\n  Description: %s\n", symbolText(entry.subject), symbolText(entry.date));
+        textPrintf(out, "  Type:  Attendance\n  Value: %s\n", entry.present ? "Present" : "Absent");
+    }
+    textPrintf(out, REPORT_RULE);
+}
+
+static void csvRecord(TextBuffer* out, StudentNode* student, SymbolId subject, SymbolId description, RecordType type, int value) {
+    csvField(out, student->studentSRN);
+    textAppend(out, ",", 1);
+    csvField(out, student->name);
+    textAppend(out, ",", 1);
+    csvField(out, symbolText(subject));
+    textAppend(out, ",", 1);
+    csvField(out, symbolText(description));
+    textPrintf(out, ",%s,%d,%d\n", recordTypeName(type), value, recordTypeMaxMark(type));
+}
+
+static void jsonRecord(TextBuffer* out, int first, SymbolId subject, SymbolId description, RecordType type, int value) {
+    textAppend(out, first ? "{\"subject\":" : ",{\"subject\":", first ? 11 : 12);
+    jsonString(out, symbolText(subject));
+    textAppend(out, ",\"description\":", 15);
+    jsonString(out, symbolText(description));
+    textPrintf(out, ",\"type\":\"%s\",\"value\":%d,\"max_value\":%d}", recordTypeName(type), value, recordTypeMaxMark(type));
+}
+
+// Every record of a student: the history, then attendance in date order.
+// CSV gets a row per record; JSON gets the members after "srn"/"name".
+static void structuredMaster(ReportWriter* writer, StudentNode* student) {
+    TextBuffer* out = &writer->text;
+    int json = (writer->format == REPORT_FORMAT_JSON);
+    if (json) {
+        AttendanceTally attendance = studentAttendance(student->ordinal, ANY_SUBJECT);
+        if (attendance.sessions > 0) {
+            textPrintf(out, ",\"attendance\":{\"present\":%llu,\"sessions\":%llu,\"percent\":%.1f}",
+                       (unsigned long long)attendance.present, (unsigned long long)attendance.sessions,
+                       attendancePercent(attendance));
+        } else {
+            textAppend(out, ",\"attendance\":null", 18);
+        }
+        textAppend(out, ",\"records\":[", 12);
+    }
+    int first = 1;
+    HistoryCursor history;
+    PerformanceRecord record;
+    openHistoryCursor(&history, student);
+    for (; nextHistoryRecord(&history, &record); first = 0) {
+        if (json) jsonRecord(out, first, record.subject, record.description, record.type, record.value);
+        else csvRecord(out, student, record.subject, record.description, record.type, record.value);
+    }
+    size_t cursor = 0;
+    AttendanceEntry entry;
+    for (; nextAttendance(student->ordinal, &cursor, &entry); first = 0) {
+        if (json) jsonRecord(out, first, entry.subject, entry.date, ATTENDANCE, entry.present);
+        else csvRecord(out, student, entry.subject, entry.date, ATTENDANCE, entry.present);
+    }
+    if (json) textAppend(out, "]", 1);
+}
+
+void reportMaster(ReportWriter* writer, StudentNode* student) {
+    if (!faultInHistory(student)) return;
+    TextBuffer* out = &writer->text;
+    switch (writer->format) {
+        case REPORT_FORMAT_TEXT:
+            textMaster(out, student);
+            break;
+        case REPORT_FORMAT_CSV:
+            structuredMaster(writer, student);
+            break;
+        case REPORT_FORMAT_JSON:
+            jsonEntry(writer);
+            textAppend(out, "{", 1);
+            jsonStudentFields(out, student);
+            structuredMaster(writer, student);
+            textAppend(out, "}", 1);
+            break;
+    }
+    entryDone(writer);
+}
+
+// --- Cohort ---
+
+// Text: the subject reports and master report one after another. CSV: the
+// subject rows only (master rows have other columns). JSON: one object with
+// a "subjects" array and, with the master report, "attendance" and "records".
+void reportCohortStudent(ReportWriter* writer, StudentNode* student, char** subjects, const AttendanceTally* tallies,
+                         size_t subjectCount, int includeMaster) {
+    TextBuffer* out = &writer->text;
+    if (writer->format == REPORT_FORMAT_JSON) {
+        jsonEntry(writer);
+        textAppend(out, "{", 1);
+        jsonStudentFields(out, student);
+        textAppend(out, ",\"subjects\":[", 13);
+        for (size_t i = 0; i < subjectCount; i++) {
+            SubjectSummary summary;
+            summarizeSubject(student, subjects[i], tallies ? &tallies[i] : NULL, &summary);
+            textAppend(out, i ? ",{" : "{", i ? 2 : 1);
+            jsonSubjectFields(out, subjects[i], &summary);
+            textAppend(out, "}", 1);
+        }
+        textAppend(out, "]", 1);
+        if (includeMaster) structuredMaster(writer, student);
+        textAppend(out, "}", 1);
+    } else {
+        for (size_t i = 0; i < subjectCount; i++) writeSubject(writer, student, subjects[i], tallies ? &tallies[i] : NULL);
+        if (includeMaster && writer->format == REPORT_FORMAT_TEXT) textMaster(out, student);
+    }
+    entryDone(writer);
+}
+
+// --- Formats ---
+
+int parseReportFormat(const char* name, ReportFormat* format) {
+    if (strcmp(name, "text") == 0) *format = REPORT_FORMAT_TEXT;
+    else if (strcmp(name, "csv") == 0) *format = REPORT_FORMAT_CSV;
+    else if (strcmp(name, "json") == 0) *format = REPORT_FORMAT_JSON;
+    else return 0;
+    return 1;
+}
+
+const char* reportFormatExtension(ReportFormat format) {
+    switch (format) {
+        case REPORT_FORMAT_CSV:  return ".csv";
+        case REPORT_FORMAT_JSON: return ".json";
+        default:                 return ".txt";
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include "student_tracker.h"
+#include "text_buffer.h"
+
+// --- Report Writer ---
+//
+// Every report and listing is formatted into one large buffer that goes to
+// the output file in a single write once it holds REPORT_FLUSH_BYTES, rather
+// than through dozens of small printf calls per student. The same entries
+// can come out in three forms:
+//
+//   Text  The boxed reports shown in the menus
+//   CSV   A header line, then one row per entry (RFC 4180 quoting)
+//   JSON  An array with one object per entry, one object per line
+//
+// A document holds one kind of entry. Call reportBegin (CSV header, '['),
+// then the entry functions, then reportEnd. With no output file the document
+// simply accumulates in 'text', for the caller to place.
+
+#define REPORT_FLUSH_BYTES (256 * 1024)
+
+typedef enum {
+    REPORT_FORMAT_TEXT,
+    REPORT_FORMAT_CSV,
+    REPORT_FORMAT_JSON
+} ReportFormat;
+
+typedef enum {
+    REPORT_STUDENT_LIST, // reportStudent: SRN and name
+    REPORT_SUBJECT,      // reportSubject: one student in one subject
+    REPORT_MASTER,       // reportMaster: every record of one student (CSV: a row per record)
+    REPORT_COHORT        // reportCohortStudent: all subjects (+ records) of one student
+} ReportKind;
+
+typedef struct {
+    ReportFormat format;
+    ReportKind kind;
+    TextBuffer text;  // Formatted but not yet written
+    FILE* fp;         // NULL: keep everything in 'text'
+    size_t entries;   // Entries so far; JSON puts a comma before all but the first
+    size_t written;   // Bytes handed to 'fp' so far
+    int failed;       // A write to 'fp' failed
+} ReportWriter;
+
+void reportOpen(ReportWriter* writer, ReportFormat format, ReportKind kind, FILE* fp);
+void reportBegin(ReportWriter* writer);
+// Finishes the document and writes what is left. Returns 0 if any write failed.
+int reportEnd(ReportWriter* writer);
+// Writes what is buffered (nothing without an output file) and frees the buffer.
+int reportClose(ReportWriter* writer);
+
+/* --- Entries --- */
+void reportStudent(ReportWriter* writer, StudentNode* student);
+void reportStudentList(ReportWriter* writer, StudentNode* root); // reportStudent in SRN order
+void reportSubject(ReportWriter* writer, StudentNode* student, const char* subjectName, const AttendanceTally* classTally);
+void reportMaster(ReportWriter* writer, StudentNode* student);
+// 'tallies' may be NULL; otherwise classAttendance() of each subject.
+void reportCohortStudent(ReportWriter* writer, StudentNode* student, char** subjects, const AttendanceTally* tallies,
+                         size_t subjectCount, int includeMaster);
+
+/* --- Formats --- */
+int parseReportFormat(const char* name, ReportFormat* format); // "text", "csv" or "json"
+const char* reportFormatExtension(ReportFormat format);        // ".txt", ".csv", ".json"
+
+#endif // REPORT_WRITER_H
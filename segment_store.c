@@ -0,0 +1,503 @@
+#include "segment_store.h"
+#include "snapshot.h"
+#include "checksum.h"
+#include "tree_cursor.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+static long long preadAt(int fd, void* buf, size_t n, long long off) {
+    if (_lseeki64(fd, off, SEEK_SET) < 0) return -1;
+    return _read(fd, buf, (unsigned int)n);
+}
+static long long pwriteAt(int fd, const void* buf, size_t n, long long off) {
+    if (_lseeki64(fd, off, SEEK_SET) < 0) return -1;
+    return _write(fd, buf, (unsigned int)n);
+}
+#define O_BINARY_FLAG O_BINARY
+#else
+#include <unistd.h>
+#define preadAt(fd, buf, n, off) pread(fd, buf, n, (off_t)(off))
+#define pwriteAt(fd, buf, n, off) pwrite(fd, buf, n, (off_t)(off))
+#define O_BINARY_FLAG 0
+#endif
+
+// --- Dirty Tracking ---
+//
+// Every change records the SRN it touched, stamped with the current epoch.
+// A StudentNode remembers the epoch it was last recorded in, so repeated
+// edits to the same student only log it once per save.
+
+typedef struct {
+    char srn[20];
+    uint32_t epoch;
+} DirtyKey;
+
+static DirtyKey* dirtyKeys = NULL;
+static size_t dirtyCount = 0, dirtyCapacity = 0;
+static uint32_t currentEpoch = 1;
+static uint32_t confirmedEpoch = 0;
+static uint32_t teacherDirtyEpoch = 0;
+static char anchoredPath[512] = "";   // File the dirty state is relative to
+
+void markKeyDirty(const char* srn) {
+    if (dirtyCount == dirtyCapacity) {
+        size_t newCapacity = dirtyCapacity ? dirtyCapacity * 2 : 64;
+        DirtyKey* grown = (DirtyKey*)realloc(dirtyKeys, newCapacity * sizeof(DirtyKey));
+        if (grown == NULL) {
+            // Without room to remember the key, force the next save to rewrite everything.
+            confirmedEpoch = 0;
+            teacherDirtyEpoch = currentEpoch;
+            return;
+        }
+        dirtyKeys = grown;
+        dirtyCapacity = newCapacity;
+    }
+    strncpy(dirtyKeys[dirtyCount].srn, srn, sizeof(dirtyKeys[dirtyCount].srn) - 1);
+    dirtyKeys[dirtyCount].srn[sizeof(dirtyKeys[dirtyCount].srn) - 1] = '\0';
+    dirtyKeys[dirtyCount].epoch = currentEpoch;
+    dirtyCount++;
+}
+
+void markStudentDirty(StudentNode* student) {
+    if (student == NULL || student->dirtyEpoch == currentEpoch) return;
+    student->dirtyEpoch = currentEpoch;
+    markKeyDirty(student->studentSRN);
+}
+
+void markTeacherDirty(TeacherNode* teacher) {
+    if (teacher != NULL) teacher->dirtyEpoch = currentEpoch;
+    teacherDirtyEpoch = currentEpoch;
+}
+
+void clearDirtyState(void) {
+    dirtyCount = 0;
+    teacherDirtyEpoch = 0;
+    confirmedEpoch = currentEpoch;
+    currentEpoch++; // Node stamps from the load no longer match
+}
+
+uint32_t beginSaveEpoch(void) {
+    return currentEpoch++;
+}
+
+static void anchorTo(const char* path) {
+    strncpy(anchoredPath, path, sizeof(anchoredPath) - 1);
+    anchoredPath[sizeof(anchoredPath) - 1] = '\0';
+}
+
+void confirmSaveEpoch(uint32_t epoch, const char* path) {
+    anchorTo(path);
+    if (epoch > confirmedEpoch) confirmedEpoch = epoch;
+    size_t kept = 0;
+    for (size_t i = 0; i < dirtyCount; i++) {
+        if (dirtyKeys[i].epoch > epoch) dirtyKeys[kept++] = dirtyKeys[i];
+    }
+    dirtyCount = kept;
+    if (teacherDirtyEpoch <= epoch) teacherDirtyEpoch = 0;
+}
+
+// --- Student Collection ---
+
+typedef struct {
+    StudentNode** items;
+    size_t count;
+    size_t capacity;
+    int failed;
+} StudentList;
+
+static void listPush(StudentList* list, StudentNode* student) {
+    if (list->failed) return;
+    if (list->count == list->capacity) {
+        size_t newCapacity = list->capacity ? list->capacity * 2 : 256;
+        StudentNode** grown = (StudentNode**)realloc(list->items, newCapacity * sizeof(StudentNode*));
+        if (grown == NULL) {
+            list->failed = 1;
+            return;
+        }
+        list->items = grown;
+        list->capacity = newCapacity;
+    }
+    list->items[list->count++] = student;
+}
+
+// In-order walk of the students with low <= SRN < high (high NULL = no bound).
+static void collectRange(StudentNode* root, const char* low, const char* high, StudentList* list) {
+    TreeCursor cursor;
+    StudentNode* student;
+    seekStudentCursor(&cursor, root, low);
+    while ((student = nextStudent(&cursor)) != NULL) {
+        if (high != NULL && strcmp(student->studentSRN, high) >= 0) break;
+        listPush(list, student);
+    }
+    closeCursor(&cursor);
+}
+
+// --- Writing Segments ---
+
+typedef struct {
+    int fd;
+    uint64_t end;              // Current end of file (next append position)
+    SegmentEntry* entries;     // Directory being built
+    uint32_t count;
+    uint32_t capacity;
+    int failed;
+} SegmentWriter;
+
+static int writeAll(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        long long written = pwriteAt(fd, bytes, size, (long long)offset);
+        if (written <= 0) return 0;
+        bytes += written;
+        size -= (size_t)written;
+        offset += (uint64_t)written;
+    }
+    return 1;
+}
+
+static int readAll(int fd, void* data, size_t size, uint64_t offset) {
+    char* bytes = (char*)data;
+    while (size > 0) {
+        long long got = preadAt(fd, bytes, size, (long long)offset);
+        if (got <= 0) return 0;
+        bytes += got;
+        size -= (size_t)got;
+        offset += (uint64_t)got;
+    }
+    return 1;
+}
+
+static SegmentEntry* addEntry(SegmentWriter* writer) {
+    if (writer->count == writer->capacity) {
+        uint32_t newCapacity = writer->capacity ? writer->capacity * 2 : 64;
+        SegmentEntry* grown = (SegmentEntry*)realloc(writer->entries, newCapacity * sizeof(SegmentEntry));
+        if (grown == NULL) return NULL;
+        writer->entries = grown;
+        writer->capacity = newCapacity;
+    }
+    SegmentEntry* entry = &writer->entries[writer->count++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+// Appends one segment at the (8-byte aligned) end of the file and records it.
+static void appendSegment(SegmentWriter* writer, SegmentKind kind, TeacherNode* teacherRoot,
+                          StudentNode** students, size_t count, const char* firstSRN) {
+    if (writer->failed) return;
+    size_t size = 0;
+    char* image = encodeSnapshotImage(teacherRoot, students, count, &size);
+    SegmentEntry* entry = image ? addEntry(writer) : NULL;
+    if (entry == NULL) {
+        free(image);
+        writer->failed = 1;
+        return;
+    }
+    writer->end = (writer->end + 7) & ~(uint64_t)7;
+    entry->offset = writer->end;
+    entry->size = size;
+    entry->kind = (uint32_t)kind;
+    entry->studentCount = (uint32_t)count;
+    entry->checksum = crc32Checksum(image, size);
+    strcpy(entry->firstSRN, firstSRN);
+    if (!writeAll(writer->fd, image, size, writer->end)) writer->failed = 1;
+    writer->end += size;
+    free(image);
+}
+
+// Writes a run of students as one or more segments of the target size.
+static void appendStudentSegments(SegmentWriter* writer, StudentNode** students, size_t count, const char* firstSRN) {
+    if (count <= 2 * SEGMENT_TARGET_STUDENTS) {
+        appendSegment(writer, SEGMENT_STUDENTS, NULL, students, count, firstSRN);
+        return;
+    }
+    for (size_t start = 0; start < count; start += SEGMENT_TARGET_STUDENTS) {
+        size_t chunk = count - start;
+        if (chunk > SEGMENT_TARGET_STUDENTS) chunk = SEGMENT_TARGET_STUDENTS;
+        const char* chunkFirst = (start == 0) ? firstSRN : students[start]->studentSRN;
+        appendSegment(writer, SEGMENT_STUDENTS, NULL, students + start, chunk, chunkFirst);
+    }
+}
+
+static uint32_t superblockChecksum(const SegmentSuperblock* superblock) {
+    return crc32Checksum(superblock, offsetof(SegmentSuperblock, checksum));
+}
+
+// Appends the directory, flushes the segments, then commits a new superblock.
+static int commitDirectory(SegmentWriter* writer, uint64_t generation) {
+    if (writer->failed) return 0;
+    size_t directorySize = writer->count * sizeof(SegmentEntry);
+    writer->end = (writer->end + 7) & ~(uint64_t)7;
+    uint64_t directoryOffset = writer->end;
+    if (!writeAll(writer->fd, writer->entries, directorySize, directoryOffset)) return 0;
+    writer->end += directorySize;
+    if (fsync(writer->fd) != 0) return 0; // Segments must be durable before they are referenced
+
+    SegmentSuperblock superblock;
+    memset(&superblock, 0, sizeof(superblock));
+    memcpy(superblock.magic, SEGMENT_STORE_MAGIC, sizeof(superblock.magic));
+    superblock.version = SEGMENT_STORE_VERSION;
+    superblock.byteOrderMark = SNAPSHOT_BYTE_ORDER_MARK;
+    superblock.generation = generation;
+    superblock.directoryOffset = directoryOffset;
+    superblock.directoryCount = writer->count;
+    superblock.directoryChecksum = crc32Checksum(writer->entries, directorySize);
+    superblock.journalSequence = getDataSequence();
+    superblock.liveBytes = SEGMENT_DATA_START + directorySize;
+    for (uint32_t i = 0; i < writer->count; i++) superblock.liveBytes += writer->entries[i].size;
+    superblock.fileSize = writer->end;
+    superblock.checksum = superblockChecksum(&superblock);
+
+    uint64_t slot = (generation % 2) ? SEGMENT_SUPERBLOCK_SLOT : 0;
+    if (!writeAll(writer->fd, &superblock, sizeof(superblock), slot)) return 0;
+    return fsync(writer->fd) == 0;
+}
+
+// --- Reading the Current Version ---
+
+static int readSuperblock(int fd, uint64_t slot, SegmentSuperblock* superblock) {
+    if (!readAll(fd, superblock, sizeof(*superblock), slot)) return 0;
+    return memcmp(superblock->magic, SEGMENT_STORE_MAGIC, sizeof(superblock->magic)) == 0 &&
+           superblock->version == SEGMENT_STORE_VERSION &&
+           superblock->byteOrderMark == SNAPSHOT_BYTE_ORDER_MARK &&
+           superblock->checksum == superblockChecksum(superblock);
+}
+
+// Picks the newest intact superblock. Returns 0 if neither slot is valid.
+static int readCurrentSuperblock(int fd, SegmentSuperblock* superblock) {
+    SegmentSuperblock a, b;
+    int validA = readSuperblock(fd, 0, &a);
+    int validB = readSuperblock(fd, SEGMENT_SUPERBLOCK_SLOT, &b);
+    if (!validA && !validB) return 0;
+    if (validA && (!validB || a.generation > b.generation)) *superblock = a;
+    else *superblock = b;
+    return 1;
+}
+
+static int directoryValid(const SegmentSuperblock* superblock, const SegmentEntry* entries, uint64_t fileSize) {
+    if (superblock->directoryCount < 1) return 0;
+    if (crc32Checksum(entries, superblock->directoryCount * sizeof(SegmentEntry)) != superblock->directoryChecksum) return 0;
+    for (uint32_t i = 0; i < superblock->directoryCount; i++) {
+        const SegmentEntry* entry = &entries[i];
+        if (entry->offset < SEGMENT_DATA_START || entry->offset % 8 != 0) return 0;
+        if (entry->offset > fileSize || entry->size > fileSize - entry->offset) return 0;
+        if (memchr(entry->firstSRN, '\0', sizeof(entry->firstSRN)) == NULL) return 0;
+        if (entry->kind != (i == 0 ? SEGMENT_TEACHERS : SEGMENT_STUDENTS)) return 0;
+        if (i == 1 && entry->firstSRN[0] != '\0') return 0;
+        if (i > 1 && strcmp(entries[i - 1].firstSRN, entry->firstSRN) >= 0) return 0;
+    }
+    return 1;
+}
+
+static SegmentEntry* readDirectory(int fd, const SegmentSuperblock* superblock, uint64_t fileSize) {
+    if (superblock->directoryCount < 1 || superblock->directoryOffset > fileSize ||
+        superblock->directoryCount > (fileSize - superblock->directoryOffset) / sizeof(SegmentEntry)) {
+        return NULL;
+    }
+    size_t size = superblock->directoryCount * sizeof(SegmentEntry);
+    SegmentEntry* entries = (SegmentEntry*)malloc(size);
+    if (entries == NULL) return NULL;
+    if (!readAll(fd, entries, size, superblock->directoryOffset) || !directoryValid(superblock, entries, fileSize)) {
+        free(entries);
+        return NULL;
+    }
+    return entries;
+}
+
+// Index of the student segment that owns 'srn' (entries[1..count-1]).
+static uint32_t findOwningSegment(const SegmentEntry* entries, uint32_t count, const char* srn) {
+    uint32_t low = 1, high = count - 1;
+    while (low < high) {
+        uint32_t mid = low + (high - low + 1) / 2;
+        if (strcmp(entries[mid].firstSRN, srn) <= 0) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+// --- Saving ---
+
+// Writes every segment into a fresh file and swaps it in.
+static int saveFull(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    int fd = open(tempPath, O_RDWR | O_CREAT | O_TRUNC | O_BINARY_FLAG, 0644);
+    if (fd < 0) return 0;
+
+    StudentList all = { NULL, 0, 0, 0 };
+    collectRange(studentRoot, "", NULL, &all);
+
+    SegmentWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.fd = fd;
+    writer.end = SEGMENT_DATA_START;
+    writer.failed = all.failed;
+    appendSegment(&writer, SEGMENT_TEACHERS, teacherRoot, NULL, 0, "");
+    if (all.count == 0) {
+        appendSegment(&writer, SEGMENT_STUDENTS, NULL, NULL, 0, "");
+    }
+    for (size_t start = 0; start < all.count; start += SEGMENT_TARGET_STUDENTS) {
+        size_t chunk = all.count - start;
+        if (chunk > SEGMENT_TARGET_STUDENTS) chunk = SEGMENT_TARGET_STUDENTS;
+        appendSegment(&writer, SEGMENT_STUDENTS, NULL, all.items + start, chunk,
+                      start == 0 ? "" : all.items[start]->studentSRN);
+    }
+    int ok = commitDirectory(&writer, 1);
+    if (close(fd) != 0) ok = 0;
+    free(writer.entries);
+    free(all.items);
+
+    if (!ok || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return 0;
+    }
+#ifndef _WIN32
+    int dirFd = open(".", O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd); // Persist the rename itself
+        close(dirFd);
+    }
+#endif
+    return 1;
+}
+
+// Rewrites only the segments touched since the last confirmed save.
+// Returns -1 if the file cannot be updated in place (caller does a full save).
+static int saveIncremental(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    int fd = open(path, O_RDWR | O_BINARY_FLAG);
+    if (fd < 0) return -1;
+    struct stat st;
+    SegmentSuperblock superblock;
+    SegmentEntry* entries = NULL;
+    if (fstat(fd, &st) != 0 || !readCurrentSuperblock(fd, &superblock) ||
+        (entries = readDirectory(fd, &superblock, (uint64_t)st.st_size)) == NULL) {
+        close(fd);
+        return -1;
+    }
+    if (superblock.fileSize > 2 * superblock.liveBytes + SEGMENT_COMPACT_SLACK) {
+        free(entries); // Mostly dead space: rewrite compactly instead
+        close(fd);
+        return -1;
+    }
+
+    uint32_t count = superblock.directoryCount;
+    unsigned char* rewrite = (unsigned char*)calloc(count, 1);
+    if (rewrite == NULL) {
+        free(entries);
+        close(fd);
+        return -1;
+    }
+    if (teacherDirtyEpoch > confirmedEpoch) rewrite[0] = 1;
+    for (size_t i = 0; i < dirtyCount; i++) {
+        if (dirtyKeys[i].epoch > confirmedEpoch && count > 1) {
+            rewrite[findOwningSegment(entries, count, dirtyKeys[i].srn)] = 1;
+        }
+    }
+
+    SegmentWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.fd = fd;
+    // Never append over the bytes of the version we are replacing.
+    writer.end = (superblock.fileSize > (uint64_t)st.st_size) ? superblock.fileSize : (uint64_t)st.st_size;
+
+    for (uint32_t i = 0; i < count && !writer.failed; i++) {
+        if (!rewrite[i]) {
+            SegmentEntry* kept = addEntry(&writer);
+            if (kept == NULL) writer.failed = 1;
+            else *kept = entries[i];
+            continue;
+        }
+        if (i == 0) {
+            appendSegment(&writer, SEGMENT_TEACHERS, teacherRoot, NULL, 0, "");
+            continue;
+        }
+        const char* high = (i + 1 < count) ? entries[i + 1].firstSRN : NULL;
+        StudentList range = { NULL, 0, 0, 0 };
+        collectRange(studentRoot, entries[i].firstSRN, high, &range);
+        if (range.failed) writer.failed = 1;
+        else if (range.count > 0 || i == 1) {
+            appendStudentSegments(&writer, range.items, range.count, entries[i].firstSRN);
+        }
+        // An emptied segment (other than the first) is dropped; its range
+        // folds into the previous segment.
+        free(range.items);
+    }
+
+    int ok = commitDirectory(&writer, superblock.generation + 1);
+    if (close(fd) != 0) ok = 0;
+    free(writer.entries);
+    free(rewrite);
+    free(entries);
+    return ok;
+}
+
+int saveSegmentStore(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    int result = -1;
+    if (strcmp(path, anchoredPath) == 0) result = saveIncremental(path, teacherRoot, studentRoot);
+    if (result < 0) result = saveFull(path, teacherRoot, studentRoot);
+    return result;
+}
+
+// --- Loading ---
+
+int isSegmentStoreFile(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    char magic[8];
+    int match = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+                memcmp(magic, SEGMENT_STORE_MAGIC, sizeof(magic)) == 0;
+    if (!match) {
+        // Slot A may be torn while slot B is still good.
+        match = fseek(fp, SEGMENT_SUPERBLOCK_SLOT, SEEK_SET) == 0 &&
+                fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+                memcmp(magic, SEGMENT_STORE_MAGIC, sizeof(magic)) == 0;
+    }
+    fclose(fp);
+    return match;
+}
+
+int loadSegmentStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    int fd = open(path, O_RDONLY | O_BINARY_FLAG);
+    if (fd < 0) return 0;
+    struct stat st;
+    SegmentSuperblock superblock;
+    SegmentEntry* entries = NULL;
+    if (fstat(fd, &st) != 0 || !readCurrentSuperblock(fd, &superblock) ||
+        (entries = readDirectory(fd, &superblock, (uint64_t)st.st_size)) == NULL) {
+        close(fd);
+        return 0;
+    }
+    close(fd);
+
+    MappedFile file;
+    if (!mapDataFile(path, &file)) {
+        free(entries);
+        return 0;
+    }
+    // Verify every segment before adding anything, so a bad file leaves the trees untouched.
+    int ok = 1;
+    for (uint32_t i = 0; i < superblock.directoryCount && ok; i++) {
+        if (entries[i].offset + entries[i].size > file.size ||
+            crc32Checksum(file.data + entries[i].offset, (size_t)entries[i].size) != entries[i].checksum) {
+            ok = 0;
+        }
+    }
+    // Segments are in SRN order, so one batch collects every student sorted.
+    StudentBatch batch = { NULL, 0, 0 };
+    for (uint32_t i = 0; i < superblock.directoryCount && ok; i++) {
+        ok = decodeSnapshotImage(file.data + entries[i].offset, (size_t)entries[i].size, teacherRoot, &batch);
+    }
+    if (ok) ok = finishStudentBatch(&batch, studentRoot);
+    if (!ok) discardStudentBatch(&batch);
+    if (ok) {
+        setDataSequence(superblock.journalSequence);
+        anchorTo(path);
+    }
+
+    unmapDataFile(&file);
+    free(entries);
+    return ok;
+}
@@ -0,0 +1,79 @@
+#ifndef SEGMENT_STORE_H
+#define SEGMENT_STORE_H
+
+#include "student_tracker.h"
+
+// --- Segmented Save File ---
+//
+// The save file is split into independently rewritable segments so that a
+// save only rewrites what changed:
+//
+//   superblock slot A (offset 0) and slot B (offset SEGMENT_SUPERBLOCK_SLOT)
+//   segments        (each a complete snapshot image, see snapshot.h)
+//   directory       (directoryCount x SegmentEntry)
+//
+// Segment 0 holds every teacher. The remaining segments partition the
+// students by SRN range: a segment owns the SRNs from its firstSRN up to the
+// next segment's firstSRN.
+//
+// Changed segments are appended to the end of the file, followed by a new
+// directory. The save commits by writing a superblock into the older slot,
+// so a crash at any point leaves the previous version intact. When dead
+// space outweighs live data the whole file is rewritten compactly.
+
+#define SEGMENT_STORE_MAGIC "STRKSEGS"
+#define SEGMENT_STORE_VERSION 1
+#define SEGMENT_SUPERBLOCK_SLOT 128
+#define SEGMENT_DATA_START 256
+#define SEGMENT_TARGET_STUDENTS 256   // Segments are split once they hold twice this
+#define SEGMENT_COMPACT_SLACK (1L * 1024 * 1024)
+
+typedef enum {
+    SEGMENT_TEACHERS = 1,
+    SEGMENT_STUDENTS = 2
+} SegmentKind;
+
+typedef struct {
+    char magic[8];              // SEGMENT_STORE_MAGIC
+    uint32_t version;
+    uint32_t byteOrderMark;     // SNAPSHOT_BYTE_ORDER_MARK
+    uint64_t generation;        // Highest valid generation wins
+    uint64_t directoryOffset;
+    uint32_t directoryCount;
+    uint32_t directoryChecksum;
+    uint64_t journalSequence;   // Last journal entry included (see journal.h)
+    uint64_t liveBytes;         // Bytes referenced by this version
+    uint64_t fileSize;          // File length when this version was committed
+    uint32_t reserved;
+    uint32_t checksum;          // CRC of everything above
+} SegmentSuperblock;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t kind;              // SegmentKind
+    uint32_t studentCount;
+    uint32_t checksum;          // CRC of the segment bytes
+    char firstSRN[20];          // Lowest SRN this segment owns ("" for the first)
+} SegmentEntry;
+
+/* --- File I/O --- */
+int isSegmentStoreFile(const char* path);
+int saveSegmentStore(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot);
+int loadSegmentStore(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+/* --- Dirty Tracking --- */
+void markStudentDirty(StudentNode* student);
+void markKeyDirty(const char* srn);
+void markTeacherDirty(TeacherNode* teacher);
+void clearDirtyState(void);
+
+// A save covers every change made before beginSaveEpoch. Once the save to
+// 'path' is known to be on disk, confirmSaveEpoch forgets those changes;
+// anything changed after beginSaveEpoch stays dirty for the next save.
+// Incremental saves are only attempted against the file the in-memory data
+// was last loaded from or confirmed to; any other path gets a full write.
+uint32_t beginSaveEpoch(void);
+void confirmSaveEpoch(uint32_t epoch, const char* path);
+
+#endif // SEGMENT_STORE_H
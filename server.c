@@ -0,0 +1,535 @@
+#define _GNU_SOURCE // accept4
+#include "server.h"
+
+#ifndef __linux__
+
+int runServer(const char* socketPath) {
+    (void)socketPath;
+    printf("Error: Server mode needs Linux (epoll).\n");
+    return 1;
+}
+
+#else
+
+#include "batch.h"
+#include "journal.h"
+#include "op_stats.h"
+#include "text_buffer.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_INPUT_SIZE (4 * BATCH_LINE_SIZE) // Received but not yet run, per session
+#define SERVER_EVENTS 64
+
+typedef struct Session {
+    int fd;                         // -1 once closed
+    int slot;                       // Index in Server.sessions
+    BatchState* batch;
+    char input[SERVER_INPUT_SIZE];
+    size_t inputLength;
+    int skipping;                   // Dropping the rest of an over-long line
+    int inputClosed;                // Peer shut down its side; finish the lines already sent
+    int hungUp;                     // Peer is gone; freed once no worker holds it
+    int busy;                       // A worker owns 'command' and 'result'
+    char command[BATCH_LINE_SIZE];  // The command queued or running
+    TextBuffer result;              // The worker's reply to 'command'
+    TextBuffer reply;               // Replies waiting to be sent
+    size_t replySent;
+    uint32_t events;                // What epoll is watching for
+    struct Session* next;           // Work, done or closed list
+} Session;
+
+typedef struct {
+    TeacherNode* teacherRoot;
+    StudentNode* studentRoot;
+    pthread_rwlock_t dataLock;  // Shared: read-only commands. Exclusive: every other command
+    int consoleFd;              // The real stdout, while a worker captures fd 1
+    int epollFd;
+    int listenFd;
+    int wakeFd;                 // eventfd: a worker finished a command
+    Session* sessions[SERVER_MAX_SESSIONS];
+    int sessionCount;
+    Session* closed;            // Freed after the current batch of events
+    pthread_mutex_t queueLock;  // Guards the work and done lists and 'stopping'
+    pthread_cond_t workReady;
+    Session* workHead;
+    Session* workTail;
+    Session* doneHead;
+    int stopping;
+} Server;
+
+static volatile sig_atomic_t stopRequested = 0;
+static int listenTag, wakeTag; // epoll data of the descriptors that are not sessions
+
+static void requestStop(int signal) {
+    (void)signal;
+    stopRequested = 1;
+}
+
+// --- Workers ---
+
+// Read-only commands write only to the stream they are given, so each can
+// capture into its own memory stream while others run.
+static void runReadOnly(Server* server, Session* session) {
+    char* text = NULL;
+    size_t length = 0;
+    FILE* out = open_memstream(&text, &length);
+    if (out == NULL) {
+        textPrintf(&session->result, "Error: Memory allocation failed!\n");
+        return;
+    }
+    pthread_rwlock_rdlock(&server->dataLock);
+    batchSessionRun(session->batch, session->command, out);
+    pthread_rwlock_unlock(&server->dataLock);
+    fclose(out);
+    textAppend(&session->result, text, length);
+    free(text);
+}
+
+// Commands that change data print through stdout from deep inside the
+// tracker, so fd 1 points at the worker's capture file while one runs. That
+// is safe because the write lock keeps every other command out and the loop
+// thread only logs to stderr.
+static void runExclusive(Server* server, Session* session, FILE* capture) {
+    int captureFd = fileno(capture);
+    pthread_rwlock_wrlock(&server->dataLock);
+    fflush(stdout);
+    if (ftruncate(captureFd, 0) != 0 || lseek(captureFd, 0, SEEK_SET) != 0 || dup2(captureFd, STDOUT_FILENO) < 0) {
+        pthread_rwlock_unlock(&server->dataLock);
+        textPrintf(&session->result, "Error: Could not capture the command's output.\n");
+        return;
+    }
+    batchSessionRun(session->batch, session->command, stdout);
+    fflush(stdout);
+    dup2(server->consoleFd, STDOUT_FILENO);
+    pthread_rwlock_unlock(&server->dataLock);
+
+    char chunk[4096];
+    off_t offset = 0;
+    ssize_t got;
+    while ((got = pread(captureFd, chunk, sizeof(chunk), offset)) > 0) {
+        textAppend(&session->result, chunk, (size_t)got);
+        offset += got;
+    }
+}
+
+static void* serverWorker(void* arg) {
+    Server* server = (Server*)arg;
+    FILE* capture = tmpfile();
+    while (1) {
+        pthread_mutex_lock(&server->queueLock);
+        while (!server->stopping && server->workHead == NULL) pthread_cond_wait(&server->workReady, &server->queueLock);
+        if (server->stopping) {
+            pthread_mutex_unlock(&server->queueLock);
+            break;
+        }
+        Session* session = server->workHead;
+        server->workHead = session->next;
+        if (server->workHead == NULL) server->workTail = NULL;
+        pthread_mutex_unlock(&server->queueLock);
+
+        textReset(&session->result);
+        if (batchCommandReadOnly(session->command)) runReadOnly(server, session);
+        else if (capture != NULL) runExclusive(server, session, capture);
+        else textPrintf(&session->result, "Error: Could not capture the command's output.\n");
+        textAppend(&session->result, "", 1); // The NUL that ends a reply
+
+        pthread_mutex_lock(&server->queueLock);
+        session->next = server->doneHead;
+        server->doneHead = session;
+        pthread_mutex_unlock(&server->queueLock);
+        uint64_t one = 1;
+        if (write(server->wakeFd, &one, sizeof(one)) < 0) {
+            // The counter only overflows after 2^64 - 1 unread wakeups
+        }
+    }
+    if (capture != NULL) fclose(capture);
+    return NULL;
+}
+
+// --- Sessions (loop thread only) ---
+
+static void closeSession(Server* server, Session* session) {
+    if (session->fd >= 0) {
+        epoll_ctl(server->epollFd, EPOLL_CTL_DEL, session->fd, NULL);
+        close(session->fd);
+        session->fd = -1;
+    }
+    server->sessions[session->slot] = server->sessions[--server->sessionCount];
+    server->sessions[session->slot]->slot = session->slot;
+    session->next = server->closed;
+    server->closed = session;
+    fprintf(stderr, "Session closed (%d open).\n", server->sessionCount);
+}
+
+static void freeSession(Session* session) {
+    batchSessionClose(session->batch);
+    textFree(&session->result);
+    textFree(&session->reply);
+    free(session);
+}
+
+// The peer is gone: stop watching now, free once no worker holds the session.
+static void hangUp(Server* server, Session* session) {
+    if (!session->hungUp) {
+        session->hungUp = 1;
+        epoll_ctl(server->epollFd, EPOLL_CTL_DEL, session->fd, NULL);
+        close(session->fd);
+        session->fd = -1;
+    }
+    if (!session->busy) closeSession(server, session);
+}
+
+static void watch(Server* server, Session* session) {
+    uint32_t events = 0;
+    if (!session->inputClosed && session->inputLength < SERVER_INPUT_SIZE) events |= EPOLLIN;
+    if (session->replySent < session->reply.size) events |= EPOLLOUT;
+    if (events == session->events) return;
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = session;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, session->fd, &event);
+    session->events = events;
+}
+
+static void replyError(Session* session, const char* message) {
+    textPrintf(&session->reply, "Error: %s\n", message);
+    textAppend(&session->reply, "", 1);
+}
+
+// Hands the next complete line to the workers. Lines that fail before they
+// get that far are answered here, and the one after them is tried.
+static void dispatch(Server* server, Session* session) {
+    while (!session->busy) {
+        char* newline = (char*)memchr(session->input, '\n', session->inputLength);
+        if (newline == NULL) {
+            if (session->inputLength == SERVER_INPUT_SIZE) {
+                session->inputLength = 0;
+                session->skipping = 1;
+                replyError(session, "Line is too long.");
+            }
+            return;
+        }
+        size_t length = (size_t)(newline - session->input);
+        if (length < BATCH_LINE_SIZE) {
+            memcpy(session->command, session->input, length);
+            session->command[length] = '\0';
+        } else {
+            replyError(session, "Line is too long.");
+        }
+        session->inputLength -= length + 1;
+        memmove(session->input, newline + 1, session->inputLength);
+        if (length >= BATCH_LINE_SIZE) continue;
+
+        session->busy = 1;
+        session->next = NULL;
+        pthread_mutex_lock(&server->queueLock);
+        if (server->workTail != NULL) server->workTail->next = session;
+        else server->workHead = session;
+        server->workTail = session;
+        pthread_cond_signal(&server->workReady);
+        pthread_mutex_unlock(&server->queueLock);
+    }
+}
+
+// Sends as much of the waiting replies as the socket takes. Returns 0 if
+// the session is gone.
+static int sendReplies(Server* server, Session* session) {
+    while (session->replySent < session->reply.size) {
+        ssize_t sent = send(session->fd, session->reply.data + session->replySent,
+                            session->reply.size - session->replySent, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (sent < 0) {
+            hangUp(server, session);
+            return 0;
+        }
+        session->replySent += (size_t)sent;
+    }
+    if (session->replySent == session->reply.size) {
+        textReset(&session->reply);
+        session->replySent = 0;
+    }
+    return 1;
+}
+
+// Runs after anything happened to a session: start its next command, send
+// what is ready, and close it once a finished peer has had every reply.
+static void service(Server* server, Session* session) {
+    dispatch(server, session);
+    if (!sendReplies(server, session)) return;
+    if (session->inputClosed && !session->busy && session->reply.size == 0) {
+        closeSession(server, session);
+        return;
+    }
+    watch(server, session);
+}
+
+// Returns 0 if the session is gone.
+static int receive(Server* server, Session* session) {
+    while (!session->inputClosed && session->inputLength < SERVER_INPUT_SIZE) {
+        char* into = session->input + session->inputLength;
+        ssize_t got = recv(session->fd, into, SERVER_INPUT_SIZE - session->inputLength, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (got < 0) {
+            hangUp(server, session);
+            return 0;
+        }
+        if (got == 0) {
+            // Shut down for writing: the last line may lack its newline.
+            session->inputClosed = 1;
+            if (session->inputLength > 0 && !session->skipping && session->input[session->inputLength - 1] != '\n' &&
+                session->inputLength < SERVER_INPUT_SIZE) {
+                session->input[session->inputLength++] = '\n';
+            }
+            break;
+        }
+        if (session->skipping) {
+            char* newline = (char*)memchr(into, '\n', (size_t)got);
+            if (newline == NULL) continue;
+            got -= newline + 1 - into;
+            memmove(into, newline + 1, (size_t)got);
+            session->skipping = 0;
+        }
+        session->inputLength += (size_t)got;
+    }
+    return 1;
+}
+
+static void acceptSessions(Server* server) {
+    while (1) {
+        int fd = accept4(server->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN: no more waiting
+        }
+        Session* session = NULL;
+        if (server->sessionCount < SERVER_MAX_SESSIONS) session = (Session*)calloc(1, sizeof(Session));
+        if (session != NULL) session->batch = batchSessionOpen(&server->teacherRoot, &server->studentRoot);
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = session;
+        if (session == NULL || session->batch == NULL || epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            static const char busy[] = "Error: The server cannot take another session.\n";
+            if (send(fd, busy, sizeof(busy), MSG_NOSIGNAL) < 0) {
+                // Nothing more to tell a client that is gone already
+            }
+            close(fd);
+            if (session != NULL) freeSession(session);
+            continue;
+        }
+        session->fd = fd;
+        session->events = EPOLLIN;
+        session->slot = server->sessionCount;
+        server->sessions[server->sessionCount++] = session;
+        fprintf(stderr, "Session opened (%d open).\n", server->sessionCount);
+    }
+}
+
+// Compaction forks a child that writes the whole save file, so it starts
+// here rather than on a worker: the write lock keeps every worker away from
+// the trees, and the loop thread holds no lock a worker might also be inside.
+static void compactJournal(Server* server) {
+    pthread_rwlock_wrlock(&server->dataLock);
+    journalMaybeCompact(server->teacherRoot, server->studentRoot);
+    pthread_rwlock_unlock(&server->dataLock);
+}
+
+static void finishCommands(Server* server) {
+    uint64_t wakeups;
+    if (read(server->wakeFd, &wakeups, sizeof(wakeups)) < 0) return;
+    pthread_mutex_lock(&server->queueLock);
+    Session* done = server->doneHead;
+    server->doneHead = NULL;
+    pthread_mutex_unlock(&server->queueLock);
+
+    int changed = 0;
+    for (Session* session = done; session != NULL; session = session->next) {
+        if (!batchCommandReadOnly(session->command)) changed = 1;
+    }
+    if (changed) compactJournal(server);
+
+    while (done != NULL) {
+        Session* session = done;
+        done = session->next;
+        session->busy = 0;
+        if (session->hungUp) {
+            closeSession(server, session);
+            continue;
+        }
+        textAppend(&session->reply, session->result.data, session->result.size);
+        service(server, session);
+    }
+}
+
+static void sessionEvent(Server* server, Session* session, uint32_t events) {
+    if (session->fd < 0) return; // Closed earlier in this batch of events
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        hangUp(server, session);
+        return;
+    }
+    if ((events & EPOLLIN) && !receive(server, session)) return;
+    service(server, session);
+}
+
+// --- Setup ---
+
+static int openListener(Server* server, const char* socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("Error: Socket path %s is too long.\n", socketPath);
+        return 0;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    // A socket file left by a server that did not stop cleanly is replaced;
+    // a live server or any other kind of file is not.
+    struct stat info;
+    if (lstat(socketPath, &info) == 0) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        int live = probe >= 0 && connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (live || !S_ISSOCK(info.st_mode)) {
+            printf("Error: %s is %s.\n", socketPath, live ? "in use by a running server" : "not a socket");
+            return 0;
+        }
+        unlink(socketPath);
+    }
+
+    server->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listenFd < 0 || bind(server->listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server->listenFd, 64) != 0) {
+        printf("Error: Could not listen on %s.\n", socketPath);
+        if (server->listenFd >= 0) close(server->listenFd);
+        return 0;
+    }
+    return 1;
+}
+
+static int watchDescriptor(Server* server, int fd, int* tag) {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = tag;
+    return epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+int runServer(const char* socketPath) {
+    Server* server = (Server*)calloc(1, sizeof(Server));
+    if (server == NULL) {
+        printf("Error: Memory allocation failed!\n");
+        return 1;
+    }
+    if (!openListener(server, socketPath)) {
+        free(server);
+        return 1;
+    }
+    server->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    server->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server->consoleFd = dup(STDOUT_FILENO);
+    if (server->epollFd < 0 || server->wakeFd < 0 || server->consoleFd < 0 ||
+        !watchDescriptor(server, server->listenFd, &listenTag) || !watchDescriptor(server, server->wakeFd, &wakeTag)) {
+        printf("Error: Could not start the event loop.\n");
+        close(server->listenFd);
+        unlink(socketPath);
+        free(server);
+        return 1;
+    }
+
+    setLazyLoading(0); // Readers share the tree under the read lock, so nothing may fault in later
+    loadData(&server->teacherRoot, &server->studentRoot);
+    journalStart(&server->teacherRoot, &server->studentRoot);
+    pthread_rwlock_init(&server->dataLock, NULL);
+    pthread_mutex_init(&server->queueLock, NULL);
+    pthread_cond_init(&server->workReady, NULL);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop; // No SA_RESTART: epoll_wait returns EINTR
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Workers never take the stop signals, so they always interrupt the loop.
+    sigset_t stopSignals, previous;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &previous);
+    pthread_t workers[SERVER_WORKERS];
+    int started = 0;
+    while (started < SERVER_WORKERS && pthread_create(&workers[started], NULL, serverWorker, server) == 0) started++;
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    if (started == 0) {
+        printf("Error: Could not start any worker threads.\n");
+        stopRequested = 1;
+    } else {
+        fprintf(stderr, "Serving on %s with %d workers. Press Ctrl+C to stop.\n", socketPath, started);
+    }
+
+    struct epoll_event events[SERVER_EVENTS];
+    while (!stopRequested) {
+        int ready = epoll_wait(server->epollFd, events, SERVER_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: The event loop failed.\n");
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &listenTag) acceptSessions(server);
+            else if (tag == &wakeTag) finishCommands(server);
+            else sessionEvent(server, (Session*)tag, events[i].events);
+        }
+        while (server->closed != NULL) {
+            Session* session = server->closed;
+            server->closed = session->next;
+            freeSession(session);
+        }
+    }
+
+    pthread_mutex_lock(&server->queueLock);
+    server->stopping = 1;
+    pthread_cond_broadcast(&server->workReady);
+    pthread_mutex_unlock(&server->queueLock);
+    for (int t = 0; t < started; t++) pthread_join(workers[t], NULL);
+
+    printf("\nStopping server (%d session(s) open).\n", server->sessionCount);
+    for (int i = 0; i < server->sessionCount; i++) {
+        if (server->sessions[i]->fd >= 0) close(server->sessions[i]->fd);
+        freeSession(server->sessions[i]);
+    }
+    while (server->closed != NULL) {
+        Session* session = server->closed;
+        server->closed = session->next;
+        freeSession(session);
+    }
+    if (journalIsOpen()) journalSync();
+    else saveData(server->teacherRoot, server->studentRoot);
+    journalClose();
+    if (statsOn()) printStats(stdout);
+    releaseAllData();
+
+    close(server->listenFd);
+    close(server->wakeFd);
+    close(server->epollFd);
+    close(server->consoleFd);
+    unlink(socketPath);
+    pthread_cond_destroy(&server->workReady);
+    pthread_mutex_destroy(&server->queueLock);
+    pthread_rwlock_destroy(&server->dataLock);
+    free(server);
+    return 0;
+}
+
+#endif // __linux__
@@ -0,0 +1,35 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "student_tracker.h"
+
+// --- Server Mode ---
+//
+// "student_tracker --serve [socket]" loads the data once and keeps it in
+// memory while several teachers work on it at the same time, each through
+// their own connection to a local Unix socket ("student_tracker --connect",
+// see client.h).
+//
+// A connection is a session that speaks the batch command language (see
+// batch.h) and starts with a login command. The client sends one command
+// per line; the reply is everything the command printed, followed by a NUL
+// byte. A session's commands run in the order sent, one at a time.
+//
+// The main thread runs an epoll loop that accepts connections and does all
+// socket reads and writes. Commands run on SERVER_WORKERS worker threads
+// under a reader/writer lock over the data: commands that only read (list,
+// find, report, master, whoami, perf) run side by side, every other command
+// runs alone.
+//
+// Every change is journaled as usual. SIGINT or SIGTERM stops the server,
+// syncs the journal and removes the socket.
+
+#define SERVER_SOCKET "student_tracker.sock" // Default socket path
+#define SERVER_WORKERS 4
+#define SERVER_MAX_SESSIONS 256
+
+// Returns the process exit code. Linux only (epoll); elsewhere it reports
+// that server mode is unavailable.
+int runServer(const char* socketPath);
+
+#endif // SERVER_H
@@ -0,0 +1,567 @@
+#include "snapshot.h"
+#include "tree_cursor.h"
+#include "history.h"
+#include <stddef.h>
+
+#ifdef _WIN32
+#define SNAPSHOT_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --- Growable Byte Buffer ---
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+static int bufferReserve(ByteBuffer* buf, size_t extra) {
+    if (buf->size + extra <= buf->capacity) return 1;
+    size_t newCapacity = buf->capacity ? buf->capacity : 4096;
+    while (newCapacity < buf->size + extra) newCapacity *= 2;
+    char* newData = (char*)realloc(buf->data, newCapacity);
+    if (newData == NULL) return 0;
+    buf->data = newData;
+    buf->capacity = newCapacity;
+    return 1;
+}
+
+static int bufferAppend(ByteBuffer* buf, const void* bytes, size_t length) {
+    if (!bufferReserve(buf, length)) return 0;
+    memcpy(buf->data + buf->size, bytes, length);
+    buf->size += length;
+    return 1;
+}
+
+// --- String Table Builder (deduplicates repeated strings) ---
+
+typedef struct {
+    ByteBuffer text;
+    uint32_t* slots;     // Open-addressing table of (offset + 1), 0 = empty
+    size_t slotCount;
+    size_t used;
+} StringTableBuilder;
+
+static uint32_t hashString(const char* str) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int stringTableGrow(StringTableBuilder* table) {
+    size_t newCount = table->slotCount ? table->slotCount * 2 : 256;
+    uint32_t* newSlots = (uint32_t*)calloc(newCount, sizeof(uint32_t));
+    if (newSlots == NULL) return 0;
+    for (size_t i = 0; i < table->slotCount; i++) {
+        if (table->slots[i] == 0) continue;
+        const char* str = table->text.data + table->slots[i] - 1;
+        size_t pos = hashString(str) & (newCount - 1);
+        while (newSlots[pos] != 0) pos = (pos + 1) & (newCount - 1);
+        newSlots[pos] = table->slots[i];
+    }
+    free(table->slots);
+    table->slots = newSlots;
+    table->slotCount = newCount;
+    return 1;
+}
+
+// Returns the string's offset in the table, adding it on first use.
+static int stringTableIntern(StringTableBuilder* table, const char* str, uint32_t* offset) {
+    if ((table->used + 1) * 2 > table->slotCount && !stringTableGrow(table)) return 0;
+    size_t pos = hashString(str) & (table->slotCount - 1);
+    while (table->slots[pos] != 0) {
+        if (strcmp(table->text.data + table->slots[pos] - 1, str) == 0) {
+            *offset = table->slots[pos] - 1;
+            return 1;
+        }
+        pos = (pos + 1) & (table->slotCount - 1);
+    }
+    if (table->text.size >= UINT32_MAX - 1) return 0;
+    *offset = (uint32_t)table->text.size;
+    if (!bufferAppend(&table->text, str, strlen(str) + 1)) return 0;
+    table->slots[pos] = *offset + 1;
+    table->used++;
+    return 1;
+}
+
+// --- Snapshot Writer ---
+
+typedef struct {
+    StringTableBuilder strings;
+    ByteBuffer teachers;
+    ByteBuffer students;
+    ByteBuffer records;
+    uint32_t teacherCount;
+    uint32_t studentCount;
+    uint64_t recordCount;
+    uint32_t* symbolOffsets;     // String table offset per SymbolId, UINT32_MAX = not yet written
+    size_t symbolOffsetCount;
+    int failed;
+} SnapshotWriter;
+
+// Each interned symbol is hashed into the string table once per image;
+// every later record reuses its offset by id.
+static int writeSymbol(SnapshotWriter* writer, SymbolId id, uint32_t* offset) {
+    if (writer->symbolOffsets == NULL) {
+        writer->symbolOffsetCount = symbolCount();
+        writer->symbolOffsets = (uint32_t*)malloc(writer->symbolOffsetCount * sizeof(uint32_t));
+        if (writer->symbolOffsets == NULL) return 0;
+        memset(writer->symbolOffsets, 0xFF, writer->symbolOffsetCount * sizeof(uint32_t));
+    }
+    if (id < writer->symbolOffsetCount && writer->symbolOffsets[id] != UINT32_MAX) {
+        *offset = writer->symbolOffsets[id];
+        return 1;
+    }
+    if (!stringTableIntern(&writer->strings, symbolText(id), offset)) return 0;
+    if (id < writer->symbolOffsetCount) writer->symbolOffsets[id] = *offset;
+    return 1;
+}
+
+// Pre-order, so re-inserting in file order reproduces the same teacher tree.
+static void writeTeacherTree(SnapshotWriter* writer, TeacherNode* root) {
+    TreeCursor cursor;
+    TeacherNode* teacher;
+    openTeacherCursor(&cursor, root, CURSOR_PRE_ORDER);
+    while (!writer->failed && (teacher = nextTeacher(&cursor)) != NULL) {
+        SnapshotTeacher entry;
+        if (!stringTableIntern(&writer->strings, teacher->teacherID, &entry.id) ||
+            !stringTableIntern(&writer->strings, teacher->name, &entry.name) ||
+            !stringTableIntern(&writer->strings, teacher->password, &entry.password) ||
+            !stringTableIntern(&writer->strings, teacher->subject, &entry.subject) ||
+            !bufferAppend(&writer->teachers, &entry, sizeof(entry))) {
+            writer->failed = 1;
+            break;
+        }
+        writer->teacherCount++;
+    }
+    if (cursor.failed) writer->failed = 1;
+    closeCursor(&cursor);
+}
+
+static void writeStudent(SnapshotWriter* writer, StudentNode* student) {
+    if (writer->failed) return;
+    SnapshotStudent entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.firstRecord = writer->recordCount;
+    if (!stringTableIntern(&writer->strings, student->studentSRN, &entry.srn) ||
+        !stringTableIntern(&writer->strings, student->name, &entry.name)) {
+        writer->failed = 1;
+        return;
+    }
+    HistoryCursor history;
+    PerformanceRecord current;
+    openHistoryCursor(&history, student);
+    while (nextHistoryRecord(&history, &current)) {
+        SnapshotRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = (uint8_t)current.type;
+        record.value = current.value;
+        if (!writeSymbol(writer, current.subject, &record.subject) ||
+            !writeSymbol(writer, current.description, &record.description) ||
+            !bufferAppend(&writer->records, &record, sizeof(record))) {
+            writer->failed = 1;
+            return;
+        }
+        entry.recordCount++;
+        writer->recordCount++;
+    }
+    // Attendance sessions follow as ordinary ATTENDANCE records.
+    size_t cursor = 0;
+    AttendanceEntry attendance;
+    while (nextAttendance(student->ordinal, &cursor, &attendance)) {
+        SnapshotRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = (uint8_t)ATTENDANCE;
+        record.value = attendance.present;
+        if (!writeSymbol(writer, attendance.subject, &record.subject) ||
+            !writeSymbol(writer, attendance.date, &record.description) ||
+            !bufferAppend(&writer->records, &record, sizeof(record))) {
+            writer->failed = 1;
+            return;
+        }
+        entry.recordCount++;
+        writer->recordCount++;
+    }
+    if (!bufferAppend(&writer->students, &entry, sizeof(entry))) {
+        writer->failed = 1;
+        return;
+    }
+    writer->studentCount++;
+}
+
+// In-order, so the student section is sorted by SRN.
+static void writeStudentTree(SnapshotWriter* writer, StudentNode* root) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while (!writer->failed && (student = nextStudent(&cursor)) != NULL) writeStudent(writer, student);
+    closeCursor(&cursor);
+}
+
+static void freeWriter(SnapshotWriter* writer) {
+    free(writer->strings.text.data);
+    free(writer->strings.slots);
+    free(writer->teachers.data);
+    free(writer->students.data);
+    free(writer->records.data);
+    free(writer->symbolOffsets);
+}
+
+// Terminates the string table and fills in the header. Returns 0 on failure.
+static int finishWriter(SnapshotWriter* writer, SnapshotHeader* header, uint64_t* padding) {
+    // Keep the table non-empty and NUL-terminated so the loader can bound-check cheaply.
+    uint32_t unused;
+    if (!stringTableIntern(&writer->strings, "", &unused)) writer->failed = 1;
+    if (writer->failed) return 0;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->byteOrderMark = SNAPSHOT_BYTE_ORDER_MARK;
+    header->teacherCount = writer->teacherCount;
+    header->studentCount = writer->studentCount;
+    header->recordCount = writer->recordCount;
+    header->stringTableOffset = sizeof(*header);
+    header->stringTableSize = writer->strings.text.size;
+    // Pad so the fixed-size sections are 8-byte aligned inside the mapping.
+    *padding = (8 - (header->stringTableOffset + header->stringTableSize) % 8) % 8;
+    header->teacherOffset = header->stringTableOffset + header->stringTableSize + *padding;
+    header->studentOffset = header->teacherOffset + writer->teachers.size;
+    header->recordOffset = header->studentOffset + writer->students.size;
+    header->fileSize = header->recordOffset + writer->records.size;
+    header->journalSequence = getDataSequence();
+    return 1;
+}
+
+int saveSnapshot(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    SnapshotWriter writer;
+    memset(&writer, 0, sizeof(writer));
+
+    writeTeacherTree(&writer, teacherRoot);
+    writeStudentTree(&writer, studentRoot);
+
+    SnapshotHeader header;
+    uint64_t padding;
+    if (!finishWriter(&writer, &header, &padding)) {
+        freeWriter(&writer);
+        return 0;
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        freeWriter(&writer);
+        return 0;
+    }
+    static const char zeros[8] = {0};
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(writer.strings.text.data, 1, writer.strings.text.size, fp) == writer.strings.text.size &&
+             fwrite(zeros, 1, (size_t)padding, fp) == padding &&
+             fwrite(writer.teachers.data, 1, writer.teachers.size, fp) == writer.teachers.size &&
+             fwrite(writer.students.data, 1, writer.students.size, fp) == writer.students.size &&
+             fwrite(writer.records.data, 1, writer.records.size, fp) == writer.records.size;
+    if (fclose(fp) != 0) ok = 0;
+    freeWriter(&writer);
+    return ok;
+}
+
+char* encodeSnapshotImage(TeacherNode* teacherRoot, StudentNode** students, size_t count, size_t* size) {
+    SnapshotWriter writer;
+    memset(&writer, 0, sizeof(writer));
+
+    writeTeacherTree(&writer, teacherRoot);
+    for (size_t i = 0; i < count; i++) writeStudent(&writer, students[i]);
+
+    SnapshotHeader header;
+    uint64_t padding;
+    char* image = NULL;
+    if (finishWriter(&writer, &header, &padding)) {
+        image = (char*)calloc(1, (size_t)header.fileSize);
+    }
+    if (image != NULL) {
+        memcpy(image, &header, sizeof(header));
+        // An empty section never allocated its buffer.
+        if (writer.strings.text.size) memcpy(image + header.stringTableOffset, writer.strings.text.data, writer.strings.text.size);
+        if (writer.teachers.size) memcpy(image + header.teacherOffset, writer.teachers.data, writer.teachers.size);
+        if (writer.students.size) memcpy(image + header.studentOffset, writer.students.data, writer.students.size);
+        if (writer.records.size) memcpy(image + header.recordOffset, writer.records.data, writer.records.size);
+        *size = (size_t)header.fileSize;
+    }
+    freeWriter(&writer);
+    return image;
+}
+
+// --- Snapshot Loader ---
+
+int isSnapshotFile(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    char magic[8];
+    int match = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+                memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    fclose(fp);
+    return match;
+}
+
+int mapDataFile(const char* path, MappedFile* file) {
+#ifdef SNAPSHOT_NO_MMAP
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char* data = (size > 0) ? (char*)malloc((size_t)size) : NULL;
+    if (data == NULL || fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        free(data);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    file->data = data;
+    file->size = (size_t)size;
+    return 1;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed
+    if (data == MAP_FAILED) return 0;
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    file->data = (const char*)data;
+    file->size = (size_t)st.st_size;
+    return 1;
+#endif
+}
+
+void unmapDataFile(MappedFile* file) {
+#ifdef SNAPSHOT_NO_MMAP
+    free((void*)file->data);
+#else
+    munmap((void*)file->data, file->size);
+#endif
+}
+
+// Checks that a string offset is inside the table and fits in a field of 'fieldSize'.
+static int validString(const char* strings, uint64_t tableSize, uint32_t offset, size_t fieldSize) {
+    if (offset >= tableSize) return 0;
+    size_t remaining = (size_t)(tableSize - offset);
+    size_t limit = remaining < fieldSize ? remaining : fieldSize;
+    return memchr(strings + offset, '\0', limit) != NULL;
+}
+
+static int sectionFits(const SnapshotHeader* header, uint64_t offset, uint64_t count, size_t entrySize) {
+    if (offset % 8 != 0 || offset > header->fileSize) return 0;
+    if (count > (header->fileSize - offset) / entrySize) return 0;
+    return 1;
+}
+
+// Validates every offset and count up front so that a corrupt file is
+// rejected before any node is allocated.
+static int validateSnapshot(const MappedFile* file, const SnapshotHeader** out) {
+    // Version 1 headers end just before journalSequence.
+    const size_t v1HeaderSize = offsetof(SnapshotHeader, journalSequence);
+    if (file->size < sizeof(SnapshotHeader)) return 0;
+    const SnapshotHeader* header = (const SnapshotHeader*)file->data;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) return 0;
+    if (header->version != 1 && header->version != SNAPSHOT_VERSION) return 0;
+    size_t headerSize = (header->version == 1) ? v1HeaderSize : sizeof(SnapshotHeader);
+    if (header->byteOrderMark != SNAPSHOT_BYTE_ORDER_MARK) return 0;
+    if (header->fileSize != file->size) return 0;
+    if (header->stringTableOffset != headerSize || header->stringTableSize == 0) return 0;
+    if (header->stringTableSize > header->fileSize - header->stringTableOffset) return 0;
+    if (header->teacherOffset < header->stringTableOffset + header->stringTableSize) return 0;
+    if (!sectionFits(header, header->teacherOffset, header->teacherCount, sizeof(SnapshotTeacher)) ||
+        !sectionFits(header, header->studentOffset, header->studentCount, sizeof(SnapshotStudent)) ||
+        !sectionFits(header, header->recordOffset, header->recordCount, sizeof(SnapshotRecord))) {
+        return 0;
+    }
+
+    const char* strings = file->data + header->stringTableOffset;
+    uint64_t tableSize = header->stringTableSize;
+    if (strings[tableSize - 1] != '\0') return 0;
+
+    const SnapshotTeacher* teachers = (const SnapshotTeacher*)(file->data + header->teacherOffset);
+    for (uint32_t i = 0; i < header->teacherCount; i++) {
+        if (!validString(strings, tableSize, teachers[i].id, sizeof(((TeacherNode*)0)->teacherID)) ||
+            !validString(strings, tableSize, teachers[i].name, sizeof(((TeacherNode*)0)->name)) ||
+            !validString(strings, tableSize, teachers[i].password, sizeof(((TeacherNode*)0)->password)) ||
+            !validString(strings, tableSize, teachers[i].subject, sizeof(((TeacherNode*)0)->subject))) {
+            return 0;
+        }
+    }
+
+    const SnapshotStudent* students = (const SnapshotStudent*)(file->data + header->studentOffset);
+    for (uint32_t i = 0; i < header->studentCount; i++) {
+        if (!validString(strings, tableSize, students[i].srn, sizeof(((StudentNode*)0)->studentSRN)) ||
+            !validString(strings, tableSize, students[i].name, sizeof(((StudentNode*)0)->name))) {
+            return 0;
+        }
+        if (students[i].firstRecord > header->recordCount ||
+            students[i].recordCount > header->recordCount - students[i].firstRecord) {
+            return 0;
+        }
+    }
+
+    const SnapshotRecord* records = (const SnapshotRecord*)(file->data + header->recordOffset);
+    for (uint64_t i = 0; i < header->recordCount; i++) {
+        if (records[i].type > SEMESTER_EXAM ||
+            !validString(strings, tableSize, records[i].subject, RECORD_TEXT_SIZE) ||
+            !validString(strings, tableSize, records[i].description, RECORD_TEXT_SIZE)) {
+            return 0;
+        }
+    }
+
+    *out = header;
+    return 1;
+}
+
+// Maps string table offsets to interned ids. The table stores each string
+// once, so an offset identifies its text and most records hit the cache
+// instead of hashing their subject and description again.
+#define SYMBOL_CACHE_SIZE 1024
+
+typedef struct {
+    uint32_t offset;
+    SymbolId id;
+} SymbolCacheEntry;
+
+static SymbolId cachedSymbol(SymbolCacheEntry* cache, const char* strings, uint32_t offset) {
+    SymbolCacheEntry* entry = &cache[(offset * 2654435761u) >> 22]; // Top 10 bits
+    if (entry->offset != offset) {
+        entry->offset = offset;
+        entry->id = internSymbol(strings + offset);
+    }
+    return entry->id;
+}
+
+// Appends one student's records to 'student', in file order so the history
+// keeps its newest-first order. Returns 0 if memory runs out.
+static int appendSnapshotRecords(const char* strings, const SnapshotRecord* records, const SnapshotStudent* entry,
+                                 SymbolCacheEntry* cache, StudentNode* student) {
+    const SnapshotRecord* record = records + entry->firstRecord;
+    for (uint32_t r = 0; r < entry->recordCount; r++, record++) {
+        SymbolId subject = cachedSymbol(cache, strings, record->subject);
+        SymbolId description = cachedSymbol(cache, strings, record->description);
+        if (subject == SYMBOL_INVALID || description == SYMBOL_INVALID ||
+            !appendPerformanceRecord(student, (RecordType)record->type, record->value, subject, description)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Rebuilds the trees from a validated image. Returns 0 if memory ran out
+// part way; nodes already collected stay in 'batch'.
+static int buildFromSnapshot(const MappedFile* file, const SnapshotHeader* header,
+                             TeacherNode** teacherRoot, StudentBatch* batch) {
+    // Strings are used in place from the mapping; only the node copies are made.
+    char* strings = (char*)file->data + header->stringTableOffset;
+    const SnapshotTeacher* teachers = (const SnapshotTeacher*)(file->data + header->teacherOffset);
+    const SnapshotStudent* students = (const SnapshotStudent*)(file->data + header->studentOffset);
+    const SnapshotRecord* records = (const SnapshotRecord*)(file->data + header->recordOffset);
+
+    for (uint32_t i = 0; i < header->teacherCount; i++) {
+        *teacherRoot = addTeacher(*teacherRoot, strings + teachers[i].id, strings + teachers[i].name,
+                                  strings + teachers[i].password, strings + teachers[i].subject);
+    }
+
+    SymbolCacheEntry cache[SYMBOL_CACHE_SIZE];
+    memset(cache, 0xFF, sizeof(cache));
+
+    // Students are stored sorted by SRN, so the batch builds without sorting.
+    for (uint32_t i = 0; i < header->studentCount; i++) {
+        StudentNode* student = createStudent(strings + students[i].srn, strings + students[i].name);
+        if (student == NULL || !studentBatchAdd(batch, student)) {
+            freeStudent(student);
+            return 0;
+        }
+        if (!appendSnapshotRecords(strings, records, &students[i], cache, student)) return 0;
+    }
+    return 1;
+}
+
+int decodeSnapshotImage(const char* data, size_t size, TeacherNode** teacherRoot, StudentBatch* batch) {
+    MappedFile image = { data, size };
+    const SnapshotHeader* header;
+    if (!validateSnapshot(&image, &header)) return 0;
+    return buildFromSnapshot(&image, header, teacherRoot, batch);
+}
+
+// Students are sorted by SRN, so one binary search finds the entry and only
+// that student's records are built.
+int decodeSnapshotStudent(const char* data, size_t size, const char* srn, StudentNode** student) {
+    MappedFile image = { data, size };
+    const SnapshotHeader* header;
+    *student = NULL;
+    if (!validateSnapshot(&image, &header)) return 0;
+    char* strings = (char*)data + header->stringTableOffset;
+    const SnapshotStudent* students = (const SnapshotStudent*)(data + header->studentOffset);
+    const SnapshotRecord* records = (const SnapshotRecord*)(data + header->recordOffset);
+
+    uint32_t low = 0, high = header->studentCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (strcmp(strings + students[mid].srn, srn) < 0) low = mid + 1;
+        else high = mid;
+    }
+    if (low == header->studentCount || strcmp(strings + students[low].srn, srn) != 0) return 1;
+
+    SymbolCacheEntry cache[SYMBOL_CACHE_SIZE];
+    memset(cache, 0xFF, sizeof(cache));
+    StudentNode* found = createStudent(strings + students[low].srn, strings + students[low].name);
+    if (found == NULL) return 0;
+    if (!appendSnapshotRecords(strings, records, &students[low], cache, found)) {
+        freeStudent(found);
+        return 0;
+    }
+    *student = found;
+    return 1;
+}
+
+int decodeSnapshotHistories(const char* data, size_t size, StudentNode** nodes, uint32_t count) {
+    MappedFile image = { data, size };
+    const SnapshotHeader* header;
+    if (!validateSnapshot(&image, &header) || header->studentCount != count) return 0;
+    const char* strings = data + header->stringTableOffset;
+    const SnapshotStudent* students = (const SnapshotStudent*)(data + header->studentOffset);
+    const SnapshotRecord* records = (const SnapshotRecord*)(data + header->recordOffset);
+
+    SymbolCacheEntry cache[SYMBOL_CACHE_SIZE];
+    memset(cache, 0xFF, sizeof(cache));
+    for (uint32_t i = 0; i < count; i++) {
+        if (nodes[i] != NULL && !appendSnapshotRecords(strings, records, &students[i], cache, nodes[i])) return 0;
+    }
+    return 1;
+}
+
+int loadSnapshot(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    MappedFile file;
+    if (!mapDataFile(path, &file)) return 0;
+
+    const SnapshotHeader* header;
+    if (!validateSnapshot(&file, &header)) {
+        unmapDataFile(&file);
+        return 0;
+    }
+
+    setDataSequence(header->version == 1 ? 0 : header->journalSequence);
+    StudentBatch batch = { NULL, 0, 0 };
+    int ok = buildFromSnapshot(&file, header, teacherRoot, &batch) &&
+             finishStudentBatch(&batch, studentRoot);
+    if (!ok) discardStudentBatch(&batch);
+
+    unmapDataFile(&file);
+    return ok;
+}
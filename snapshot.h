@@ -0,0 +1,104 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "student_tracker.h"
+#include "bulk_load.h"
+#include <stdint.h>
+
+// --- Binary Snapshot Format ---
+//
+// A snapshot is laid out as:
+//
+//   SnapshotHeader
+//   string table   (NUL-terminated strings, each distinct string stored once)
+//   teacher section (teacherCount x SnapshotTeacher, pre-order)
+//   student section (studentCount x SnapshotStudent, sorted by SRN)
+//   record section  (recordCount  x SnapshotRecord, grouped by student)
+//
+// All strings are referenced by their byte offset into the string table.
+// Integers are stored in host byte order; the header's byteOrderMark lets a
+// reader on a different architecture reject the file instead of misreading it.
+
+#define SNAPSHOT_MAGIC "STRKSNAP"
+#define SNAPSHOT_VERSION 2           // v2 adds journalSequence; v1 files still load
+#define SNAPSHOT_BYTE_ORDER_MARK 0x01020304u
+
+typedef struct {
+    char magic[8];               // SNAPSHOT_MAGIC (not NUL-terminated)
+    uint32_t version;            // SNAPSHOT_VERSION
+    uint32_t byteOrderMark;      // SNAPSHOT_BYTE_ORDER_MARK
+    uint32_t teacherCount;
+    uint32_t studentCount;
+    uint64_t recordCount;
+    uint64_t stringTableOffset;
+    uint64_t stringTableSize;
+    uint64_t teacherOffset;
+    uint64_t studentOffset;
+    uint64_t recordOffset;
+    uint64_t fileSize;           // Lets the loader detect truncated files
+    uint64_t journalSequence;    // Last journal entry included (see journal.h)
+} SnapshotHeader;
+
+typedef struct {
+    uint32_t id;                 // String table offsets
+    uint32_t name;
+    uint32_t password;
+    uint32_t subject;
+} SnapshotTeacher;
+
+typedef struct {
+    uint32_t srn;                // String table offsets
+    uint32_t name;
+    uint32_t recordCount;        // Records belonging to this student
+    uint32_t reserved;
+    uint64_t firstRecord;        // Index into the record section
+} SnapshotStudent;
+
+typedef struct {
+    uint8_t type;                // RecordType
+    uint8_t reserved[3];
+    int32_t value;
+    uint32_t subject;            // String table offsets
+    uint32_t description;
+} SnapshotRecord;
+
+// A read-only view of a whole file (memory-mapped where available)
+typedef struct {
+    const char* data;
+    size_t size;
+} MappedFile;
+
+int mapDataFile(const char* path, MappedFile* file);
+void unmapDataFile(MappedFile* file);
+
+// Returns 1 if the file at 'path' starts with the snapshot magic.
+int isSnapshotFile(const char* path);
+
+// Writes both trees as a snapshot. Returns 1 on success, 0 on failure.
+int saveSnapshot(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot);
+
+// Maps the snapshot and rebuilds both trees. Returns 1 on success, 0 if the
+// file is missing, truncated or malformed (the trees are left untouched).
+int loadSnapshot(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+
+// Encodes the teachers (may be NULL) and a sorted run of students as a
+// complete snapshot image in memory. Returns a malloc'd buffer or NULL.
+char* encodeSnapshotImage(TeacherNode* teacherRoot, StudentNode** students, size_t count, size_t* size);
+
+// Validates an in-memory image, adds its teachers to the tree and collects
+// its students into 'batch' (see bulk_load.h). Returns 0 if the image is
+// malformed (adding nothing) or memory runs out.
+int decodeSnapshotImage(const char* data, size_t size, TeacherNode** teacherRoot, StudentBatch* batch);
+
+// Finds one student in a validated image and builds just that node, with
+// its history, detached from the tree (free it with freeStudent). Sets
+// *student to NULL if the SRN is not in the image. Returns 0 if the image is
+// malformed or memory runs out.
+int decodeSnapshotStudent(const char* data, size_t size, const char* srn, StudentNode** student);
+
+// Appends the records of the image's i-th student to nodes[i], skipping
+// NULL entries. The image must hold exactly 'count' students. Returns 0 if
+// it is malformed (adding nothing) or memory runs out part way.
+int decodeSnapshotHistories(const char* data, size_t size, StudentNode** nodes, uint32_t count);
+
+#endif // SNAPSHOT_H
@@ -1,72 +1,213 @@
 #include "student_tracker.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "segment_store.h"
+#include "block_store.h"
+#include "bulk_load.h"
+#include "node_pool.h"
+#include "key_index.h"
+#include "name_index.h"
+#include "report_writer.h"
+#include "op_stats.h"
+#include "tree_cursor.h"
+#include "history.h"
 #include <string.h>
+#include <sys/stat.h>
+
+// Every teacher and student is allocated from these pools (history chunks
+// have their own, see history.c). Freed nodes are threaded through their
+// left pointers.
+static NodePool teacherPool = NODE_POOL_INIT(TeacherNode, left);
+static NodePool studentPool = NODE_POOL_INIT(StudentNode, left);
+
+// Hash indexes over every student and teacher linked into a tree, for
+// lookupStudent and lookupTeacher. If an index ever fails to grow it is
+// marked partial and lookups fall back to walking the tree.
+static KeyIndex studentKeys = KEY_INDEX_INIT;
+static KeyIndex teacherKeys = KEY_INDEX_INIT;
+static int studentKeysPartial = 0;
+static int teacherKeysPartial = 0;
 
-#define SAVE_FILE "data.dat" // Define the save file name
 
 // --- File I/O Function Implementations ---
 
 // Helper to save a single student's history
-void saveHistory(PerformanceNode* head, FILE* fp) {
-    PerformanceNode* current = head;
-    while (current != NULL) {
+void saveHistory(StudentNode* student, FILE* fp) {
+    HistoryCursor cursor;
+    PerformanceRecord record;
+    openHistoryCursor(&cursor, student);
+    while (nextHistoryRecord(&cursor, &record)) {
         fprintf(fp, "RECORD\n");
-        fprintf(fp, "%d\n", (int)current->type);
-        fprintf(fp, "%d\n", current->value);
-        fprintf(fp, "%s\n", current->subject);
-        fprintf(fp, "%s\n", current->description);
-        current = current->next;
+        fprintf(fp, "%d\n", (int)record.type);
+        fprintf(fp, "%d\n", record.value);
+        fprintf(fp, "%s\n", symbolText(record.subject));
+        fprintf(fp, "%s\n", symbolText(record.description));
     }
 }
 
-// Helper to save the student tree (pre-order traversal)
-void saveStudentTree(StudentNode* root, FILE* fp) {
-    if (root == NULL) return;
-    
-    fprintf(fp, "STUDENT\n");
-    fprintf(fp, "%s\n", root->studentSRN);
-    fprintf(fp, "%s\n", root->name);
-    
-    saveHistory(root->historyHead, fp);
-    
-    saveStudentTree(root->left, fp);
-    saveStudentTree(root->right, fp);
+// Attendance lives in the session bitmaps; it is written out as ordinary
+// ATTENDANCE records after the history, so loaders read it back unchanged.
+static void saveAttendance(StudentNode* student, FILE* fp) {
+    size_t cursor = 0;
+    AttendanceEntry entry;
+    while (nextAttendance(student->ordinal, &cursor, &entry)) {
+        fprintf(fp, "RECORD\n");
+        fprintf(fp, "%d\n", (int)ATTENDANCE);
+        fprintf(fp, "%d\n", entry.present);
+        fprintf(fp, "%s\n", symbolText(entry.subject));
+        fprintf(fp, "%s\n", symbolText(entry.date));
+    }
 }
 
-// Helper to save the teacher tree (pre-order traversal)
-void saveTeacherTree(TeacherNode* root, FILE* fp) {
-    if (root == NULL) return;
-    
-    fprintf(fp, "TEACHER\n");
-    fprintf(fp, "%s\n", root->teacherID);
-    fprintf(fp, "%s\n", root->name);
-    fprintf(fp, "%s\n", root->password);
-    fprintf(fp, "%s\n", root->subject);
-    
-    saveTeacherTree(root->left, fp);
-    saveTeacherTree(root->right, fp);
+// Helper to save the student tree (in-order traversal, so the loader sees sorted SRNs)
+static int saveStudentTree(StudentNode* root, FILE* fp) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) {
+        fprintf(fp, "STUDENT\n");
+        fprintf(fp, "%s\n", student->studentSRN);
+        fprintf(fp, "%s\n", student->name);
+
+        saveHistory(student, fp);
+        saveAttendance(student, fp);
+    }
+    int ok = !cursor.failed;
+    closeCursor(&cursor);
+    return ok;
+}
+
+// Helper to save the teacher tree (pre-order traversal, so reloading
+// rebuilds the same tree). Returns 0 if the walk ran out of memory.
+static int saveTeacherTree(TeacherNode* root, FILE* fp) {
+    TreeCursor cursor;
+    TeacherNode* teacher;
+    openTeacherCursor(&cursor, root, CURSOR_PRE_ORDER);
+    while ((teacher = nextTeacher(&cursor)) != NULL) {
+        fprintf(fp, "TEACHER\n");
+        fprintf(fp, "%s\n", teacher->teacherID);
+        fprintf(fp, "%s\n", teacher->name);
+        fprintf(fp, "%s\n", teacher->password);
+        fprintf(fp, "%s\n", teacher->subject);
+    }
+    int ok = !cursor.failed;
+    closeCursor(&cursor);
+    return ok;
+}
+
+// Format used by saveData. Text and monolithic snapshots are still read, but
+// saving defaults to the segmented layout so only changed segments are rewritten.
+static DataFormat saveFormat = DATA_FORMAT_SEGMENTED;
+
+// Sequence number of the last journal entry reflected in memory. It is
+// stored in the save file so journal replay can skip entries already saved.
+static uint64_t dataSequence = 0;
+
+void setDataSequence(uint64_t sequence) {
+    dataSequence = sequence;
+}
+
+uint64_t getDataSequence(void) {
+    return dataSequence;
+}
+
+static int lazyLoading = 0;
+
+void initLazyLoading(void) {
+    const char* env = getenv("TRACKER_LAZY");
+    if (env == NULL || env[0] == '\0' || strcmp(env, "0") == 0) return;
+    lazyLoading = 1;
+    saveFormat = DATA_FORMAT_BLOCKS;
+}
+
+void setLazyLoading(int enabled) {
+    lazyLoading = enabled;
+}
+
+void setSaveFormat(DataFormat format) {
+    saveFormat = format;
+}
+
+DataFormat getSaveFormat(void) {
+    return saveFormat;
+}
+
+// Size of 'path' in bytes, 0 if it does not exist. Only used for statistics.
+static uint64_t fileSize(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0 ? (uint64_t)info.st_size : 0;
+}
+
+static int writeTextFile(const char* path, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) return 0;
+
+    if (!saveTeacherTree(teacherRoot, fp) || !saveStudentTree(studentRoot, fp)) {
+        fclose(fp);
+        return 0;
+    }
+    if (dataSequence > 0) {
+        fprintf(fp, "SEQUENCE\n%llu\n", (unsigned long long)dataSequence);
+    }
+
+    fprintf(fp, "END_OF_FILE\n");
+
+    return fclose(fp) == 0;
+}
+
+// Writes both trees to 'path'. Returns 1 on success, 0 on failure.
+int saveDataToFile(const char* path, DataFormat format, TeacherNode* teacherRoot, StudentNode* studentRoot) {
+    uint64_t started = STAT_START();
+    uint64_t sizeBefore = (started && format == DATA_FORMAT_SEGMENTED) ? fileSize(path) : 0;
+    if (!faultInAllHistories()) return 0; // Never save a student without its records
+    int ok;
+    if (format == DATA_FORMAT_SEGMENTED) {
+        ok = saveSegmentStore(path, teacherRoot, studentRoot);
+    } else if (format == DATA_FORMAT_BINARY) {
+        ok = saveSnapshot(path, teacherRoot, studentRoot);
+    } else if (format == DATA_FORMAT_BLOCKS) {
+        ok = saveBlockStore(path, teacherRoot, studentRoot);
+    } else {
+        ok = writeTextFile(path, teacherRoot, studentRoot);
+    }
+    if (started && ok) {
+        // A segment store only appends what changed, unless it was rewritten.
+        uint64_t sizeAfter = fileSize(path);
+        STAT_STOP(STAT_SAVE_DATA, started, sizeAfter > sizeBefore ? sizeAfter - sizeBefore : sizeAfter);
+    }
+    return ok;
 }
 
 // Main save function
 void saveData(TeacherNode* teacherRoot, StudentNode* studentRoot) {
-    FILE* fp = fopen(SAVE_FILE, "w");
-    if (fp == NULL) {
+    uint32_t epoch = beginSaveEpoch();
+    if (!saveDataToFile(SAVE_FILE, saveFormat, teacherRoot, studentRoot)) {
         printf("Error: Could not open file %s for writing.\n", SAVE_FILE);
         return;
     }
-    
-    saveTeacherTree(teacherRoot, fp);
-    saveStudentTree(studentRoot, fp);
-    
-    fprintf(fp, "END_OF_FILE\n");
-    
-    fclose(fp);
+    confirmSaveEpoch(epoch, SAVE_FILE);
     printf("All data saved successfully to %s.\n", SAVE_FILE);
 }
 
-// Helper function to read a line safely from a file
-void readLineFromFile(char* buffer, int size, FILE* fp) {
-    fgets(buffer, size, fp);
-    buffer[strcspn(buffer, "\n")] = 0; // Remove newline
+// Loads 'path' in whichever format it was written. Returns 1 on success,
+// 0 if the file is missing or is a binary file that fails validation.
+int loadDataFromFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    uint64_t started = STAT_START();
+    if (isSegmentStoreFile(path)) {
+        if (!loadSegmentStore(path, teacherRoot, studentRoot)) return 0;
+    } else if (isSnapshotFile(path)) {
+        if (!loadSnapshot(path, teacherRoot, studentRoot)) return 0;
+    } else if (isBlockStoreFile(path)) {
+        int loaded = lazyLoading ? openLazyBlockStore(path, teacherRoot, studentRoot)
+                                 : loadBlockStore(path, teacherRoot, studentRoot);
+        if (!loaded) return 0;
+    } else {
+        dataSequence = 0;
+        if (!bulkLoadTextFile(path, teacherRoot, studentRoot)) return 0;
+    }
+    clearDirtyState(); // Memory now matches the file
+    STAT_STOP(STAT_LOAD_DATA, started, started ? fileSize(path) : 0);
+    return 1;
 }
 
 // Main load function
@@ -76,48 +217,19 @@ void loadData(TeacherNode** teacherRoot, StudentNode** studentRoot) {
         printf("No save file found. Starting with a fresh database.\n");
         return;
     }
-    
-    char lineBuffer[100];
-    char nameBuffer[100], idBuffer[20], pwBuffer[50], subjectBuffer[50], descBuffer[50];
-    int tempType, tempValue;
-    
-    StudentNode* lastStudent = NULL;
-    
-    while (fscanf(fp, "%s", lineBuffer) != EOF && strcmp(lineBuffer, "END_OF_FILE") != 0) {
-        fgetc(fp); // Consume the newline
-        
-        if (strcmp(lineBuffer, "TEACHER") == 0) {
-            readLineFromFile(idBuffer, 20, fp);
-            readLineFromFile(nameBuffer, 100, fp);
-            readLineFromFile(pwBuffer, 50, fp);
-            readLineFromFile(subjectBuffer, 50, fp);
-            *teacherRoot = addTeacher(*teacherRoot, idBuffer, nameBuffer, pwBuffer, subjectBuffer);
-            
-        } else if (strcmp(lineBuffer, "STUDENT") == 0) {
-            readLineFromFile(idBuffer, 20, fp);
-            readLineFromFile(nameBuffer, 100, fp);
-            *studentRoot = addStudent(*studentRoot, idBuffer, nameBuffer);
-            lastStudent = findStudent(*studentRoot, idBuffer);
-            
-        } else if (strcmp(lineBuffer, "RECORD") == 0) {
-            if (lastStudent == NULL) continue;
-            
-            fscanf(fp, "%d", &tempType); fgetc(fp);
-            fscanf(fp, "%d", &tempValue); fgetc(fp);
-            readLineFromFile(subjectBuffer, 50, fp);
-            readLineFromFile(descBuffer, 50, fp);
-            addPerformanceRecord(lastStudent, (RecordType)tempType, tempValue, subjectBuffer, descBuffer);
-        }
-    }
-    
     fclose(fp);
+
+    if (!loadDataFromFile(SAVE_FILE, teacherRoot, studentRoot)) {
+        printf("Error: %s is corrupt or from an unsupported version. Starting with a fresh database.\n", SAVE_FILE);
+        return;
+    }
     printf("Data loaded successfully from %s.\n", SAVE_FILE);
 }
 
 // --- Teacher Function Implementations ---
 
 TeacherNode* createTeacher(char* id, char* name, char* password, char* subject) {
-    TeacherNode* newNode = (TeacherNode*)malloc(sizeof(TeacherNode));
+    TeacherNode* newNode = (TeacherNode*)poolAlloc(&teacherPool);
     if (newNode == NULL) return NULL;
     
     strcpy(newNode->teacherID, id);
@@ -125,37 +237,60 @@ TeacherNode* createTeacher(char* id, char* name, char* password, char* subject)
     strcpy(newNode->password, password);
     strcpy(newNode->subject, subject);
     newNode->failedAttempts = 0; // Initialize security counter
+    newNode->dirtyEpoch = 0;
     newNode->left = NULL;
     newNode->right = NULL;
     
     return newNode;
 }
 
+// The teacher tree is not balanced, so this walks down to the empty link
+// in a loop rather than recursing once per level.
+static TeacherNode* insertTeacher(TeacherNode* root, char* id, char* name, char* password, char* subject, TeacherNode** inserted) {
+    TeacherNode** link = &root;
+    while (*link != NULL) {
+        int compare = strcmp(id, (*link)->teacherID);
+        if (compare == 0) {
+            printf("Error: Teacher ID %s already exists.\n", id);
+            return root;
+        }
+        link = (compare < 0) ? &(*link)->left : &(*link)->right;
+    }
+    *inserted = createTeacher(id, name, password, subject);
+    if (*inserted != NULL && !keyIndexPut(&teacherKeys, (*inserted)->teacherID, *inserted)) teacherKeysPartial = 1;
+    *link = *inserted;
+    return root;
+}
+
 TeacherNode* addTeacher(TeacherNode* root, char* id, char* name, char* password, char* subject) {
-    if (root == NULL) {
-        return createTeacher(id, name, password, subject);
+    TeacherNode* inserted = NULL;
+    root = insertTeacher(root, id, name, password, subject, &inserted);
+    if (inserted) {
+        markTeacherDirty(inserted);
+        journalAddTeacher(id, name, password, subject);
     }
-    int compare = strcmp(id, root->teacherID);
-    if (compare < 0) {
-        root->left = addTeacher(root->left, id, name, password, subject);
-    } else if (compare > 0) {
-        root->right = addTeacher(root->right, id, name, password, subject);
-    } else {
-        printf("Error: Teacher ID %s already exists.\n", id);
+    return root;
+}
+
+TeacherNode* findTeacher(TeacherNode* root, const char* id) {
+    while (root != NULL) {
+        int compare = strcmp(id, root->teacherID);
+        if (compare == 0) break;
+        root = (compare < 0) ? root->left : root->right;
     }
     return root;
 }
 
-TeacherNode* findTeacher(TeacherNode* root, char* id) {
-    if (root == NULL) return NULL;
-    int compare = strcmp(id, root->teacherID);
-    if (compare == 0) return root;
-    if (compare < 0) return findTeacher(root->left, id);
-    return findTeacher(root->right, id);
+// findTeacher through the hash index; 'root' is only walked if the index is partial.
+TeacherNode* lookupTeacher(TeacherNode* root, const char* id) {
+    uint64_t started = STAT_START();
+    TeacherNode* teacher = teacherKeysPartial ? findTeacher(root, id) : (TeacherNode*)keyIndexGet(&teacherKeys, id);
+    STAT_STOP(STAT_LOOKUP_TEACHER, started, 0);
+    return teacher;
 }
 
-TeacherNode* login(TeacherNode* root, char* id, char* password) {
-    TeacherNode* teacher = findTeacher(root, id);
+static TeacherNode* checkLogin(TeacherNode* root, char* id, char* password) {
+    TeacherNode* teacher = lookupTeacher(root, id);
     
     if (teacher == NULL) {
         printf("Login Failed: Teacher ID %s not found.\n", id);
@@ -188,47 +323,188 @@ TeacherNode* login(TeacherNode* root, char* id, char* password) {
     }
 }
 
+TeacherNode* login(TeacherNode* root, char* id, char* password) {
+    uint64_t started = STAT_START();
+    TeacherNode* teacher = checkLogin(root, id, password);
+    STAT_STOP(STAT_LOGIN, started, 0);
+    return teacher;
+}
+
+// Pre-order, so each teacher is freed as soon as its children are on the
+// cursor's stack. If the stack cannot grow, the rest is left to releaseAllData.
 void freeTeacherTree(TeacherNode* root) {
-    if (root == NULL) return;
-    freeTeacherTree(root->left);
-    freeTeacherTree(root->right);
-    free(root);
+    TreeCursor cursor;
+    TeacherNode* teacher;
+    openTeacherCursor(&cursor, root, CURSOR_PRE_ORDER);
+    while ((teacher = nextTeacher(&cursor)) != NULL) {
+        keyIndexRemove(&teacherKeys, teacher->teacherID, teacher);
+        poolFree(&teacherPool, teacher);
+    }
+    closeCursor(&cursor);
 }
 
 // --- Student Function Implementations ---
 
 StudentNode* createStudent(char* srn, char* name) {
-    StudentNode* newNode = (StudentNode*)malloc(sizeof(StudentNode));
+    StudentNode* newNode = (StudentNode*)poolAlloc(&studentPool);
     if (newNode == NULL) return NULL;
     strcpy(newNode->studentSRN, srn);
     strcpy(newNode->name, name);
+    newNode->height = 1;
+    newNode->ordinal = acquireStudentOrdinal();
+    newNode->dirtyEpoch = 0;
+    newNode->lazySlot = 0;
     newNode->left = NULL;
     newNode->right = NULL;
     newNode->historyHead = NULL;
+    newNode->historyTail = NULL;
     return newNode;
 }
 
-StudentNode* addStudent(StudentNode* root, char* srn, char* name) {
+static void indexStudent(StudentNode* student) {
+    if (!keyIndexPut(&studentKeys, student->studentSRN, student)) studentKeysPartial = 1;
+    indexStudentName(student);
+}
+
+// --- AVL Balancing Helpers ---
+
+int studentHeight(StudentNode* node) {
+    return node ? node->height : 0;
+}
+
+static void updateHeight(StudentNode* node) {
+    int lh = studentHeight(node->left);
+    int rh = studentHeight(node->right);
+    node->height = 1 + (lh > rh ? lh : rh);
+}
+
+static StudentNode* rotateRight(StudentNode* node) {
+    StudentNode* pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+static StudentNode* rotateLeft(StudentNode* node) {
+    StudentNode* pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+// Links an array of nodes sorted by SRN into a perfectly balanced tree in O(n).
+static StudentNode* linkSortedStudents(StudentNode** sorted, size_t count) {
+    if (count == 0) return NULL;
+    size_t middle = count / 2;
+    StudentNode* root = sorted[middle];
+    root->left = linkSortedStudents(sorted, middle);
+    root->right = linkSortedStudents(sorted + middle + 1, count - middle - 1);
+    updateHeight(root);
+    return root;
+}
+
+// linkSortedStudents for nodes that are not indexed yet. Used by the bulk
+// loaders instead of inserting one node at a time.
+StudentNode* buildBalancedStudentTree(StudentNode** sorted, size_t count) {
+    for (size_t i = 0; i < count; i++) indexStudent(sorted[i]);
+    return linkSortedStudents(sorted, count);
+}
+
+// Restores the AVL property at 'node' after one of its subtrees changed
+// height by at most one. Returns the new root of the subtree.
+static StudentNode* rebalance(StudentNode* node) {
+    updateHeight(node);
+    int balance = studentHeight(node->left) - studentHeight(node->right);
+    if (balance > 1) {
+        if (studentHeight(node->left->left) < studentHeight(node->left->right)) {
+            node->left = rotateLeft(node->left); // Left-Right case
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        if (studentHeight(node->right->right) < studentHeight(node->right->left)) {
+            node->right = rotateRight(node->right); // Right-Left case
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+static StudentNode* insertStudent(StudentNode* root, char* srn, char* name, StudentNode** inserted) {
     if (root == NULL) {
-        return createStudent(srn, name);
+        *inserted = createStudent(srn, name);
+        if (*inserted != NULL) indexStudent(*inserted);
+        return *inserted;
     }
     int compare = strcmp(srn, root->studentSRN);
     if (compare < 0) {
-        root->left = addStudent(root->left, srn, name);
+        root->left = insertStudent(root->left, srn, name, inserted);
     } else if (compare > 0) {
-        root->right = addStudent(root->right, srn, name);
+        root->right = insertStudent(root->right, srn, name, inserted);
     } else {
         printf("Error: Student SRN %s already exists.\n", srn);
+        return root;
     }
+    return rebalance(root);
+}
+
+// Links an already created node into the tree without journaling it. Sets
+// *attached to 0 (and leaves the node alone) if its SRN is already taken.
+StudentNode* attachStudent(StudentNode* root, StudentNode* node, int* attached) {
+    if (root == NULL) {
+        node->left = NULL;
+        node->right = NULL;
+        node->height = 1;
+        *attached = 1;
+        return node;
+    }
+    int compare = strcmp(node->studentSRN, root->studentSRN);
+    if (compare == 0) {
+        *attached = 0;
+        return root;
+    }
+    if (compare < 0) {
+        root->left = attachStudent(root->left, node, attached);
+    } else {
+        root->right = attachStudent(root->right, node, attached);
+    }
+    return rebalance(root);
+}
+
+StudentNode* addStudent(StudentNode* root, char* srn, char* name) {
+    uint64_t started = STAT_START();
+    StudentNode* inserted = NULL;
+    root = insertStudent(root, srn, name, &inserted);
+    if (inserted) {
+        markStudentDirty(inserted);
+        journalAddStudent(srn, name);
+    }
+    STAT_STOP(STAT_ADD_STUDENT, started, 0);
     return root;
 }
 
-StudentNode* findStudent(StudentNode* root, char* srn) {
-    if (root == NULL) return NULL;
-    int compare = strcmp(srn, root->studentSRN);
-    if (compare == 0) return root;
-    if (compare < 0) return findStudent(root->left, srn);
-    return findStudent(root->right, srn);
+StudentNode* findStudent(StudentNode* root, const char* srn) {
+    uint64_t started = STAT_START();
+    while (root != NULL) {
+        int compare = strcmp(srn, root->studentSRN);
+        if (compare == 0) break;
+        root = (compare < 0) ? root->left : root->right;
+    }
+    STAT_STOP(STAT_FIND_STUDENT, started, 0);
+    return root;
+}
+
+// findStudent through the hash index, for the main student tree. 'root' is
+// only walked if the index is partial.
+StudentNode* lookupStudent(StudentNode* root, const char* srn) {
+    uint64_t started = STAT_START();
+    StudentNode* student = studentKeysPartial ? findStudent(root, srn) : (StudentNode*)keyIndexGet(&studentKeys, srn);
+    STAT_STOP(STAT_LOOKUP_STUDENT, started, 0);
+    return student;
 }
 
 StudentNode* findMin(StudentNode* node) {
@@ -239,50 +515,124 @@ StudentNode* findMin(StudentNode* node) {
     return current;
 }
 
-StudentNode* deleteStudent(StudentNode* root, char* srn) {
-    if (root == NULL) {
-        printf("Error: Student SRN %s not found for deletion.\n", srn);
-        return root;
+// Unlinks the smallest node of a subtree without freeing it.
+// The detached node is returned through 'minNode'.
+static StudentNode* detachMin(StudentNode* root, StudentNode** minNode) {
+    if (root->left == NULL) {
+        *minNode = root;
+        return root->right;
     }
+    root->left = detachMin(root->left, minNode);
+    return rebalance(root);
+}
+
+// Unlinks the student from the tree without freeing it or journaling the
+// removal. The node is returned through *detached (NULL if the SRN is not there).
+StudentNode* detachStudent(StudentNode* root, const char* srn, StudentNode** detached) {
+    if (root == NULL) return NULL;
     int compare = strcmp(srn, root->studentSRN);
     if (compare < 0) {
-        root->left = deleteStudent(root->left, srn);
+        root->left = detachStudent(root->left, srn, detached);
     } else if (compare > 0) {
-        root->right = deleteStudent(root->right, srn);
+        root->right = detachStudent(root->right, srn, detached);
     } else {
         // Node found
-        if (root->left == NULL && root->right == NULL) {
-            freeHistory(root->historyHead);
-            free(root);
-            return NULL;
-        }
-        else if (root->left == NULL) {
-            StudentNode* temp = root->right;
-            freeHistory(root->historyHead);
-            free(root);
-            return temp;
+        StudentNode* replacement;
+        if (root->left == NULL) {
+            replacement = root->right;
         } else if (root->right == NULL) {
-            StudentNode* temp = root->left;
-            freeHistory(root->historyHead);
-            free(root);
-            return temp;
+            replacement = root->left;
+        } else {
+            // Two children case: splice the in-order successor into this
+            // position so every other StudentNode keeps its address.
+            StudentNode* successor;
+            StudentNode* newRight = detachMin(root->right, &successor);
+            successor->left = root->left;
+            successor->right = newRight;
+            replacement = successor;
         }
-        // Two children case
-        StudentNode* temp = findMin(root->right);
-        strcpy(root->studentSRN, temp->studentSRN);
-        strcpy(root->name, temp->name);
-        PerformanceNode* tempListHead = root->historyHead;
-        root->historyHead = temp->historyHead;
-        temp->historyHead = tempListHead;
-        root->right = deleteStudent(root->right, temp->studentSRN);
+        *detached = root;
+        if (replacement == NULL) return NULL;
+        return rebalance(replacement);
     }
+    return rebalance(root);
+}
+
+StudentNode* deleteStudent(StudentNode* root, char* srn) {
+    uint64_t started = STAT_START();
+    StudentNode* removed = NULL;
+    root = detachStudent(root, srn, &removed);
+    if (removed == NULL) {
+        printf("Error: Student SRN %s not found for deletion.\n", srn);
+    } else {
+        freeStudent(removed); // Its slot is reused by the next createStudent
+        markKeyDirty(srn);
+        journalDeleteStudent(srn);
+    }
+    STAT_STOP(STAT_DELETE_STUDENT, started, 0);
     return root;
 }
 
+// --- History Indexes ---
+//
+// The newest mark of each component in each subject is kept in the
+// class-wide columns at the student's ordinal, so the packed history needs
+// no per-student index beside it.
+
+// Adds 'record' to the history as its newest record (newest = 1) or its
+// oldest (newest = 0), entering it in the columns unless a newer mark of
+// its kind is there. Returns 0, changing nothing, if memory runs out.
+static int storeRecord(StudentNode* student, const PerformanceRecord* record, int newest) {
+    MarkColumns* columns = NULL;
+    int component = record->type - INTERNAL_1;
+    int32_t previous = MARK_MISSING;
+    if (record->type >= INTERNAL_1 && record->type <= SEMESTER_EXAM) {
+        columns = markColumnsFor(record->subject, 1);
+        if (columns == NULL) return 0;
+        previous = columnMark(columns, component, student->ordinal);
+        if ((newest || previous == MARK_MISSING) &&
+            !setColumnMark(columns, component, student->ordinal, record->value)) return 0;
+    }
+    if (newest ? pushHistoryRecord(student, record) : appendHistoryRecord(student, record)) return 1;
+    if (columns != NULL) setColumnMark(columns, component, student->ordinal, previous); // The cell exists by now
+    return 0;
+}
+
+// Clears the student's marks from the columns before its history goes.
+static void unindexHistory(StudentNode* student) {
+    HistoryCursor cursor;
+    PerformanceRecord record;
+    openHistoryCursor(&cursor, student);
+    while (nextHistoryRecord(&cursor, &record)) {
+        if (record.type < INTERNAL_1 || record.type > SEMESTER_EXAM) continue;
+        MarkColumns* columns = markColumnsFor(record.subject, 0);
+        if (columns) setColumnMark(columns, record.type - INTERNAL_1, student->ordinal, MARK_MISSING);
+    }
+}
+
+// Looks up the newest mark of 'type' for 'subject' without reading the history.
+int latestMark(StudentNode* student, RecordType type, SymbolId subject, int* value) {
+    if (type < INTERNAL_1 || type > SEMESTER_EXAM || !faultInHistory(student)) return 0;
+    int32_t mark = columnMark(markColumnsFor(subject, 0), type - INTERNAL_1, student->ordinal);
+    if (mark == MARK_MISSING) return 0;
+    *value = mark;
+    return 1;
+}
+
 // --- Data Modification Functions ---
 
+void renameStudent(StudentNode* student, char* newName) {
+    uint64_t started = STAT_START();
+    unindexStudentName(student);
+    strcpy(student->name, newName);
+    indexStudentName(student);
+    markStudentDirty(student);
+    journalModifyName(student->studentSRN, newName);
+    STAT_STOP(STAT_RENAME_STUDENT, started, 0);
+}
+
 void modifyStudentName(StudentNode* root, char* srn) {
-    StudentNode* student = findStudent(root, srn);
+    StudentNode* student = lookupStudent(root, srn);
     if (student == NULL) {
         printf("Error: Student SRN %s not found.\n", srn);
         return;
@@ -292,34 +642,251 @@ void modifyStudentName(StudentNode* root, char* srn) {
     printf("Enter new name: ");
     fgets(newName, 100, stdin);
     newName[strcspn(newName, "\n")] = 0;
-    strcpy(student->name, newName);
+    renameStudent(student, newName);
     printf("Name updated successfully.\n");
 }
 
+// Gives a student a new SRN, keeping the hash index and the dirty tracking
+// in step. The caller keeps the tree ordered: the node is out of it, about
+// to be relinked, or its new SRN sorts to the same place.
+static void setStudentSRN(StudentNode* student, const char* newSRN) {
+    keyIndexRemove(&studentKeys, student->studentSRN, student);
+    markKeyDirty(student->studentSRN);
+    strcpy(student->studentSRN, newSRN);
+    if (!keyIndexPut(&studentKeys, student->studentSRN, student)) studentKeysPartial = 1;
+    markKeyDirty(student->studentSRN);
+}
+
+// 1 if 'srn' would sort between the in-order neighbours of the node holding
+// 'current', so that node can take it without moving.
+static int keepsTreePosition(StudentNode* root, const char* current, const char* srn) {
+    StudentNode* before = NULL;
+    StudentNode* after = NULL;
+    while (root != NULL) {
+        int compare = strcmp(current, root->studentSRN);
+        if (compare == 0) break;
+        if (compare < 0) {
+            after = root;
+            root = root->left;
+        } else {
+            before = root;
+            root = root->right;
+        }
+    }
+    if (root == NULL) return 0;
+    if (root->left != NULL) {
+        before = root->left;
+        while (before->right != NULL) before = before->right;
+    }
+    if (root->right != NULL) after = findMin(root->right);
+    return (before == NULL || strcmp(before->studentSRN, srn) < 0) &&
+           (after == NULL || strcmp(srn, after->studentSRN) < 0);
+}
+
+// Moves a student (with name and history) to a new SRN. The node keeps its
+// history, ordinal and attendance. Usually a renumber leaves it between the
+// same neighbours and only the key is rewritten; otherwise the node is
+// unlinked, re-keyed and linked back in. Sets *changed to 1 on success;
+// fails without side effects if oldSRN is missing or newSRN is taken.
+StudentNode* changeStudentSRN(StudentNode* root, char* oldSRN, char* newSRN, int* changed) {
+    *changed = 0;
+    StudentNode* student = lookupStudent(root, oldSRN);
+    if (student == NULL || strlen(newSRN) >= sizeof(student->studentSRN) || lookupStudent(root, newSRN) != NULL) {
+        return root;
+    }
+    uint64_t started = STAT_START();
+
+    char previous[sizeof(student->studentSRN)];
+    strcpy(previous, student->studentSRN); // oldSRN may be the node's own buffer
+    if (keepsTreePosition(root, previous, newSRN)) {
+        setStudentSRN(student, newSRN);
+    } else {
+        StudentNode* detached = NULL;
+        int attached = 0;
+        root = detachStudent(root, previous, &detached);
+        setStudentSRN(student, newSRN);
+        root = attachStudent(root, student, &attached); // Cannot collide: newSRN was free
+    }
+    *changed = 1;
+    journalModifySRN(previous, student->studentSRN);
+    STAT_STOP(STAT_CHANGE_SRN, started, 0);
+    return root;
+}
+
 StudentNode* modifyStudentSRN(StudentNode* root, char* oldSRN, char* newSRN) {
-    StudentNode* student = findStudent(root, oldSRN);
-    if (student == NULL) {
+    if (lookupStudent(root, oldSRN) == NULL) {
         printf("Error: Student SRN %s not found.\n", oldSRN);
         return root;
     }
-    char tempName[100];
-    strcpy(tempName, student->name);
-    PerformanceNode* tempHistory = student->historyHead;
-    
-    student->historyHead = NULL; // Prevent history from being freed
-    root = deleteStudent(root, oldSRN);
-    
-    root = addStudent(root, newSRN, tempName);
-    student = findStudent(root, newSRN);
-    if (student) {
-        student->historyHead = tempHistory; // Re-attach history
-        printf("SRN modified successfully.\n");
+    if (lookupStudent(root, newSRN) != NULL) {
+        printf("Error: Student SRN %s already exists.\n", newSRN);
+        return root;
+    }
+    int changed = 0;
+    root = changeStudentSRN(root, oldSRN, newSRN, &changed);
+    if (changed) printf("SRN modified successfully.\n");
+    return root;
+}
+
+// --- Bulk Re-keying ---
+
+typedef struct {
+    StudentNode* student;
+    SRNChange* change;
+} RekeyMove;
+
+#define REKEY_MAX_PROBLEMS 10 // Printed in full; any more are only counted
+
+static int compareMoveOld(const void* a, const void* b) {
+    return strcmp(((const RekeyMove*)a)->change->oldSRN, ((const RekeyMove*)b)->change->oldSRN);
+}
+
+static int compareMoveNew(const void* a, const void* b) {
+    return strcmp(((const RekeyMove*)a)->change->newSRN, ((const RekeyMove*)b)->change->newSRN);
+}
+
+// Counts a problem. Returns 1 if it should still be printed.
+static int countProblem(size_t* problems) {
+    return ++*problems <= REKEY_MAX_PROBLEMS;
+}
+
+// 1 if 'student' is one of the moves (sorted by old SRN).
+static int isMoving(const RekeyMove* moves, size_t moved, const StudentNode* student) {
+    size_t low = 0, high = moved;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int compare = strcmp(moves[middle].change->oldSRN, student->studentSRN);
+        if (compare == 0) return 1;
+        if (compare < 0) low = middle + 1;
+        else high = middle;
+    }
+    return 0;
+}
+
+// Checks every change against the tree and against each other: a new SRN
+// may belong to a student that is moving too (so shifts and swaps work),
+// but not to one that stays, and no two students may end up with the same
+// one. Fills 'moves' with the changes that do something and returns how
+// many, or prints the problems and returns 0 with *problems set.
+static size_t resolveMoves(StudentNode* root, SRNChange* changes, size_t count, RekeyMove* moves, size_t* problems) {
+    size_t moved = 0;
+    for (size_t i = 0; i < count; i++) {
+        SRNChange* change = &changes[i];
+        if (strcmp(change->oldSRN, change->newSRN) == 0) continue;
+        StudentNode* student = lookupStudent(root, change->oldSRN);
+        if (student == NULL) {
+            if (countProblem(problems)) printf("Error: Student SRN %s not found.\n", change->oldSRN);
+        } else if (change->newSRN[0] == '\0') {
+            if (countProblem(problems)) printf("Error: No new SRN given for %s.\n", change->oldSRN);
+        } else {
+            moves[moved].student = student;
+            moves[moved].change = change;
+            moved++;
+        }
+    }
+    qsort(moves, moved, sizeof(RekeyMove), compareMoveOld); // Tree order, for the split in rekeyStudents
+    for (size_t i = 1; i < moved; i++) {
+        if (moves[i].student == moves[i - 1].student && countProblem(problems)) {
+            printf("Error: Student SRN %s is re-keyed more than once.\n", moves[i].change->oldSRN);
+        }
+    }
+    for (size_t i = 0; i < moved; i++) {
+        StudentNode* holder = lookupStudent(root, moves[i].change->newSRN);
+        if (holder != NULL && !isMoving(moves, moved, holder) && countProblem(problems)) {
+            printf("Error: Student SRN %s already exists.\n", moves[i].change->newSRN);
+        }
+    }
+    qsort(moves, moved, sizeof(RekeyMove), compareMoveNew);
+    for (size_t i = 1; i < moved; i++) {
+        if (strcmp(moves[i].change->newSRN, moves[i - 1].change->newSRN) == 0 && countProblem(problems)) {
+            printf("Error: More than one student would become %s.\n", moves[i].change->newSRN);
+        }
+    }
+    qsort(moves, moved, sizeof(RekeyMove), compareMoveOld);
+    return *problems ? 0 : moved;
+}
+
+// Checks every change first and makes none if any is invalid. Then the
+// students keep their nodes and only their keys change: the unchanged ones
+// are already in SRN order, the re-keyed ones are sorted by their new SRN,
+// and one merge of the two relinks the whole tree. O(n + k log k) for k
+// changes, against a detach and an attach per student.
+StudentNode* rekeyStudents(StudentNode* root, SRNChange* changes, size_t count, size_t* rekeyed) {
+    *rekeyed = 0;
+    if (count == 0) return root;
+    uint64_t started = STAT_START();
+    size_t total = countStudentTree(root);
+    RekeyMove* moves = (RekeyMove*)malloc(count * sizeof(RekeyMove));
+    StudentNode** sorted = (StudentNode**)malloc((total ? total : 1) * sizeof(StudentNode*));
+    if (moves == NULL || sorted == NULL) {
+        printf("Error: Memory allocation failed!\n");
+        free(moves);
+        free(sorted);
+        return root;
     }
+
+    size_t problems = 0;
+    size_t moved = resolveMoves(root, changes, count, moves, &problems);
+    if (problems > 0) {
+        if (problems > REKEY_MAX_PROBLEMS) printf("...and %lu more problem(s).\n", (unsigned long)(problems - REKEY_MAX_PROBLEMS));
+        printf("Error: No SRNs were changed.\n");
+    } else if (moved > 0) {
+        // Both lists are in old SRN order, so the moves can be picked out in one pass.
+        size_t kept = 0, next = 0;
+        flattenStudentTree(root, sorted);
+        for (size_t i = 0; i < total; i++) {
+            if (next < moved && sorted[i] == moves[next].student) next++;
+            else sorted[kept++] = sorted[i];
+        }
+
+        // One journal entry set for the whole batch: a shift or swap could
+        // not be replayed one change at a time.
+        journalRekey(changes, count);
+        qsort(moves, moved, sizeof(RekeyMove), compareMoveNew);
+        for (size_t i = 0; i < moved; i++) setStudentSRN(moves[i].student, moves[i].change->newSRN);
+
+        // Merge from the back, so the unchanged students can stay in place.
+        size_t write = total, j = moved;
+        while (j > 0) {
+            if (kept > 0 && strcmp(sorted[kept - 1]->studentSRN, moves[j - 1].student->studentSRN) > 0) {
+                sorted[--write] = sorted[--kept];
+            } else {
+                sorted[--write] = moves[--j].student;
+            }
+        }
+        root = linkSortedStudents(sorted, total);
+        *rekeyed = moved;
+    }
+    free(moves);
+    free(sorted);
+    STAT_STOP(STAT_REKEY_STUDENTS, started, 0);
     return root;
 }
 
+int findMark(StudentNode* student, RecordType type, char* subject, int* value) {
+    SymbolId subjectId;
+    if (!faultInHistory(student)) return 0; // Its subjects may not be interned before
+    if (!lookupSymbol(subject, &subjectId)) return 0; // No record uses it
+    return latestMark(student, type, subjectId, value);
+}
+
+int updateMark(StudentNode* student, RecordType type, char* subject, int newValue) {
+    uint64_t started = STAT_START();
+    SymbolId subjectId;
+    int updated = type >= INTERNAL_1 && type <= SEMESTER_EXAM && faultInHistory(student) &&
+                  lookupSymbol(subject, &subjectId) &&
+                  rewriteHistoryValue(student, type, subjectId, newValue);
+    if (updated) {
+        setColumnMark(markColumnsFor(subjectId, 0), type - INTERNAL_1, student->ordinal, newValue); // The cell exists
+        markStudentDirty(student);
+        journalModifyMark(student->studentSRN, type, subject, newValue);
+    }
+    STAT_STOP(STAT_UPDATE_MARK, started, 0);
+    return updated;
+}
+
 void modifyMark(StudentNode* root, char* srn) {
-    StudentNode* student = findStudent(root, srn);
+    StudentNode* student = lookupStudent(root, srn);
     if (student == NULL) {
         printf("Error: Student SRN %s not found.\n", srn);
         return;
@@ -344,122 +911,203 @@ void modifyMark(StudentNode* root, char* srn) {
         default: printf("Invalid type.\n"); return;
     }
     
-    PerformanceNode* current = student->historyHead;
-    int found = 0;
-    while (current != NULL) {
-        if (current->type == typeToFind && strcmp(current->subject, subject) == 0) {
-            printf("Found existing mark for %s. Current value: %d\n", subject, current->value);
-            printf("Enter new value: ");
-            scanf("%d", &newValue);
-            getchar();
-            current->value = newValue;
-            printf("Mark updated.\n");
-            found = 1;
-            break;
-        }
-        current = current->next;
+    int currentValue;
+    if (!findMark(student, typeToFind, subject, &currentValue)) {
+        printf("No matching mark found to update.\n");
+        return;
     }
-    if (!found) printf("No matching mark found to update.\n");
+    printf("Found existing mark for %s. Current value: %d\n", subject, currentValue);
+    printf("Enter new value: ");
+    scanf("%d", &newValue);
+    getchar();
+    if (updateMark(student, typeToFind, subject, newValue)) printf("Mark updated.\n");
 }
 
-// --- Linked List (Performance) Functions ---
+// --- History (Performance) Functions ---
 
-PerformanceNode* createPerformanceNode(RecordType type, int value, char* subject, char* desc) {
-    PerformanceNode* newNode = (PerformanceNode*)malloc(sizeof(PerformanceNode));
-    if (newNode == NULL) return NULL;
-    newNode->type = type;
-    newNode->value = value;
-    strcpy(newNode->subject, subject);
-    strcpy(newNode->description, desc);
-    newNode->next = NULL;
-    return newNode;
+// Attendance (subject, date) goes into its session bitmap (see attendance.h)
+// rather than the history.
+static int recordAttendance(StudentNode* student, SymbolId subject, SymbolId date, int value) {
+    if (subject == SYMBOL_INVALID || date == SYMBOL_INVALID) return 0;
+    return setAttendance(subject, date, student->ordinal, value == 1);
+}
+
+static void addRecord(StudentNode* student, RecordType type, int value, char* subject, char* desc) {
+    if (type == ATTENDANCE) {
+        if (!recordAttendance(student, internSymbol(subject), internSymbol(desc), value)) return;
+        markStudentDirty(student);
+        journalAddRecord(student->studentSRN, type, value, subject, desc);
+        return;
+    }
+    PerformanceRecord record = { type, value, internSymbol(subject), internSymbol(desc) };
+    if (record.subject == SYMBOL_INVALID || record.description == SYMBOL_INVALID) return;
+    if (!storeRecord(student, &record, 1)) return;
+    markStudentDirty(student);
+    journalAddRecord(student->studentSRN, type, value, subject, desc);
 }
 
 void addPerformanceRecord(StudentNode* student, RecordType type, int value, char* subject, char* desc) {
-    if (student == NULL) return;
-    PerformanceNode* newNode = createPerformanceNode(type, value, subject, desc);
-    if (newNode == NULL) return;
-    newNode->next = student->historyHead; // Add to front
-    student->historyHead = newNode;
+    if (student == NULL || !faultInHistory(student)) return;
+    uint64_t started = STAT_START();
+    addRecord(student, type, value, subject, desc);
+    STAT_STOP(STAT_ADD_RECORD, started, 0);
+}
+
+// Adds a record as the oldest. Used by the loaders, which read each history
+// newest first; attendance goes into its session instead. Not journaled.
+// Returns 0 if memory runs out.
+int appendPerformanceRecord(StudentNode* student, RecordType type, int value, SymbolId subject, SymbolId desc) {
+    if (type == ATTENDANCE) return recordAttendance(student, subject, desc, value);
+    PerformanceRecord record = { type, value, subject, desc };
+    return storeRecord(student, &record, 0);
+}
+
+// Appends the history of 'from' after the oldest record of 'to', leaving
+// 'from' empty. Used to merge duplicate SRNs on load.
+void moveHistory(StudentNode* from, StudentNode* to) {
+    if (!faultInHistory(from) || !faultInHistory(to)) return;
+    mergeStudentAttendance(from->ordinal, to->ordinal); // 'to' keeps its own entries
+    HistoryCursor cursor;
+    PerformanceRecord record;
+    openHistoryCursor(&cursor, from);
+    while (nextHistoryRecord(&cursor, &record)) {
+        if (!storeRecord(to, &record, 0)) break; // Out of memory: drop the rest
+    }
+    unindexHistory(from);
+    freeHistoryChunks(from);
 }
 
 // --- Attendance and Reporting Functions ---
 
 void listAllStudents(StudentNode* root) {
-    if (root != NULL) {
-        listAllStudents(root->left); // In-order traversal
-        printf("  -> SRN: %-15s | Name: %s\n", root->studentSRN, root->name);
-        listAllStudents(root->right);
-    }
+    uint64_t started = STAT_START();
+    ReportWriter writer;
+    reportOpen(&writer, REPORT_FORMAT_TEXT, REPORT_STUDENT_LIST, stdout);
+    reportStudentList(&writer, root);
+    reportClose(&writer);
+    STAT_STOP(STAT_LIST_STUDENTS, started, writer.written);
 }
 
-void takeAttendance(StudentNode* root, char* date) {
-    if (root != NULL) {
-        takeAttendance(root->left, date);
-        
+// Prompts for every student in SRN order.
+void takeAttendance(StudentNode* root, char* subject, char* date) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) {
         int status = -1;
-        printf("Student: %-15s (%s)\n", root->studentSRN, root->name);
+        printf("Student: %-15s (%s)\n", student->studentSRN, student->name);
         while(status != 0 && status != 1) {
             printf("  Enter 1 (Present) or 0 (Absent): ");
             scanf("%d", &status);
             getchar();
         }
-        addPerformanceRecord(root, ATTENDANCE, status, "Attendance", date);
-        
-        takeAttendance(root->right, date);
+        addPerformanceRecord(student, ATTENDANCE, status, subject, date);
     }
+    closeCursor(&cursor);
 }
 
-void generateSubjectReport(StudentNode* student, char* subjectName) {
-    if (student == NULL) return;
-    printf("\n============================================\n");
-    printf("            STUDENT SUBJECT REPORT\n");
-    printf("============================================\n");
-    printf("SRN:    %s\n", student->studentSRN);
-    printf("Name:   %s\n", student->name);
-    printf("Subject: %s\n", subjectName);
-    printf("--------------------------------------------\n");
-    printf("Detailed Marks:\n\n");
-    
-    PerformanceNode* current = student->historyHead;
-    int i1_mark = -1, a1_mark = -1, i2_mark = -1, a2_mark = -1, sem_mark = -1;
-    
-    while (current != NULL) {
-        if (strcmp(current->subject, subjectName) == 0) {
-            switch (current->type) {
-                case INTERNAL_1:   i1_mark = current->value;   printf("  [Internal 1]   : %d / 20\n", i1_mark);   break;
-                case ASSIGNMENT_1: a1_mark = current->value;   printf("  [Assignment 1] : %d / 5\n", a1_mark);   break;
-                case INTERNAL_2:   i2_mark = current->value;   printf("  [Internal 2]   : %d / 20\n", i2_mark);   break;
-                case ASSIGNMENT_2: a2_mark = current->value;   printf("  [Assignment 2] : %d / 5\n", a2_mark);   break;
-                case SEMESTER_EXAM: sem_mark = current->value; printf("  [Semester Exam]: %d / 100\n", sem_mark); break;
-                case ATTENDANCE: break;
-            }
+typedef struct {
+    char* subject;
+    char* date;
+    char** absentees; // Sorted
+    int absentCount;
+    int next;         // First absentee not yet matched
+    int recorded;
+    int present;
+} RollCall;
+
+static int compareSRNs(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// In-order walk merged against the sorted absentee list, so the roll call
+// costs one pass over the class plus a sort of the absentees.
+static void rollCallWalk(StudentNode* root, RollCall* call) {
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) {
+        while (call->next < call->absentCount && strcmp(call->absentees[call->next], student->studentSRN) < 0) {
+            printf("Warning: Absentee SRN %s not found; ignored.\n", call->absentees[call->next++]);
+        }
+        int absent = 0;
+        while (call->next < call->absentCount && strcmp(call->absentees[call->next], student->studentSRN) == 0) {
+            absent = 1;
+            call->next++; // Also skips a repeated SRN
         }
-        current = current->next;
+        addPerformanceRecord(student, ATTENDANCE, !absent, call->subject, call->date);
+        call->recorded++;
+        call->present += !absent;
     }
-    
-    printf("\n--- Summary & Calculation ---\n");
-    double total_cie = 0;
-    int cie_complete = 1;
-    if (i1_mark != -1) total_cie += i1_mark; else cie_complete = 0;
-    if (a1_mark != -1) total_cie += a1_mark; else cie_complete = 0;
-    if (i2_mark != -1) total_cie += i2_mark; else cie_complete = 0;
-    if (a2_mark != -1) total_cie += a2_mark; else cie_complete = 0;
-    
-    if(cie_complete) printf("Total CIE (I1+A1+I2+A2):      %.2f / 50\n", total_cie);
-    else printf("Total CIE (I1+A1+I2+A2):      N/A (Missing components)\n");
-    
-    double sem_scaled = -1;
-    if (sem_mark != -1) {
-        sem_scaled = sem_mark / 2.0;
-        printf("Semester Mark (Scaled):       %.2f / 50\n", sem_scaled);
-    } else {
-        printf("Semester Mark (Scaled):       N/A (Missing SEM score)\n");
+    closeCursor(&cursor);
+}
+
+// Splits a list of SRNs separated by spaces or commas, in place. Returns
+// how many were found (at most 'max').
+int splitSRNList(char* text, char** srns, int max) {
+    int count = 0;
+    for (char* srn = strtok(text, " ,\t"); srn != NULL && count < max; srn = strtok(NULL, " ,\t")) {
+        srns[count++] = srn;
     }
-    
-    if (cie_complete && sem_mark != -1) printf("\nFINAL SUBJECT MARK (Total):   %.2f / 100\n", (total_cie + sem_scaled));
-    else printf("\nFINAL SUBJECT MARK (Total):   N/A (Missing components)\n");
-    printf("============================================\n");
+    return count;
+}
+
+// Records one session for the whole class: everyone present except the
+// listed absentees (sorted in place). Returns the number of students recorded.
+int recordRollCall(StudentNode* root, char* subject, char* date, char** absentees, int absentCount) {
+    uint64_t started = STAT_START();
+    RollCall call = { subject, date, absentees, absentCount, 0, 0, 0 };
+    qsort(absentees, (size_t)absentCount, sizeof(char*), compareSRNs);
+    journalBeginGroup(); // One journal write for the class, not one per student
+    rollCallWalk(root, &call);
+    journalEndGroup();
+    while (call.next < absentCount) {
+        printf("Warning: Absentee SRN %s not found; ignored.\n", absentees[call.next++]);
+    }
+    printf("Attendance recorded for %d student(s): %d present, %d absent.\n",
+           call.recorded, call.present, call.recorded - call.present);
+    STAT_STOP(STAT_ROLL_CALL, started, 0);
+    return call.recorded;
+}
+
+// The figures behind a subject report. The newest mark of each component
+// comes from the class-wide columns; an unknown subject simply has no marks.
+void summarizeSubject(StudentNode* student, const char* subjectName, const AttendanceTally* classTally,
+                      SubjectSummary* summary) {
+    SymbolId subjectId;
+    // A failed read shows as no marks; faultInHistory has said why.
+    int knownSubject = faultInHistory(student) && lookupSymbol(subjectName, &subjectId);
+    MarkColumns* columns = knownSubject ? markColumnsFor(subjectId, 0) : NULL;
+    for (int c = 0; c < MARK_COMPONENTS; c++) {
+        int32_t mark = columnMark(columns, c, student->ordinal);
+        summary->marks[c] = (mark != MARK_MISSING) ? mark : -1;
+    }
+
+    summary->cieTotal = 0;
+    summary->cieComplete = 1;
+    for (RecordType type = INTERNAL_1; type <= ASSIGNMENT_2; type++) {
+        if (summary->marks[type - INTERNAL_1] != -1) summary->cieTotal += summary->marks[type - INTERNAL_1];
+        else summary->cieComplete = 0;
+    }
+    int semMark = summary->marks[SEMESTER_EXAM - INTERNAL_1];
+    summary->semesterScaled = (semMark != -1) ? semMark / 2.0 : -1;
+
+    summary->attendance = knownSubject ? studentAttendance(student->ordinal, subjectId) : (AttendanceTally){ 0, 0 };
+    summary->classAttendance = (AttendanceTally){ 0, 0 };
+    if (summary->attendance.sessions > 0) {
+        if (classTally) summary->classAttendance = *classTally;
+        else if (faultInAllHistories()) summary->classAttendance = classAttendance(subjectId); // Needs everyone's sessions
+    }
+}
+
+void generateSubjectReport(StudentNode* student, char* subjectName) {
+    if (student == NULL) return;
+    uint64_t started = STAT_START();
+    ReportWriter writer;
+    reportOpen(&writer, REPORT_FORMAT_TEXT, REPORT_SUBJECT, stdout);
+    reportSubject(&writer, student, subjectName, NULL);
+    reportClose(&writer);
+    STAT_STOP(STAT_SUBJECT_REPORT, started, writer.written);
 }
 
 void generateMasterReport(StudentNode* student) {
@@ -467,52 +1115,122 @@ void generateMasterReport(StudentNode* student) {
         printf("Error: Student not found.\n");
         return;
     }
+    uint64_t started = STAT_START();
+    ReportWriter writer;
+    reportOpen(&writer, REPORT_FORMAT_TEXT, REPORT_MASTER, stdout);
+    reportMaster(&writer, student);
+    reportClose(&writer);
+    STAT_STOP(STAT_MASTER_REPORT, started, writer.written);
+}
+
+const char* recordTypeName(RecordType type) {
+    switch (type) {
+        case INTERNAL_1:    return "Internal 1";
+        case ASSIGNMENT_1:  return "Assignment 1";
+        case INTERNAL_2:    return "Internal 2";
+        case ASSIGNMENT_2:  return "Assignment 2";
+        case SEMESTER_EXAM: return "Semester Exam";
+        default:            return "Attendance";
+    }
+}
+
+int recordTypeMaxMark(RecordType type) {
+    switch (type) {
+        case ATTENDANCE:                      return 1;
+        case INTERNAL_1: case INTERNAL_2:     return 20;
+        case ASSIGNMENT_1: case ASSIGNMENT_2: return 5;
+        default:                              return 100;
+    }
+}
+
+// Class-wide figures for one component, read straight from the mark columns
+// (each student's newest mark counts once).
+static void printClassStats(char* subjectName, RecordType type) {
+    int maxMark = recordTypeMaxMark(type);
+    MarkStats stats;
+    SymbolId subjectId;
+    int found = lookupSymbol(subjectName, &subjectId) &&
+                computeMarkStats(subjectId, type - INTERNAL_1, maxMark, &stats);
+
     printf("\n============================================\n");
-    printf("           MASTER STUDENT REPORT\n");
+    printf("          CLASS STATISTICS REPORT\n");
     printf("============================================\n");
-    printf("SRN:    %s\n", student->studentSRN);
-    printf("Name:   %s\n", student->name);
+    printf("Subject:   %s\n", subjectName);
+    printf("Component: %s (out of %d)\n", recordTypeName(type), maxMark);
     printf("--------------------------------------------\n");
-    
-    PerformanceNode* current = student->historyHead;
-    if (current == NULL) {
-        printf("...No records found for this student.\n");
+    if (!found) {
+        printf("...No marks recorded for this component.\n");
         printf("============================================\n");
         return;
     }
-    
-    while (current != NULL) {
-        printf("\nSubject: %s\n", current->subject);
-        printf("  Description: %s\n", current->description);
-        switch (current->type) {
-            case ATTENDANCE:   printf("  Type:  Attendance\n  Value: %s\n", (current->value == 1 ? "Present" : "Absent")); break;
-            case INTERNAL_1:   printf("  Type:  Internal 1\n  Value: %d / 20\n", current->value);   break;
-            case ASSIGNMENT_1: printf("  Type:  Assignment 1\n  Value: %d / 5\n", current->value);   break;
-            case INTERNAL_2:   printf("  Type:  Internal 2\n  Value: %d / 20\n", current->value);   break;
-            case ASSIGNMENT_2: printf("  Type:  Assignment 2\n  Value: %d / 5\n", current->value);   break;
-            case SEMESTER_EXAM: printf("  Type:  Semester Exam\n  Value: %d / 100\n", current->value); break;
-        }
-        current = current->next;
+    printf("Students:  %u\n", stats.count);
+    printf("Mean:      %.2f\n", stats.mean);
+    printf("Median:    %.1f\n", stats.median);
+    printf("Min / Max: %d / %d\n", stats.min, stats.max);
+    printf("Std Dev:   %.2f\n", stats.stddev);
+    printf("\nDistribution:\n");
+    uint32_t widest = 0;
+    for (int b = 0; b < stats.bucketCount; b++) {
+        if (stats.histogram[b] > widest) widest = stats.histogram[b];
+    }
+    for (int b = 0; b < stats.bucketCount; b++) {
+        int bar = widest ? (int)((stats.histogram[b] * 30 + widest - 1) / widest) : 0;
+        printf("  %3d - %-3d | %-30.*s %u\n", stats.bucketLow[b], stats.bucketHigh[b], bar,
+               "##############################", stats.histogram[b]);
     }
     printf("============================================\n");
 }
 
+void generateClassStatsReport(char* subjectName, RecordType type) {
+    if (type < INTERNAL_1 || type > SEMESTER_EXAM) {
+        printf("Error: Class statistics cover marks only.\n");
+        return;
+    }
+    if (!faultInAllHistories()) return;
+    uint64_t started = STAT_START();
+    printClassStats(subjectName, type);
+    STAT_STOP(STAT_CLASS_STATS, started, 0);
+}
+
 // --- Memory Freeing Functions ---
 
-void freeHistory(PerformanceNode* head) {
-    PerformanceNode* current = head;
-    PerformanceNode* temp;
-    while (current != NULL) {
-        temp = current;
-        current = current->next;
-        free(temp);
-    }
+void releaseHistory(StudentNode* student) {
+    unindexHistory(student);
+    clearStudentAttendance(student->ordinal);
+    freeHistoryChunks(student);
+}
+
+void freeStudent(StudentNode* student) {
+    if (student == NULL) return;
+    forgetLazyStudent(student);
+    releaseHistory(student);
+    keyIndexRemove(&studentKeys, student->studentSRN, student);
+    unindexStudentName(student);
+    releaseStudentOrdinal(student->ordinal);
+    poolFree(&studentPool, student);
 }
 
 void freeTree(StudentNode* root) {
-    if (root == NULL) return;
-    freeTree(root->left);
-    freeTree(root->right);
-    freeHistory(root->historyHead);
-    free(root);
-}
\ No newline at end of file
+    TreeCursor cursor;
+    StudentNode* student;
+    openStudentCursor(&cursor, root, CURSOR_PRE_ORDER); // Each student is freed once its children are stacked
+    while ((student = nextStudent(&cursor)) != NULL) freeStudent(student);
+    closeCursor(&cursor);
+}
+
+// Frees every teacher, student, record and interned string in one step by
+// returning the pools' slabs. Every tree root held by the caller becomes invalid.
+void releaseAllData(void) {
+    closeLazyBlockStore();
+    releaseHistoryStore();
+    poolReleaseAll(&studentPool);
+    poolReleaseAll(&teacherPool);
+    keyIndexFree(&studentKeys);
+    keyIndexFree(&teacherKeys);
+    releaseNameIndex();
+    studentKeysPartial = 0;
+    teacherKeysPartial = 0;
+    releaseMarkColumns();
+    releaseAttendance();
+    releaseSymbols(); // No record is left to refer to them
+}
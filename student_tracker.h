@@ -4,6 +4,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include "symbol_table.h"
+#include "mark_columns.h"
+#include "attendance.h"
+
+#define SAVE_FILE "data.dat" // Define the save file name
+#define RECORD_TEXT_SIZE 50  // Longest record subject/description + 1, as entered and saved
 
 // --- Data Structures ---
 
@@ -17,24 +24,48 @@ typedef enum {
     SEMESTER_EXAM   // For 100 marks (will be scaled to 50)
 } RecordType;
 
-// Linked List node for a student's history
-typedef struct PerformanceNode {
+#define MARK_COMPONENTS SEMESTER_EXAM // INTERNAL_1 .. SEMESTER_EXAM
+
+// One record of a student's history, as a HistoryCursor reads it back
+typedef struct {
     RecordType type;
     int value;
-    char subject[50];
-    char description[50];      // e.g., "2025-11-01" or "Internal 1"
-    struct PerformanceNode* next;
-} PerformanceNode;
+    SymbolId subject;          // Interned text, see symbolText()
+    SymbolId description;      // e.g., "Internal 1"
+} PerformanceRecord;
 
-// BST node for a student
+// A block of a student's packed history (see history.h)
+typedef struct HistoryChunk HistoryChunk;
+
+// AVL node for a student (self-balancing BST keyed on SRN)
 typedef struct StudentNode {
     char studentSRN[20];
     char name[100];
+    int height;          // AVL height of this subtree (leaf = 1)
+    uint32_t ordinal;    // Dense index into the mark columns (see mark_columns.h)
+    uint32_t dirtyEpoch; // Save epoch this student last changed in (see segment_store.h)
+    uint32_t lazySlot;   // While the history is still in the save file: 1 + its roster position (see block_store.h)
     struct StudentNode* left;
     struct StudentNode* right;
-    PerformanceNode* historyHead;
+    HistoryChunk* historyHead;    // Newest records first
+    HistoryChunk* historyTail;    // Oldest records, so the history can be appended to or released in O(1)
+
+    // The newest mark of each component in each subject is also in the class-wide
+    // columns (see mark_columns.h) at 'ordinal', kept in step by addPerformanceRecord
+    // and appendPerformanceRecord. Attendance is not in the history at all: it
+    // lives in the session bitmaps (see attendance.h).
 } StudentNode;
 
+// The figures a subject report is made of (see summarizeSubject)
+typedef struct {
+    int marks[MARK_COMPONENTS];       // Newest mark per component (type - INTERNAL_1), -1 if none
+    int cieComplete;                  // All of I1, A1, I2 and A2 are present
+    double cieTotal;                  // Sum of those present, out of 50
+    double semesterScaled;            // Semester exam out of 50, -1 if none
+    AttendanceTally attendance;       // This student in this subject
+    AttendanceTally classAttendance;  // Whole class; only filled in when 'attendance' has sessions
+} SubjectSummary;
+
 // BST node for a teacher
 typedef struct TeacherNode {
     char teacherID[20];  // The teacher's unique ID
@@ -42,31 +73,64 @@ typedef struct TeacherNode {
     char password[50];   // Stores the password
     char subject[50];    // The subject they teach
     int failedAttempts;  // Tracks failed login tries
+    uint32_t dirtyEpoch; // Save epoch this teacher last changed in
     
     struct TeacherNode* left;
     struct TeacherNode* right;
 } TeacherNode;
 
+// One student's move to a new SRN (see rekeyStudents)
+typedef struct {
+    char oldSRN[20];
+    char newSRN[20];
+} SRNChange;
+
 
 // --- Function Prototypes ---
 
+// On-disk formats for the save file
+typedef enum {
+    DATA_FORMAT_TEXT,      // Line-oriented TEACHER/STUDENT/RECORD file (import/export)
+    DATA_FORMAT_BINARY,    // Memory-mappable snapshot (see snapshot.h)
+    DATA_FORMAT_SEGMENTED, // Incrementally saved segments (see segment_store.h)
+    DATA_FORMAT_BLOCKS     // Compressed blocks with an SRN index (see block_store.h)
+} DataFormat;
+
 /* --- NEW: File I/O Functions --- */
 void saveData(TeacherNode* teacherRoot, StudentNode* studentRoot);
 void loadData(TeacherNode** teacherRoot, StudentNode** studentRoot);
+int saveDataToFile(const char* path, DataFormat format, TeacherNode* teacherRoot, StudentNode* studentRoot);
+int loadDataFromFile(const char* path, TeacherNode** teacherRoot, StudentNode** studentRoot);
+void setSaveFormat(DataFormat format);
+DataFormat getSaveFormat(void);
+void setDataSequence(uint64_t sequence);
+uint64_t getDataSequence(void);
+// With TRACKER_LAZY=1 set, loading a block file reads only the students'
+// SRNs and names and leaves their histories in the file until they are
+// needed (see block_store.h); saves then use the block format so the next
+// start is lazy too. Off by default and for the server.
+void initLazyLoading(void);
+void setLazyLoading(int enabled);
 
 /* --- Teacher Functions --- */
 TeacherNode* createTeacher(char* id, char* name, char* password, char* subject);
 TeacherNode* addTeacher(TeacherNode* root, char* id, char* name, char* password, char* subject);
-TeacherNode* findTeacher(TeacherNode* root, char* id);
+TeacherNode* findTeacher(TeacherNode* root, const char* id);
+TeacherNode* lookupTeacher(TeacherNode* root, const char* id);
 TeacherNode* login(TeacherNode* root, char* id, char* password);
 void freeTeacherTree(TeacherNode* root);
 
 /* --- Student Functions --- */
 StudentNode* createStudent(char* srn, char* name);
 StudentNode* addStudent(StudentNode* root, char* srn, char* name);
-StudentNode* findStudent(StudentNode* root, char* srn);
+StudentNode* findStudent(StudentNode* root, const char* srn);
+StudentNode* lookupStudent(StudentNode* root, const char* srn);
 StudentNode* findMin(StudentNode* node);
+int studentHeight(StudentNode* node);
+StudentNode* buildBalancedStudentTree(StudentNode** sorted, size_t count);
 StudentNode* deleteStudent(StudentNode* root, char* srn);
+StudentNode* attachStudent(StudentNode* root, StudentNode* node, int* attached);
+StudentNode* detachStudent(StudentNode* root, const char* srn, StudentNode** detached);
 void listAllStudents(StudentNode* root);
 
 /* --- Data Modification Functions --- */
@@ -74,20 +138,49 @@ void modifyStudentName(StudentNode* root, char* srn);
 void modifyMark(StudentNode* root, char* srn);
 StudentNode* modifyStudentSRN(StudentNode* root, char* oldSRN, char* newSRN);
 
-/* --- Linked List (Performance) Functions --- */
-PerformanceNode* createPerformanceNode(RecordType type, int value, char* subject, char* desc);
+/* --- Non-interactive Modification Functions (used by the menu and journal replay) --- */
+void renameStudent(StudentNode* student, char* newName);
+StudentNode* changeStudentSRN(StudentNode* root, char* oldSRN, char* newSRN, int* changed);
+// Moves every listed student of the main tree to its new SRN, or none of them
+// if any change is invalid (the problems are printed). A new SRN may be in
+// use by a student that is itself moving, so shifts (A -> B, B -> C) and
+// swaps work; the batch is journaled as one unit. Sets *rekeyed to the
+// number of students moved.
+StudentNode* rekeyStudents(StudentNode* root, SRNChange* changes, size_t count, size_t* rekeyed);
+// The newest mark of 'type' in 'subject'. Returns 0 if there is none.
+int findMark(StudentNode* student, RecordType type, char* subject, int* value);
+// Changes that mark. Returns 0 (changing nothing) if there is none.
+int updateMark(StudentNode* student, RecordType type, char* subject, int newValue);
+
+/* --- History (Performance) Functions --- */
 void addPerformanceRecord(StudentNode* student, RecordType type, int value, char* subject, char* desc);
+int appendPerformanceRecord(StudentNode* student, RecordType type, int value, SymbolId subject, SymbolId desc);
+void moveHistory(StudentNode* from, StudentNode* to);
+int latestMark(StudentNode* student, RecordType type, SymbolId subject, int* value);
+const char* recordTypeName(RecordType type); // "Internal 1", ...; also the mark's description
+int recordTypeMaxMark(RecordType type);      // Highest valid value (1 for attendance)
 
-/* --- Attendance Function --- */
-void takeAttendance(StudentNode* root, char* date);
+/* --- Attendance Functions --- */
+void takeAttendance(StudentNode* root, char* subject, char* date);
+int recordRollCall(StudentNode* root, char* subject, char* date, char** absentees, int absentCount);
+int splitSRNList(char* text, char** srns, int max);
 
 /* --- Reporting Functions --- */
 void generateSubjectReport(StudentNode* student, char* subjectName);
 void generateMasterReport(StudentNode* student);
+void generateClassStatsReport(char* subjectName, RecordType type);
+// Once every history is in memory (faultInAllHistories) this only reads
+// shared state, so several threads may summarize students at once.
+// 'classTally' may carry a precomputed classAttendance() for the subject, or be NULL.
+void summarizeSubject(StudentNode* student, const char* subjectName, const AttendanceTally* classTally,
+                      SubjectSummary* summary);
 
 /* --- Memory Freeing Functions --- */
-void freeHistory(PerformanceNode* head);
+// Nodes come from pools (see node_pool.h), so these never call free() per node.
+void releaseHistory(StudentNode* student);
+void freeStudent(StudentNode* student);
 void freeTree(StudentNode* root);
+void releaseAllData(void);
 
 
 #endif // STUDENT_TRACKER_H
\ No newline at end of file
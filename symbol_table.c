@@ -0,0 +1,131 @@
+#include "symbol_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SYMBOL_CHUNK_BYTES (64 * 1024)
+
+// Text lives in chunks that never move, so symbolText pointers stay valid.
+typedef struct SymbolChunk {
+    struct SymbolChunk* next;
+    size_t used;
+    size_t capacity;
+    char text[];
+} SymbolChunk;
+
+static SymbolChunk* chunks = NULL;
+static const char** texts = NULL;    // Indexed by SymbolId
+static size_t count = 0;
+static size_t capacity = 0;
+static SymbolId* slots = NULL;       // Open-addressing table of (id + 1), 0 = empty
+static size_t slotCount = 0;
+
+static uint32_t hashText(const char* text) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int growSlots(void) {
+    size_t newCount = slotCount ? slotCount * 2 : 1024;
+    SymbolId* newSlots = (SymbolId*)calloc(newCount, sizeof(SymbolId));
+    if (newSlots == NULL) return 0;
+    for (size_t i = 0; i < slotCount; i++) {
+        if (slots[i] == 0) continue;
+        size_t pos = hashText(texts[slots[i] - 1]) & (newCount - 1);
+        while (newSlots[pos] != 0) pos = (pos + 1) & (newCount - 1);
+        newSlots[pos] = slots[i];
+    }
+    free(slots);
+    slots = newSlots;
+    slotCount = newCount;
+    return 1;
+}
+
+static const char* storeText(const char* text, size_t length) {
+    if (chunks == NULL || chunks->capacity - chunks->used < length + 1) {
+        size_t size = length + 1 > SYMBOL_CHUNK_BYTES ? length + 1 : SYMBOL_CHUNK_BYTES;
+        SymbolChunk* chunk = (SymbolChunk*)malloc(sizeof(SymbolChunk) + size);
+        if (chunk == NULL) return NULL;
+        chunk->next = chunks;
+        chunk->used = 0;
+        chunk->capacity = size;
+        chunks = chunk;
+    }
+    char* stored = chunks->text + chunks->used;
+    memcpy(stored, text, length + 1);
+    chunks->used += length + 1;
+    return stored;
+}
+
+// Finds the slot holding 'text', or the empty slot where it would go.
+static size_t findSlot(const char* text) {
+    size_t pos = hashText(text) & (slotCount - 1);
+    while (slots[pos] != 0 && strcmp(texts[slots[pos] - 1], text) != 0) {
+        pos = (pos + 1) & (slotCount - 1);
+    }
+    return pos;
+}
+
+SymbolId internSymbol(const char* text) {
+    if (text[0] == '\0') return SYMBOL_EMPTY;
+    if (count == 0) {
+        // Reserve id 0 for the empty string.
+        if (!growSlots()) return SYMBOL_INVALID;
+        texts = (const char**)malloc(256 * sizeof(const char*));
+        if (texts == NULL) return SYMBOL_INVALID;
+        capacity = 256;
+        texts[count++] = "";
+    }
+    if ((count + 1) * 2 > slotCount && !growSlots()) return SYMBOL_INVALID;
+
+    size_t pos = findSlot(text);
+    if (slots[pos] != 0) return slots[pos] - 1;
+
+    if (count == capacity) {
+        const char** grown = (const char**)realloc((void*)texts, capacity * 2 * sizeof(const char*));
+        if (grown == NULL) return SYMBOL_INVALID;
+        texts = grown;
+        capacity *= 2;
+    }
+    const char* stored = storeText(text, strlen(text));
+    if (stored == NULL) return SYMBOL_INVALID;
+    texts[count] = stored;
+    slots[pos] = (SymbolId)count + 1;
+    return (SymbolId)count++;
+}
+
+int lookupSymbol(const char* text, SymbolId* id) {
+    if (text[0] == '\0') {
+        *id = SYMBOL_EMPTY;
+        return 1;
+    }
+    if (slotCount == 0) return 0;
+    size_t pos = findSlot(text);
+    if (slots[pos] == 0) return 0;
+    *id = slots[pos] - 1;
+    return 1;
+}
+
+const char* symbolText(SymbolId id) {
+    return (id < count) ? texts[id] : "";
+}
+
+size_t symbolCount(void) {
+    return count ? count : 1;
+}
+
+void releaseSymbols(void) {
+    while (chunks != NULL) {
+        SymbolChunk* next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+    free((void*)texts);
+    free(slots);
+    texts = NULL;
+    slots = NULL;
+    count = capacity = slotCount = 0;
+}
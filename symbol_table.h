@@ -0,0 +1,35 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Interned Strings ---
+//
+// Record subjects and descriptions repeat endlessly ("Attendance",
+// "Internal 1", a handful of subjects, one date per class), so records store
+// a SymbolId instead of the text. Each distinct string is stored once and
+// two records share a subject exactly when their ids are equal.
+
+typedef uint32_t SymbolId;
+
+#define SYMBOL_EMPTY 0               // Always the empty string
+#define SYMBOL_INVALID UINT32_MAX    // Returned when memory runs out
+
+// Returns the id for 'text', adding it on first use.
+SymbolId internSymbol(const char* text);
+
+// Looks 'text' up without adding it. Returns 0 if it was never interned,
+// in which case no record can refer to it.
+int lookupSymbol(const char* text, SymbolId* id);
+
+// The text of a valid id. The pointer stays valid until releaseSymbols.
+const char* symbolText(SymbolId id);
+
+// Number of ids handed out so far (ids run from 0 to symbolCount() - 1).
+size_t symbolCount(void);
+
+// Forgets every symbol. Only safe once no record refers to one.
+void releaseSymbols(void);
+
+#endif // SYMBOL_TABLE_H
@@ -0,0 +1,123 @@
+// Tests: LZ block codec round trips and malformed blocks.
+//
+// Built by CMake (target test_lz_codec) and run by ctest.
+//
+// Every input size around the codec's edges (empty, shorter than a match,
+// literal and match lengths that need extra length bytes, the largest
+// offset) is compressed and decompressed in several kinds of content.
+// Damaged blocks must be rejected or at least stay inside their buffers.
+
+#include "lz_codec.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD_BYTES 64
+#define GUARD_VALUE 0xA5
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition) != 0, #condition, __LINE__)
+
+static void check(int ok, const char* what, int line) {
+    if (ok) return;
+    printf("FAIL (line %d): %s\n", line, what);
+    failures++;
+}
+
+typedef enum { CONTENT_ZEROS, CONTENT_RANDOM, CONTENT_TEXT, CONTENT_SHORT_PERIOD, CONTENT_FAR_REPEAT, CONTENT_KINDS } Content;
+
+static const char* contentNames[CONTENT_KINDS] = { "zeros", "random", "text", "period 3", "far repeat" };
+
+static uint32_t nextRandom(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void fillContent(char* data, size_t size, Content content) {
+    static const char text[] = "STUDENT\nPES1UG22CS042\nAsha Rao\nRECORD\n0\n1\nMathematics\n2025-08-01\n";
+    uint32_t state = 2463534242u;
+    for (size_t i = 0; i < size; i++) {
+        switch (content) {
+            case CONTENT_ZEROS: data[i] = 0; break;
+            case CONTENT_RANDOM: data[i] = (char)nextRandom(&state); break;
+            case CONTENT_TEXT: data[i] = (nextRandom(&state) % 50 == 0) ? 'x' : text[i % (sizeof(text) - 1)]; break;
+            case CONTENT_SHORT_PERIOD: data[i] = "abc"[i % 3]; break;
+            default:
+                // Random bytes that repeat at the largest offset a match can reach.
+                data[i] = (i >= LZ_MAX_OFFSET) ? data[i - LZ_MAX_OFFSET] : (char)nextRandom(&state);
+                break;
+        }
+    }
+}
+
+static int guardIntact(const unsigned char* guard) {
+    for (size_t i = 0; i < GUARD_BYTES; i++) {
+        if (guard[i] != GUARD_VALUE) return 0;
+    }
+    return 1;
+}
+
+// Decompresses into a buffer of exactly 'rawSize' bytes followed by guard
+// bytes, and checks that the guard survived. Returns lzDecompress's result.
+static int decompressGuarded(const char* block, size_t size, char* out, size_t rawSize) {
+    memset(out + rawSize, GUARD_VALUE, GUARD_BYTES);
+    int ok = lzDecompress(block, size, out, rawSize);
+    CHECK(guardIntact((const unsigned char*)out + rawSize));
+    return ok;
+}
+
+static void testRoundTrip(size_t size, Content content) {
+    char* data = (char*)malloc(size + 1);
+    char* block = (char*)malloc(lzCompressBound(size));
+    char* out = (char*)malloc(size + 1 + GUARD_BYTES);
+    if (data == NULL || block == NULL || out == NULL) {
+        printf("Error: Out of memory.\n");
+        failures++;
+        free(data);
+        free(block);
+        free(out);
+        return;
+    }
+    fillContent(data, size, content);
+    size_t packed = lzCompress(data, size, block);
+    int failed = failures;
+    CHECK(packed > 0 && packed <= lzCompressBound(size));
+    CHECK(decompressGuarded(block, packed, out, size));
+    CHECK(memcmp(data, out, size) == 0);
+
+    // A wrong raw size, a cut block and a damaged first token. (With nothing
+    // left of it, a cut empty block is simply empty.)
+    CHECK(!decompressGuarded(block, packed, out, size + 1));
+    if (size > 0) {
+        CHECK(!decompressGuarded(block, packed, out, size - 1));
+        CHECK(!decompressGuarded(block, packed - 1, out, size));
+    }
+    block[0] ^= 0x10;
+    decompressGuarded(block, packed, out, size);
+    if (failures > failed) printf("  (size %zu, %s)\n", size, contentNames[content]);
+
+    free(data);
+    free(block);
+    free(out);
+}
+
+int main(void) {
+    static const size_t sizes[] = {
+        0, 1, 2, 3, 4, 5, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 31, 64, 254, 255, 256, 269, 270, 271, 4095, 4096,
+        65534, 65535, 65536, 65537, 200000, 1 << 20
+    };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int content = 0; content < CONTENT_KINDS; content++) testRoundTrip(sizes[i], (Content)content);
+    }
+
+    if (failures > 0) {
+        printf("%d check(s) failed.\n", failures);
+        return 1;
+    }
+    printf("All LZ codec tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,450 @@
+// Tests: save/load round trips, damaged files, journal replay, discarding a
+// compacted session and packed histories.
+//
+// Built by CMake (target test_storage) and run by ctest. It works in a fresh
+// directory under the current one, since the journal uses fixed file names.
+//
+// Each round trip saves a class in one format, loads it into empty trees and
+// saves it as text again; the text must match the original byte for byte.
+
+#include "student_tracker.h"
+#include "bulk_load.h"
+#include "history.h"
+#include "journal.h"
+#include "snapshot.h"
+#include <stddef.h>
+#include <unistd.h>
+
+#define CLASS_STUDENTS 300
+#define CLASS_DAYS 60 // Enough roll calls for a text file the parallel loader takes
+
+static const char* subjects[] = { "Mathematics", "Physics", "Chemistry", "English", "Biology", "History" };
+#define SUBJECT_COUNT (int)(sizeof(subjects) / sizeof(subjects[0]))
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition) != 0, #condition, __LINE__)
+
+static void check(int ok, const char* what, int line) {
+    if (ok) return;
+    printf("FAIL (line %d): %s\n", line, what);
+    failures++;
+}
+
+// --- Files ---
+
+static char* readFile(const char* path, size_t* size) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char* data = (char*)malloc(length > 0 ? (size_t)length : 1);
+    if (data != NULL && fread(data, 1, (size_t)length, fp) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    *size = (size_t)length;
+    return data;
+}
+
+static int writeFile(const char* path, const char* data, size_t size) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return 0;
+    int ok = fwrite(data, 1, size, fp) == size;
+    return fclose(fp) == 0 && ok;
+}
+
+static int sameFiles(const char* first, const char* second) {
+    size_t sizeA = 0, sizeB = 0;
+    char* a = readFile(first, &sizeA);
+    char* b = readFile(second, &sizeB);
+    int same = a != NULL && b != NULL && sizeA == sizeB && memcmp(a, b, sizeA) == 0;
+    free(a);
+    free(b);
+    return same;
+}
+
+// Copies 'path' to 'damaged', keeping its first 'keep' bytes and flipping
+// the low bit of byte 'flipAt' (when it is inside them).
+static int writeDamagedCopy(const char* path, const char* damaged, size_t keep, size_t flipAt) {
+    size_t size = 0;
+    char* data = readFile(path, &size);
+    if (data == NULL) return 0;
+    if (keep > size) keep = size;
+    if (flipAt < keep) data[flipAt] ^= 1;
+    int ok = writeFile(damaged, data, keep);
+    free(data);
+    return ok;
+}
+
+static size_t fileSize(const char* path) {
+    size_t size = 0;
+    free(readFile(path, &size));
+    return size;
+}
+
+// --- Test Class ---
+
+#define DATE_SIZE 11 // "2025-mm-dd"
+
+// Four-week months from August on; the bounds let the compiler see that it fits.
+static void roll(unsigned day, char* date) {
+    snprintf(date, DATE_SIZE, "2025-%02u-%02u", 8 + (day / 28) % 4, 1 + day % 28);
+}
+
+// Teachers, then students with the five marks in every subject (some of
+// them negative or with a description of their own) and a roll call per
+// subject and day. Every 17th student has no records at all.
+static void buildClass(TeacherNode** teacherRoot, StudentNode** studentRoot) {
+    char id[20], name[100], password[50] = "password123", subject[50], date[DATE_SIZE];
+    for (int s = 0; s < SUBJECT_COUNT; s++) {
+        snprintf(id, sizeof(id), "TS%03d", s + 1);
+        snprintf(name, sizeof(name), "Teacher of %s", subjects[s]);
+        snprintf(subject, sizeof(subject), "%s", subjects[s]);
+        *teacherRoot = addTeacher(*teacherRoot, id, name, password, subject);
+    }
+    for (int i = 0; i < CLASS_STUDENTS; i++) {
+        char srn[20];
+        snprintf(srn, sizeof(srn), "PES1UG22CS%03d", (i * 7) % CLASS_STUDENTS); // Not in SRN order
+        snprintf(name, sizeof(name), "Student %d", i);
+        *studentRoot = addStudent(*studentRoot, srn, name);
+    }
+    for (int i = 0; i < CLASS_STUDENTS; i++) {
+        if (i % 17 == 0) continue;
+        char srn[20];
+        snprintf(srn, sizeof(srn), "PES1UG22CS%03d", i);
+        StudentNode* student = findStudent(*studentRoot, srn);
+        for (int s = 0; s < SUBJECT_COUNT; s++) {
+            snprintf(subject, sizeof(subject), "%s", subjects[s]);
+            for (int type = INTERNAL_1; type <= SEMESTER_EXAM; type++) {
+                char description[50];
+                snprintf(description, sizeof(description), "%s", recordTypeName((RecordType)type));
+                if (i % 23 == 0 && type == ASSIGNMENT_2) snprintf(description, sizeof(description), "Resubmitted");
+                int value = (i * 13 + s * 5 + type) % recordTypeMaxMark((RecordType)type);
+                if (i % 29 == 0 && type == INTERNAL_2) value = -1;
+                addPerformanceRecord(student, (RecordType)type, value, subject, description);
+            }
+            for (unsigned day = 0; day < CLASS_DAYS; day++) {
+                roll(day, date);
+                addPerformanceRecord(student, ATTENDANCE, (i + s + (int)day) % 7 != 0, subject, date);
+            }
+        }
+    }
+}
+
+// --- Round Trips ---
+
+static const char* formatName(DataFormat format) {
+    switch (format) {
+        case DATA_FORMAT_BINARY: return "binary";
+        case DATA_FORMAT_SEGMENTED: return "segmented";
+        case DATA_FORMAT_BLOCKS: return "blocks";
+        default: return "text";
+    }
+}
+
+// Loads 'path' into empty trees and saves it as text to 'textPath'.
+// Returns 0 if either fails.
+static int loadAsText(const char* path, const char* textPath) {
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    int ok = loadDataFromFile(path, &teachers, &students) &&
+             saveDataToFile(textPath, DATA_FORMAT_TEXT, teachers, students);
+    releaseAllData();
+    return ok;
+}
+
+static void testTextRoundTrip(const char* classPath) {
+    printf("text round trip\n");
+    setBulkLoadThreads(1);
+    CHECK(loadAsText(classPath, "text.out"));
+    CHECK(sameFiles(classPath, "text.out"));
+    CHECK(fileSize(classPath) > 2 * (size_t)BULK_CHUNK_BYTES); // So the next load is the parallel one
+    setBulkLoadThreads(4);
+    CHECK(loadAsText(classPath, "text_parallel.out"));
+    CHECK(sameFiles(classPath, "text_parallel.out"));
+    CHECK(getDataSequence() == 42);
+    setBulkLoadThreads(0);
+}
+
+static void testRoundTrip(const char* classPath, DataFormat format, const char* path, int lazy) {
+    printf("%s round trip%s\n", formatName(format), lazy ? " (lazy)" : "");
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    CHECK(loadDataFromFile(classPath, &teachers, &students));
+    CHECK(saveDataToFile(path, format, teachers, students));
+    releaseAllData();
+    setDataSequence(0);
+    setLazyLoading(lazy);
+    CHECK(loadAsText(path, "round_trip.out"));
+    setLazyLoading(0);
+    CHECK(sameFiles(classPath, "round_trip.out"));
+    CHECK(getDataSequence() == 42);
+}
+
+// --- Damaged Files ---
+
+// A cut file and one with a flipped bit must both fail to load. The
+// snapshot has no checksum over its sections, only structural checks, so
+// its flipped bit goes into the header; the other formats checksum every
+// byte, so theirs goes in the middle of the file.
+static void testDamagedFile(DataFormat format, const char* path) {
+    printf("damaged %s files\n", formatName(format));
+    size_t size = fileSize(path);
+    size_t flipAt = (format == DATA_FORMAT_BINARY) ? offsetof(SnapshotHeader, studentCount) : size / 2;
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    CHECK(writeDamagedCopy(path, "damaged.dat", size / 2, size));
+    CHECK(!loadDataFromFile("damaged.dat", &teachers, &students));
+    releaseAllData();
+    teachers = NULL;
+    students = NULL;
+    CHECK(writeDamagedCopy(path, "damaged.dat", size - 1, size));
+    CHECK(!loadDataFromFile("damaged.dat", &teachers, &students));
+    releaseAllData();
+    teachers = NULL;
+    students = NULL;
+    CHECK(writeDamagedCopy(path, "damaged.dat", size, flipAt));
+    CHECK(!loadDataFromFile("damaged.dat", &teachers, &students));
+    releaseAllData();
+    remove("damaged.dat");
+}
+
+// --- Journal ---
+
+// Makes journaled changes of every kind, syncs and reopens: the replay must
+// rebuild the same data. The last entry is torn in half first, so replay
+// must drop it and only it.
+static void testJournalReplay(void) {
+    printf("journal replay\n");
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    char id[20] = "TS001", name[100] = "Ada", password[50] = "pw", subject[50] = "Physics";
+    char date[DATE_SIZE] = "2025-09-01", resit[50] = "Resit";
+    remove(JOURNAL_FILE);
+    setDataSequence(0);
+    CHECK(journalStart(&teachers, &students));
+    teachers = addTeacher(teachers, id, name, password, subject);
+    char srns[4][20] = { "PES1UG22CS001", "PES1UG22CS002", "PES1UG22CS003", "PES1UG22CS004" };
+    for (int i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "Student %d", i);
+        students = addStudent(students, srns[i], name);
+        StudentNode* student = findStudent(students, srns[i]);
+        addPerformanceRecord(student, INTERNAL_1, 10 + i, subject, (char*)recordTypeName(INTERNAL_1));
+        addPerformanceRecord(student, ATTENDANCE, i % 2, subject, date);
+    }
+    snprintf(name, sizeof(name), "Renamed");
+    renameStudent(findStudent(students, srns[0]), name);
+    CHECK(updateMark(findStudent(students, srns[1]), INTERNAL_1, subject, 19));
+    int changed = 0;
+    char newSRN[20] = "PES1UG22CS100";
+    students = changeStudentSRN(students, srns[2], newSRN, &changed);
+    CHECK(changed);
+    SRNChange swap[2] = { { "PES1UG22CS001", "PES1UG22CS002" }, { "PES1UG22CS002", "PES1UG22CS001" } };
+    size_t rekeyed = 0;
+    students = rekeyStudents(students, swap, 2, &rekeyed);
+    CHECK(rekeyed == 2);
+    students = deleteStudent(students, srns[3]);
+    CHECK(saveDataToFile("journal_expected.txt", DATA_FORMAT_TEXT, teachers, students));
+
+    addPerformanceRecord(findStudent(students, srns[0]), SEMESTER_EXAM, 77, subject, resit);
+    journalSync();
+    journalClose();
+    size_t size = fileSize(JOURNAL_FILE);
+    CHECK(size > 0 && truncate(JOURNAL_FILE, (off_t)(size - 3)) == 0);
+    releaseAllData();
+    teachers = NULL;
+    students = NULL;
+    setDataSequence(0);
+
+    CHECK(journalStart(&teachers, &students));
+    CHECK(saveDataToFile("journal_replayed.txt", DATA_FORMAT_TEXT, teachers, students));
+    journalClose();
+    releaseAllData();
+    CHECK(sameFiles("journal_expected.txt", "journal_replayed.txt"));
+    remove(JOURNAL_FILE);
+    remove("journal_expected.txt");
+    remove("journal_replayed.txt");
+}
+
+// A session that grows the journal past the compaction threshold has its
+// changes folded into data.dat by a background process; discarding the
+// session must still bring back data.dat and the journal of the last sync.
+static void testDiscardAfterCompaction(void) {
+    printf("discard after compaction\n");
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    char id[20] = "TS001", name[100] = "Ada", password[50] = "pw", subject[50] = "Physics", date[DATE_SIZE];
+    char srns[3][20] = { "PES1UG22CS001", "PES1UG22CS002", "PES1UG22CS003" };
+    remove(JOURNAL_FILE);
+    teachers = addTeacher(teachers, id, name, password, subject);
+    students = addStudent(students, srns[0], name);
+    setDataSequence(0);
+    CHECK(saveDataToFile(SAVE_FILE, getSaveFormat(), teachers, students));
+    size_t size = 0;
+    char* before = readFile(SAVE_FILE, &size);
+    CHECK(before != NULL && writeFile("discard_before.dat", before, size));
+    free(before);
+    releaseAllData();
+    teachers = NULL;
+    students = NULL;
+
+    setDataSequence(0);
+    CHECK(loadDataFromFile(SAVE_FILE, &teachers, &students));
+    CHECK(journalStart(&teachers, &students));
+    snprintf(name, sizeof(name), "Synced");
+    students = addStudent(students, srns[1], name);
+    journalSync();
+    CHECK(saveDataToFile("discard_expected.txt", DATA_FORMAT_TEXT, teachers, students));
+
+    // Over the threshold in one group (every entry is more than 40 bytes).
+    journalBeginGroup();
+    for (unsigned i = 0; i < JOURNAL_COMPACT_THRESHOLD / 40; i++) {
+        roll(i % 112, date);
+        addPerformanceRecord(findStudent(students, srns[i % 2]), ATTENDANCE, (int)(i % 3 != 0), subject, date);
+    }
+    journalEndGroup();
+    journalMaybeCompact(teachers, students);
+    CHECK(fileSize(JOURNAL_FILE) < (size_t)JOURNAL_COMPACT_THRESHOLD);
+    CHECK(fileSize(JOURNAL_ROLLBACK_FILE) > 0);
+    snprintf(name, sizeof(name), "After rotation");
+    students = addStudent(students, srns[2], name);
+
+    CHECK(journalDiscardUnsynced());
+    journalClose();
+    releaseAllData();
+    teachers = NULL;
+    students = NULL;
+    CHECK(sameFiles(SAVE_FILE, "discard_before.dat"));
+    CHECK(fileSize(JOURNAL_ROLLBACK_FILE) == 0 && fileSize(SAVE_ROLLBACK_FILE) == 0);
+
+    setDataSequence(0);
+    CHECK(loadDataFromFile(SAVE_FILE, &teachers, &students));
+    CHECK(journalStart(&teachers, &students));
+    CHECK(saveDataToFile("discard_replayed.txt", DATA_FORMAT_TEXT, teachers, students));
+    journalClose();
+    releaseAllData();
+    CHECK(sameFiles("discard_expected.txt", "discard_replayed.txt"));
+    const char* files[] = { SAVE_FILE, JOURNAL_FILE, "discard_before.dat", "discard_expected.txt", "discard_replayed.txt" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) remove(files[i]);
+}
+
+// --- Packed Histories ---
+
+#define HISTORY_TEST_RECORDS 400
+
+// Pushes and appends records of every shape (runs, negative and large
+// values, types outside the enum, repeated and changing subjects) and
+// reads them back in order, before and after rewriting values inside runs.
+static void testPackedHistory(void) {
+    printf("packed history\n");
+    PerformanceRecord expected[HISTORY_TEST_RECORDS];
+    size_t count = 0;
+    char srn[20] = "PES1UG22CS999", name[100] = "History";
+    StudentNode* student = createStudent(srn, name);
+    CHECK(student != NULL);
+    if (student == NULL) return;
+    SymbolId subjectIds[3] = { internSymbol("Mathematics"), internSymbol("Physics"), internSymbol("Chemistry") };
+    SymbolId custom = internSymbol("Custom");
+    for (int i = 0; count < HISTORY_TEST_RECORDS - 1; i++) {
+        PerformanceRecord record;
+        int shape = i % 5;
+        record.subject = subjectIds[(i / 7) % 3];
+        if (shape == 0 || shape == 1) {
+            record.type = (RecordType)(SEMESTER_EXAM - i % MARK_COMPONENTS); // Runs, newest first
+            record.description = internSymbol(recordTypeName(record.type));
+            record.value = i % 40;
+        } else if (shape == 2) {
+            record.type = INTERNAL_2;
+            record.description = custom;
+            record.value = -(i * 1000003);
+        } else if (shape == 3) {
+            record.type = (RecordType)(100 + i);
+            record.description = custom;
+            record.value = 1 << 30;
+        } else {
+            record.type = ASSIGNMENT_1;
+            record.description = internSymbol(recordTypeName(ASSIGNMENT_1));
+            record.value = -5;
+        }
+        if (i % 3 == 0) {
+            CHECK(pushHistoryRecord(student, &record));
+            memmove(expected + 1, expected, count * sizeof(PerformanceRecord));
+            expected[0] = record;
+        } else {
+            CHECK(appendHistoryRecord(student, &record));
+            expected[count] = record;
+        }
+        count++;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        HistoryCursor cursor;
+        PerformanceRecord record;
+        size_t read = 0;
+        int same = 1;
+        openHistoryCursor(&cursor, student);
+        while (nextHistoryRecord(&cursor, &record)) {
+            if (read >= count || record.type != expected[read].type || record.value != expected[read].value ||
+                record.subject != expected[read].subject || record.description != expected[read].description) same = 0;
+            read++;
+        }
+        CHECK(same && read == count);
+
+        // Rewrites the newest mark of each type in one subject, splitting runs.
+        for (int type = INTERNAL_1; type <= SEMESTER_EXAM; type++) {
+            for (size_t i = 0; i < count; i++) {
+                if (expected[i].type != (RecordType)type || expected[i].subject != subjectIds[1]) continue;
+                int value = (pass == 0) ? 123456 : -7;
+                CHECK(rewriteHistoryValue(student, (RecordType)type, subjectIds[1], value));
+                expected[i].value = value;
+                break;
+            }
+        }
+    }
+    freeStudent(student);
+    releaseAllData();
+}
+
+int main(void) {
+    char directory[] = "test_storage_XXXXXX";
+    if (mkdtemp(directory) == NULL || chdir(directory) != 0) {
+        printf("Error: Could not create a working directory.\n");
+        return 1;
+    }
+
+    TeacherNode* teachers = NULL;
+    StudentNode* students = NULL;
+    buildClass(&teachers, &students);
+    setDataSequence(42);
+    int saved = saveDataToFile("class.txt", DATA_FORMAT_TEXT, teachers, students);
+    releaseAllData();
+    CHECK(saved);
+
+    if (saved) {
+        testTextRoundTrip("class.txt");
+        testRoundTrip("class.txt", DATA_FORMAT_BINARY, "class.snap", 0);
+        testRoundTrip("class.txt", DATA_FORMAT_SEGMENTED, "class.seg", 0);
+        testRoundTrip("class.txt", DATA_FORMAT_BLOCKS, "class.blk", 0);
+        testRoundTrip("class.txt", DATA_FORMAT_BLOCKS, "class.blk", 1);
+        testDamagedFile(DATA_FORMAT_BINARY, "class.snap");
+        testDamagedFile(DATA_FORMAT_SEGMENTED, "class.seg");
+        testDamagedFile(DATA_FORMAT_BLOCKS, "class.blk");
+    }
+    testJournalReplay();
+    testDiscardAfterCompaction();
+    testPackedHistory();
+
+    const char* files[] = { "class.txt", "class.snap", "class.seg", "class.blk", "text.out", "text_parallel.out", "round_trip.out" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) remove(files[i]);
+    if (chdir("..") == 0) rmdir(directory);
+
+    if (failures > 0) {
+        printf("%d check(s) failed.\n", failures);
+        return 1;
+    }
+    printf("All storage tests passed.\n");
+    return 0;
+}
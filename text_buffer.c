@@ -0,0 +1,61 @@
+#include "text_buffer.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int textReserve(TextBuffer* buf, size_t extra) {
+    if (buf->failed) return 0;
+    if (buf->size + extra + 1 <= buf->capacity) return 1;
+    size_t capacity = buf->capacity ? buf->capacity : 4096;
+    while (capacity < buf->size + extra + 1) capacity *= 2;
+    char* grown = (char*)realloc(buf->data, capacity);
+    if (grown == NULL) {
+        buf->failed = 1;
+        return 0;
+    }
+    buf->data = grown;
+    buf->capacity = capacity;
+    return 1;
+}
+
+void textAppend(TextBuffer* buf, const char* text, size_t length) {
+    if (!textReserve(buf, length)) return;
+    memcpy(buf->data + buf->size, text, length);
+    buf->size += length;
+    buf->data[buf->size] = '\0';
+}
+
+void textPrintf(TextBuffer* buf, const char* format, ...) {
+    if (!textReserve(buf, 256)) return;
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buf->data + buf->size, buf->capacity - buf->size, format, args);
+    va_end(args);
+    if (length < 0) return;
+    if ((size_t)length >= buf->capacity - buf->size) {
+        // Did not fit: grow to the exact size and format again.
+        if (!textReserve(buf, (size_t)length)) return;
+        va_start(args, format);
+        vsnprintf(buf->data + buf->size, buf->capacity - buf->size, format, args);
+        va_end(args);
+    }
+    buf->size += (size_t)length;
+}
+
+void textReset(TextBuffer* buf) {
+    buf->size = 0;
+    buf->failed = 0;
+    if (buf->data != NULL) buf->data[0] = '\0';
+}
+
+void textFree(TextBuffer* buf) {
+    free(buf->data);
+    buf->data = NULL;
+    buf->size = buf->capacity = 0;
+    buf->failed = 0;
+}
+
+int textWrite(const TextBuffer* buf, FILE* fp) {
+    if (buf->failed) return 0;
+    return buf->size == 0 || fwrite(buf->data, 1, buf->size, fp) == buf->size;
+}
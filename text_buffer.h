@@ -0,0 +1,37 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// --- Text Buffers ---
+//
+// Reports are rendered into a growable buffer instead of being printed
+// piece by piece, so they can be written with one call, kept for later, or
+// built on several threads at once (each thread owns its buffer).
+
+typedef struct {
+    char* data;      // Always NUL-terminated once anything was appended
+    size_t size;
+    size_t capacity;
+    int failed;      // Set if memory ran out; later appends are dropped
+} TextBuffer;
+
+#define TEXT_BUFFER_INIT { NULL, 0, 0, 0 }
+
+void textAppend(TextBuffer* buf, const char* text, size_t length);
+void textPrintf(TextBuffer* buf, const char* format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+// Empties the buffer but keeps its memory for reuse.
+void textReset(TextBuffer* buf);
+void textFree(TextBuffer* buf);
+
+// Writes the contents to 'fp'. Returns 0 on a write error or if the buffer
+// ran out of memory while it was being filled.
+int textWrite(const TextBuffer* buf, FILE* fp);
+
+#endif // TEXT_BUFFER_H
@@ -0,0 +1,111 @@
+#include "tree_cursor.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CHILD(node, offset) (*(void**)((char*)(node) + (offset)))
+
+// --- Stack ---
+
+static int growStack(TreeCursor* cursor) {
+    size_t capacity = cursor->capacity * 2;
+    void** grown;
+    if (cursor->stack == cursor->inlineStack) {
+        grown = (void**)malloc(capacity * sizeof(void*));
+        if (grown != NULL) memcpy(grown, cursor->inlineStack, cursor->depth * sizeof(void*));
+    } else {
+        grown = (void**)realloc(cursor->stack, capacity * sizeof(void*));
+    }
+    if (grown == NULL) return 0;
+    cursor->stack = grown;
+    cursor->capacity = capacity;
+    return 1;
+}
+
+static int push(TreeCursor* cursor, void* node) {
+    if (cursor->depth == cursor->capacity && !growStack(cursor)) {
+        cursor->failed = 1;
+        return 0;
+    }
+    cursor->stack[cursor->depth++] = node;
+    return 1;
+}
+
+static void pushLeftSpine(TreeCursor* cursor, void* node) {
+    while (node != NULL && push(cursor, node)) node = CHILD(node, cursor->leftOffset);
+}
+
+// --- Walking ---
+
+void openCursor(TreeCursor* cursor, void* root, size_t leftOffset, size_t rightOffset, CursorOrder order) {
+    cursor->order = order;
+    cursor->leftOffset = leftOffset;
+    cursor->rightOffset = rightOffset;
+    cursor->stack = cursor->inlineStack;
+    cursor->depth = 0;
+    cursor->capacity = TREE_CURSOR_INLINE;
+    cursor->failed = 0;
+    if (root == NULL) return;
+    if (order == CURSOR_IN_ORDER) pushLeftSpine(cursor, root);
+    else push(cursor, root);
+}
+
+// In-order, the top of the stack is always the next node: returning it
+// pushes the left spine of its right subtree. Pre-order pushes the right
+// child under the left one, so the left subtree is finished first.
+void* cursorNext(TreeCursor* cursor) {
+    if (cursor->depth == 0 || cursor->failed) return NULL;
+    void* node = cursor->stack[--cursor->depth];
+    void* right = CHILD(node, cursor->rightOffset);
+    if (cursor->order == CURSOR_IN_ORDER) {
+        pushLeftSpine(cursor, right);
+    } else {
+        void* left = CHILD(node, cursor->leftOffset);
+        if (right != NULL) push(cursor, right);
+        if (left != NULL) push(cursor, left);
+    }
+    return node;
+}
+
+void* cursorPeek(const TreeCursor* cursor) {
+    return (cursor->depth == 0 || cursor->failed) ? NULL : cursor->stack[cursor->depth - 1];
+}
+
+void closeCursor(TreeCursor* cursor) {
+    if (cursor->stack != cursor->inlineStack) free(cursor->stack);
+    cursor->stack = cursor->inlineStack;
+    cursor->depth = 0;
+    cursor->capacity = TREE_CURSOR_INLINE;
+}
+
+// Like pushLeftSpine, but only nodes at or above 'low' are on the path
+// still to visit; smaller ones are passed by to the right.
+void seekStudentCursor(TreeCursor* cursor, StudentNode* root, const char* low) {
+    openStudentCursor(cursor, NULL, CURSOR_IN_ORDER);
+    while (root != NULL) {
+        if (strcmp(root->studentSRN, low) >= 0) {
+            if (!push(cursor, root)) return;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+}
+
+size_t countStudentTree(StudentNode* root) {
+    TreeCursor cursor;
+    size_t count = 0;
+    openStudentCursor(&cursor, root, CURSOR_PRE_ORDER); // Pre-order keeps the stack shallower
+    while (cursorNext(&cursor) != NULL) count++;
+    closeCursor(&cursor);
+    return count;
+}
+
+size_t flattenStudentTree(StudentNode* root, StudentNode** out) {
+    TreeCursor cursor;
+    StudentNode* student;
+    size_t count = 0;
+    openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+    while ((student = nextStudent(&cursor)) != NULL) out[count++] = student;
+    closeCursor(&cursor);
+    return count;
+}
@@ -0,0 +1,69 @@
+#ifndef TREE_CURSOR_H
+#define TREE_CURSOR_H
+
+#include <stddef.h>
+#include "student_tracker.h"
+
+// --- Tree Cursors ---
+//
+// Walks a student or teacher tree without recursion. The nodes still to
+// visit are kept on an explicit stack, which lives inside the cursor for
+// the first TREE_CURSOR_INLINE levels (more than any AVL student tree ever
+// needs) and moves to the heap only for a degenerate tree, such as a
+// teacher tree built from sorted IDs.
+//
+// In-order visits nodes in key order. Pre-order visits each node before
+// its subtrees, which is the order the save files keep teachers in, so
+// reloading rebuilds the same tree. Either way a node is off the stack
+// before it is returned, so the caller may free it (the pools reuse its
+// left pointer) and carry on.
+//
+//   TreeCursor cursor;
+//   StudentNode* student;
+//   openStudentCursor(&cursor, root, CURSOR_IN_ORDER);
+//   while ((student = nextStudent(&cursor)) != NULL) { ... }
+//   closeCursor(&cursor);
+//
+// The tree must not change while a cursor is open, except for freeing the
+// nodes already returned. A cursor must not be copied while it is open.
+
+#define TREE_CURSOR_INLINE 64
+
+typedef enum {
+    CURSOR_IN_ORDER,
+    CURSOR_PRE_ORDER
+} CursorOrder;
+
+typedef struct {
+    CursorOrder order;
+    size_t leftOffset;  // offsetof() the node's child pointers
+    size_t rightOffset;
+    void** stack;       // 'inlineStack' until the path outgrows it
+    size_t depth;
+    size_t capacity;
+    int failed;         // The stack could not grow, so the walk stopped early
+    void* inlineStack[TREE_CURSOR_INLINE];
+} TreeCursor;
+
+void openCursor(TreeCursor* cursor, void* root, size_t leftOffset, size_t rightOffset, CursorOrder order);
+void* cursorNext(TreeCursor* cursor);        // NULL once every node was visited (or the walk failed)
+void* cursorPeek(const TreeCursor* cursor);  // What cursorNext returns next, without moving
+void closeCursor(TreeCursor* cursor);
+
+#define openStudentCursor(cursor, root, order) \
+    openCursor((cursor), (root), offsetof(StudentNode, left), offsetof(StudentNode, right), (order))
+#define openTeacherCursor(cursor, root, order) \
+    openCursor((cursor), (root), offsetof(TeacherNode, left), offsetof(TeacherNode, right), (order))
+#define nextStudent(cursor) ((StudentNode*)cursorNext(cursor))
+#define nextTeacher(cursor) ((TeacherNode*)cursorNext(cursor))
+
+// An in-order student cursor that starts at the first SRN >= 'low'.
+void seekStudentCursor(TreeCursor* cursor, StudentNode* root, const char* low);
+
+// Student trees are AVL trees, so their cursors never leave the inline
+// stack and these walks cannot fail.
+size_t countStudentTree(StudentNode* root);
+// Writes every student to 'out' in SRN order. Returns how many.
+size_t flattenStudentTree(StudentNode* root, StudentNode** out);
+
+#endif // TREE_CURSOR_H